@@ -14,8 +14,16 @@
 #include "glfw3.h"
 #include "Move.hpp"
 #include "Shader.hpp"
+#include "PickGrid.hpp"
 
 unsigned int _createCubeVAO();
+
+// Per-instance attributes for instanced rendering, laid out as vertex attributes 2-7 (see ObjectCollection)
+struct CubeInstance {
+    glm::mat4 model;    // Model matrix including the cube's transform: position, rotation, scale and animation
+    glm::vec4 color;
+    glm::vec4 border;   // [r, g, b, size]
+};
 extern Shader* glob_shader;
 extern float glob_deltaTime, glob_animSpeed;
 extern bool glob_animate;
@@ -27,18 +35,22 @@ public:
     void setPos(int x, int y, int z);
     void setScale(int scale);
     void setColor(float r, float g, float b);
+    void setRotation(glm::mat4 rotation);
     void setBorder();
     void setBorderWidth(float size);
     void setBorderColor(float r, float g, float b);
     float distanceTo(glm::vec3 point); // Takes a point in world space, and calculates the smallest distance from the point to a face on the cube (or 0.0f for all points inside the cube)
     void draw();
+    void writeInstance(CubeInstance* instance); // Fill in instance attributes; like draw(), this advances any animation
     void startAnimation(bool* markWhenAnimFinished, Move* move);
     void stopAnimation();
     glm::mat4 processAnimation();
+    glm::mat4 computeTransform();   // Scale, rotation and (advancing) animation, relative to the cube's position
     glm::vec3 pos;
     Move* move;
     bool* markWhenAnimFinished;
     int id;
+    bool dirty;             // Set when anything drawn changes, so the instanced renderer knows to re-upload this cube
 private:
     float animProgress;
     glm::vec3 color;
@@ -49,5 +61,6 @@ private:
 };
 
 extern std::unordered_map<int, Cube*> glob_objects; // This is ugly, sorry
+extern PickGrid glob_pickGrid;                      // Lattice positions of all cubes, kept up to date by setPos/setScale
 
 #endif
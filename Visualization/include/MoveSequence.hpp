@@ -1,22 +1,20 @@
 #ifndef MOVESEQUENCE_H
 #define MOVESEQUENCE_H
 
-#include <deque>
 #include <vector>
-#include <stack>
 #include "Move.hpp"
 
 class MoveSequence
 {
 public:
     MoveSequence(std::vector<Move*> moves);
-    Move* pop();            // Deep-copy the next move in the queue, and pop it
-    Move* undo();           // Deep-copy the top move in the undostack, and pop it
-    Move* peek();           // Peek at the next move in the queue
-    Move* peekBack();       // Peek at the previous move (top of the undo stack)
+    Move* pop();            // Deep-copy the next move in the sequence, and step past it
+    Move* undo();           // Deep-copy the reverse of the previous move in the sequence, and step back before it
+    Move* peek();           // Peek at the next move in the sequence
+    Move* peekBack();       // Peek at the previous move
+    void seek(int move);    // Jump to just before a move index, without applying anything (see Timeline for module states)
 
-    std::deque<Move*> moves;
-    std::stack<Move*> undostack;
+    std::vector<Move*> moves;
     int totalMoves, remainingMoves, currentMove;
 
 };
@@ -19,11 +19,20 @@ public:
     ObjectCollection(Shader *shader, unsigned int VAO, int textureID = -1);
     void drawAll();
     void addObj(Cube *cube);
+    void setInstanced(Shader *instancedShader);     // Draw every cube with one instanced draw call using this shader, or NULL to draw cubes one by one
+    bool isInstanced();
 private:
+    void drawInstanced();
+
     Shader *shader;
     unsigned int VAO;
     std::vector<Cube*> objects;
     int numObjs, textureID;
+
+    Shader *instancedShader;
+    unsigned int instanceVAO, instanceVBO;
+    std::vector<CubeInstance> instances;        // CPU copy of the instance buffer, same order as objects
+    int bufferedObjs;                           // Number of instances the GPU buffer was allocated for
 };
 
 #endif
@@ -0,0 +1,35 @@
+#ifndef PICKGRID_H
+#define PICKGRID_H
+
+#include <unordered_map>
+#include "glm/glm.hpp"
+
+// Uniform grid over the integer lattice positions of modules, used for click picking.
+//  Each cell holds at most one module, drawn as a cube of the given half-size centered on the cell.
+//  A pick walks only the cells crossed by the ray (3D DDA), and doesn't touch GL.
+class PickGrid
+{
+public:
+    PickGrid();
+    void insert(int id, glm::ivec3 pos, float halfSize = 0.5f);    // Place a module, replacing whatever was in the cell
+    void remove(int id, glm::ivec3 pos);                            // Clear a cell, if it still holds this module
+    int at(glm::ivec3 pos);                                         // Module ID in a cell, or -1
+    int pick(glm::vec3 origin, glm::vec3 dir, float maxDist = 1000.0f); // Nearest module hit by a ray, or -1
+    int size();
+    void clear();
+private:
+    struct Cell {
+        int id;
+        float halfSize;
+    };
+    struct PosHash {
+        size_t operator()(const glm::ivec3& pos) const;
+    };
+    std::unordered_map<glm::ivec3, Cell, PosHash> cells;
+    glm::ivec3 minPos, maxPos;  // Bounds of every cell ever filled, rays are clipped to these
+};
+
+// Where a ray enters and leaves an axis-aligned box; returns false if it misses
+bool rayBoxIntersect(glm::vec3 origin, glm::vec3 dir, glm::vec3 boxMin, glm::vec3 boxMax, float& tNear, float& tFar);
+
+#endif
@@ -2,30 +2,38 @@
 #define SCENARIO_H
 
 #include <vector>
-#include <fstream>
 #include <iostream>
-#include <sstream>
 #include <string>
-#include <deque>
 #include <cstdlib>
-#include <map>
-#include <algorithm>
 #include "Cube.hpp"
 #include "Move.hpp"
 #include "ObjectCollection.hpp"
 #include "Shader.hpp"
 #include "MoveSequence.hpp"
+#include "Timeline.hpp"
 #include "glm/glm.hpp"
 
+// A module as read from a Scenario file, with its group's color and scale already resolved
+struct ScenarioModule {
+    int id;
+    int pos[3];
+    glm::vec3 color;
+    int scale;
+};
+
 class Scenario
 {
 public:
-    Scenario(const char* filepath);
-    ObjectCollection* toObjectCollection(Shader* shader, unsigned int vaoId, int texId);
+    Scenario(const char* filepath, bool verbose = true);
+    ObjectCollection* toObjectCollection(Shader* shader, unsigned int vaoId, int texId); // Only call once: Cubes are stored in place and registered in glob_objects
     MoveSequence* toMoveSequence();
+    Timeline* toTimeline(int interval);
+
+    std::vector<ScenarioModule> modules;    // Modules and moves in file order, stored contiguously
+    std::vector<Move> moves;
+    int numGroups, numCheckpoints;
 private:
-    std::vector<Cube*> cubes;
-    std::vector<Move*> moves;
+    std::vector<Cube> cubes;
 };
 
 #endif
@@ -0,0 +1,43 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <vector>
+#include <unordered_map>
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+#include "Move.hpp"
+
+// Position and orientation of every module at one point of a move sequence, indexed like Timeline::getModuleIds()
+struct TimelineState
+{
+    std::vector<glm::ivec3> positions;
+    std::vector<glm::quat> rotations;
+};
+
+// Random access into a move sequence: a snapshot of every module is kept every `interval` checkpoints,
+//  so the state at any checkpoint is rebuilt by replaying at most `interval` checkpoints' worth of moves.
+//  Checkpoint c starts at the c-th checkpoint move; checkpoint numCheckpoints() is the end of the sequence.
+//  An interval below 1 picks one from the number of modules and moves.
+//  Doesn't touch GL, so it can be built and checked without a window.
+class Timeline
+{
+public:
+    Timeline(const std::vector<int>& moduleIds, const std::vector<glm::ivec3>& positions, const std::vector<Move*>& moves, int interval = 0);
+    int numCheckpoints();
+    int checkpointStart(int checkpoint);            // Index of the first move of a checkpoint
+    int checkpointOf(int move);                     // Checkpoint that a move index belongs to
+    void stateAt(int checkpoint, TimelineState& state); // Fill state with the modules as they are before a checkpoint's first move
+    const std::vector<int>& getModuleIds();
+    int getInterval();
+
+    static void applyMove(TimelineState& state, int moduleIndex, const Move& move);
+private:
+    std::vector<int> moduleIds;
+    std::unordered_map<int, int> moduleIndices;     // <ID, index into moduleIds and TimelineState>
+    std::vector<const Move*> moves;
+    std::vector<int> checkpointStarts;              // Includes an end-of-sequence sentinel
+    std::vector<TimelineState> snapshots;           // snapshots[i] is the state at checkpoint i * interval
+    int interval;
+};
+
+#endif
@@ -0,0 +1,35 @@
+#version 330 core
+in vec2 texCoord;
+in vec4 worldPos;
+flat in vec3 instColor;
+flat in vec4 instBorderAttrs; // [r, g, b, size]
+out vec4 FragColor;
+uniform sampler2D tex;
+uniform float uTime;
+
+float Between(float low, float high, float val) {
+	return step(low, val) - step(high, val);
+}
+
+float Rectangle(vec2 orig, vec2 wh, vec2 st) {
+	float x = Between(orig.x, orig.x + wh.x, st.x);
+	float y = Between(orig.y, orig.y + wh.y, st.y);
+	return x*y;
+}
+
+// Same shading as fshader.glsl, with color and border coming from the instance instead of uniforms
+void main()
+{
+	float incidentLight = 0.6;
+
+	float borderMask = 1.0 - Rectangle(vec2(instBorderAttrs.w), vec2(1.0 - 2*instBorderAttrs.w), texCoord);
+	float interiorMask = 1.0 - borderMask;
+	vec3 border = borderMask * instBorderAttrs.xyz;
+
+	vec3 interior = texture(tex, texCoord).xyz;
+	interior = mix(instColor, interior, 0.3);
+	interior *= incidentLight;
+	interior *= interiorMask;
+
+	FragColor = vec4(interior + border, 1.0);
+}
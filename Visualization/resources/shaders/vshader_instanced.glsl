@@ -0,0 +1,24 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in mat4 aModel;       // Per-instance (locations 2-5): modelmat * transform
+layout (location = 6) in vec4 aColor;       // Per-instance
+layout (location = 7) in vec4 aBorderAttrs; // Per-instance: [r, g, b, size]
+
+out vec2 texCoord;
+out vec4 worldPos;
+flat out vec3 instColor;
+flat out vec4 instBorderAttrs;
+
+uniform mat4 viewmat;
+uniform mat4 projmat;
+uniform float uTime;
+
+void main()
+{
+	worldPos = aModel * vec4(aPos.xyz, 1.0);
+	gl_Position = projmat * viewmat * worldPos;
+	texCoord = aTexCoord;
+	instColor = aColor.rgb;
+	instBorderAttrs = aBorderAttrs;
+}
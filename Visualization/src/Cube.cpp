@@ -73,25 +73,38 @@ unsigned int _createCubeVAO() {
 }
 
 void Cube::setPos(int x, int y, int z) {
+    this->dirty = true;
+    glob_pickGrid.remove(this->id, glm::ivec3(this->pos));
     this->pos = glm::vec3(x, y, z);
+    glob_pickGrid.insert(this->id, glm::ivec3(this->pos), 0.5f * this->scale[0]);
 }
 
 void Cube::setScale(int scale) {
+    this->dirty = true;
     this->scale = glm::vec3((float)scale / 100.0f);
+    glob_pickGrid.insert(this->id, glm::ivec3(this->pos), 0.5f * this->scale[0]);
 }
 
 void Cube::setColor(float r, float g, float b) {
+    this->dirty = true;
     this->color = glm::vec3(r, g, b);
 }
 
+void Cube::setRotation(glm::mat4 rotation) {
+    this->dirty = true;
+    this->rotation = rotation;
+}
+
 void Cube::setBorder() {
     this->setBorderWidth(0.01f);
     this->setBorderColor(0, 0, 0);
 }
 void Cube::setBorderWidth(float size) {
+    this->dirty = true;
     this->borderSize = size;
 }
 void Cube::setBorderColor(float r, float g, float b) {
+    this->dirty = true;
     this->borderColor = glm::vec3(r, g, b);
 }
 
@@ -120,7 +133,7 @@ float Cube::distanceTo(glm::vec3 worldPoint) {
 
 Cube::Cube(int id, int x, int y, int z) {
     this->id = id;
-    this->setPos(x, y, z);
+    this->pos = glm::vec3(x, y, z);
     this->move = NULL;
     this->setScale(0.9f);
     this->setColor(1.0f, 1.0f, 1.0f);
@@ -208,16 +221,29 @@ glm::mat4 Cube::processAnimation() {
     return transform;
 }
 
-void Cube::draw() {
-    // If an animation finishes, it may update the position. So, calculate modelmatrix now; animation will handle its own relevant translations/offsets
-    glm::mat4 modelmat = glm::translate(glm::mat4(1.0f), glm::vec3(this->pos));
-
+glm::mat4 Cube::computeTransform() {
     glm::mat4 transform = glm::mat4(1.0f);
     transform = glm::scale(transform, this->scale);
     transform = this->rotation * transform;
     if (this->move) {
         transform = this->processAnimation() * transform;
     };
+    return transform;
+}
+
+void Cube::writeInstance(CubeInstance* instance) {
+    // Clear the flag first: if the animation finishes now, setPos marks the cube again for next frame's (final) transform
+    this->dirty = false;
+    glm::mat4 modelmat = glm::translate(glm::mat4(1.0f), glm::vec3(this->pos));
+    instance->model = modelmat * this->computeTransform();
+    instance->color = glm::vec4(this->color, 1.0f);
+    instance->border = glm::vec4(this->borderColor, this->borderSize);
+}
+
+void Cube::draw() {
+    // If an animation finishes, it may update the position. So, calculate modelmatrix now; animation will handle its own relevant translations/offsets
+    glm::mat4 modelmat = glm::translate(glm::mat4(1.0f), glm::vec3(this->pos));
+    glm::mat4 transform = this->computeTransform();
 
     glUniform3fv(glob_shader->colorLoc, 1, glm::value_ptr(this->color));
     glUniformMatrix4fv(glob_shader->transformLoc, 1, GL_FALSE, glm::value_ptr(transform));
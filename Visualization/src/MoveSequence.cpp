@@ -1,11 +1,7 @@
 #include "MoveSequence.hpp"
 
 MoveSequence::MoveSequence(std::vector<Move*> moves) {
-    this->moves = std::deque<Move*>();
-    this->undostack = std::stack<Move*>();
-    for (Move* move : moves) {
-        this->moves.push_back(move);
-    }
+    this->moves = moves;
     this->totalMoves = moves.size();
     this->remainingMoves = moves.size();
     this->currentMove = 0;
@@ -15,11 +11,7 @@ MoveSequence::MoveSequence(std::vector<Move*> moves) {
 Move* MoveSequence::pop() {
     if (this->remainingMoves == 0) { return NULL; }
 
-    Move* move = this->moves.front();
-    this->moves.pop_front();
-    this->undostack.push(move);
-
-    move = move->copy();
+    Move* move = this->moves[this->currentMove]->copy();
 
     this->remainingMoves--;
     this->currentMove++;
@@ -30,11 +22,7 @@ Move* MoveSequence::pop() {
 Move* MoveSequence::undo() {
     if (this->currentMove == 0) { return NULL; }
 
-    Move* move = this->undostack.top();
-    this->moves.push_front(move);
-    this->undostack.pop();
-
-    move = move->reverse();
+    Move* move = this->moves[this->currentMove - 1]->reverse();
 
     this->remainingMoves++;
     this->currentMove--;
@@ -44,10 +32,17 @@ Move* MoveSequence::undo() {
 
 Move* MoveSequence::peek() {
     if (this->remainingMoves == 0) { return NULL; }
-    return this->moves.front();
+    return this->moves[this->currentMove];
 }
 
 Move* MoveSequence::peekBack() {
     if (this->currentMove == 0) { return NULL; }
-    return this->undostack.top();
+    return this->moves[this->currentMove - 1];
+}
+
+void MoveSequence::seek(int move) {
+    if (move < 0) { move = 0; }
+    if (move > this->totalMoves) { move = this->totalMoves; }
+    this->currentMove = move;
+    this->remainingMoves = this->totalMoves - move;
 }
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstddef>
 #include "ObjectCollection.hpp"
 
 ObjectCollection::ObjectCollection(Shader *shader, unsigned int VAO, int textureID) {
@@ -6,9 +8,18 @@ ObjectCollection::ObjectCollection(Shader *shader, unsigned int VAO, int texture
     this->objects = std::vector<Cube*>();
     this->numObjs = 0;
     this->textureID = textureID;
+    this->instancedShader = NULL;
+    this->instanceVAO = 0;
+    this->instanceVBO = 0;
+    this->bufferedObjs = -1;
 }
 
 void ObjectCollection::drawAll() {
+    if (this->instancedShader) {
+        this->drawInstanced();
+        return;
+    }
+
     int i; 
     this->shader->use();
 
@@ -28,6 +39,74 @@ void ObjectCollection::drawAll() {
     glBindVertexArray(0);
 }
 
+void ObjectCollection::setInstanced(Shader *instancedShader) {
+    this->instancedShader = instancedShader;
+    if (!instancedShader || this->instanceVAO) { return; }
+
+    // A VAO of its own: the cube mesh plus per-instance attributes from the instance buffer
+    this->instanceVAO = _createCubeVAO();
+    glBindVertexArray(this->instanceVAO);
+    glGenBuffers(1, &this->instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    for (int i = 0; i < 4; i++) { // A mat4 attribute takes 4 locations, one per column
+        glVertexAttribPointer(2 + i, 4, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)(offsetof(CubeInstance, model) + i * sizeof(glm::vec4)));
+    }
+    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)offsetof(CubeInstance, color));
+    glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)offsetof(CubeInstance, border));
+    for (int i = 2; i < 8; i++) {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
+    }
+    glBindVertexArray(0);
+}
+
+bool ObjectCollection::isInstanced() {
+    return this->instancedShader != NULL;
+}
+
+void ObjectCollection::drawInstanced() {
+    int i, lo, hi;
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+
+    // (Re)allocate the buffer when cubes are added, which also forces every instance to be written
+    bool reupload = this->bufferedObjs != this->numObjs;
+    if (reupload) {
+        this->instances.resize(this->numObjs);
+        glBufferData(GL_ARRAY_BUFFER, this->numObjs * sizeof(CubeInstance), NULL, GL_DYNAMIC_DRAW);
+        this->bufferedObjs = this->numObjs;
+    }
+
+    // Only changed and animating cubes are rewritten; upload the range spanning them in one call
+    lo = this->numObjs;
+    hi = -1;
+    for (i = 0; i < this->numObjs; i++) {
+        Cube* cube = this->objects[i];
+        if (reupload || cube->dirty || cube->move) {
+            cube->writeInstance(&this->instances[i]);
+            lo = std::min(lo, i);
+            hi = i;
+        }
+    }
+    if (hi >= lo) {
+        glBufferSubData(GL_ARRAY_BUFFER, lo * sizeof(CubeInstance), (hi - lo + 1) * sizeof(CubeInstance), &this->instances[lo]);
+    }
+
+    this->instancedShader->use();
+
+    glUniform1f(glob_shader->timeLoc, glob_lastFrame);
+
+    glUniformMatrix4fv(glob_shader->viewLoc, 1, GL_FALSE, glm::value_ptr(camera.getViewMat()));
+    glUniformMatrix4fv(glob_shader->projLoc, 1, GL_FALSE, glm::value_ptr(camera.getProjMat()));
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, this->textureID);
+    glBindVertexArray(this->instanceVAO);
+
+    glDrawElementsInstanced(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0, this->numObjs);
+
+    glBindVertexArray(0);
+}
+
 void ObjectCollection::addObj(Cube *cube) {
     (this->objects).push_back(cube);
     this->numObjs++;
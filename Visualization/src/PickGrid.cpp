@@ -0,0 +1,105 @@
+#include <cmath>
+#include <limits>
+#include "PickGrid.hpp"
+
+size_t PickGrid::PosHash::operator()(const glm::ivec3& pos) const {
+    return ((size_t)(unsigned int)pos[0] * 73856093) ^ ((size_t)(unsigned int)pos[1] * 19349663) ^ ((size_t)(unsigned int)pos[2] * 83492791);
+}
+
+PickGrid::PickGrid() {
+    this->clear();
+}
+
+void PickGrid::insert(int id, glm::ivec3 pos, float halfSize) {
+    this->cells[pos] = Cell{id, halfSize};
+    this->minPos = glm::min(this->minPos, pos);
+    this->maxPos = glm::max(this->maxPos, pos);
+}
+
+void PickGrid::remove(int id, glm::ivec3 pos) {
+    auto it = this->cells.find(pos);
+    if (it != this->cells.end() && it->second.id == id) { this->cells.erase(it); }
+}
+
+int PickGrid::at(glm::ivec3 pos) {
+    auto it = this->cells.find(pos);
+    return it == this->cells.end() ? -1 : it->second.id;
+}
+
+int PickGrid::size() {
+    return this->cells.size();
+}
+
+void PickGrid::clear() {
+    this->cells.clear();
+    this->minPos = glm::ivec3(std::numeric_limits<int>::max());
+    this->maxPos = glm::ivec3(std::numeric_limits<int>::min());
+}
+
+bool rayBoxIntersect(glm::vec3 origin, glm::vec3 dir, glm::vec3 boxMin, glm::vec3 boxMax, float& tNear, float& tFar) {
+    tNear = -std::numeric_limits<float>::infinity();
+    tFar = std::numeric_limits<float>::infinity();
+    for (int i = 0; i < 3; i++) {
+        if (dir[i] == 0.0f) {
+            if (origin[i] < boxMin[i] || origin[i] > boxMax[i]) { return false; }
+            continue;
+        }
+        float t1 = (boxMin[i] - origin[i]) / dir[i];
+        float t2 = (boxMax[i] - origin[i]) / dir[i];
+        tNear = glm::max(tNear, glm::min(t1, t2));
+        tFar = glm::min(tFar, glm::max(t1, t2));
+    }
+    return tNear <= tFar;
+}
+
+int PickGrid::pick(glm::vec3 origin, glm::vec3 dir, float maxDist) {
+    if (this->cells.empty() || glm::dot(dir, dir) == 0.0f) { return -1; }
+    dir = glm::normalize(dir);
+
+    // Clip the ray to the occupied part of the lattice; cell (x, y, z) spans x-0.5 to x+0.5 on each axis
+    float tStart, tEnd;
+    if (!rayBoxIntersect(origin, dir, glm::vec3(this->minPos) - 0.5f, glm::vec3(this->maxPos) + 0.5f, tStart, tEnd)) { return -1; }
+    tStart = glm::max(tStart, 0.0f);
+    tEnd = glm::min(tEnd, maxDist);
+    if (tStart > tEnd) { return -1; }
+
+    // Set up the DDA from the cell containing the (clipped) start point
+    glm::vec3 start = origin + tStart * dir;
+    glm::ivec3 cell = glm::ivec3(glm::floor(start + 0.5f));
+    cell = glm::clamp(cell, this->minPos, this->maxPos); // Start points on the clip box's far faces round outside of it
+    glm::ivec3 step;
+    glm::vec3 tMax, tDelta;
+    for (int i = 0; i < 3; i++) {
+        if (dir[i] > 0.0f) {
+            step[i] = 1;
+            tMax[i] = tStart + ((cell[i] + 0.5f) - start[i]) / dir[i];
+            tDelta[i] = 1.0f / dir[i];
+        } else if (dir[i] < 0.0f) {
+            step[i] = -1;
+            tMax[i] = tStart + ((cell[i] - 0.5f) - start[i]) / dir[i];
+            tDelta[i] = -1.0f / dir[i];
+        } else {
+            step[i] = 0;
+            tMax[i] = std::numeric_limits<float>::infinity();
+            tDelta[i] = std::numeric_limits<float>::infinity();
+        }
+    }
+
+    // Walk the cells in the order the ray crosses them; the first module hit is the nearest, since it lies within its cell
+    float t = tStart;
+    while (t <= tEnd) {
+        auto it = this->cells.find(cell);
+        if (it != this->cells.end()) {
+            float tNear, tFar;
+            glm::vec3 center = glm::vec3(cell);
+            if (rayBoxIntersect(origin, dir, center - it->second.halfSize, center + it->second.halfSize, tNear, tFar) && tFar >= 0.0f) {
+                return it->second.id;
+            }
+        }
+        int axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+        t = tMax[axis];
+        cell[axis] += step[axis];
+        tMax[axis] += tDelta[axis];
+    }
+    return -1;
+}
@@ -1,77 +1,176 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "Scenario.hpp"
 
 struct VisGroup {
     int color[3];
     int scale;
+};
+
+// Read-only memory mapping of a whole file; data is NULL if the file couldn't be mapped (or is empty)
+class MappedFile
+{
+public:
+    MappedFile(const char* filepath) {
+        this->data = NULL;
+        this->size = 0;
+#ifdef _WIN32
+        this->file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        this->mapping = NULL;
+        if (this->file == INVALID_HANDLE_VALUE) { return; }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(this->file, &fileSize) || fileSize.QuadPart == 0) { return; }
+        this->mapping = CreateFileMappingA(this->file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (this->mapping == NULL) { return; }
+        this->data = (const char*)MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0);
+        if (this->data) { this->size = (size_t)fileSize.QuadPart; }
+#else
+        this->fd = open(filepath, O_RDONLY);
+        if (this->fd < 0) { return; }
+        struct stat st;
+        if (fstat(this->fd, &st) != 0 || st.st_size == 0) { return; }
+        void* mapped = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, this->fd, 0);
+        if (mapped == MAP_FAILED) { return; }
+        madvise(mapped, st.st_size, MADV_SEQUENTIAL);
+        this->data = (const char*)mapped;
+        this->size = st.st_size;
+#endif
+    }
 
-    VisGroup(int r, int g, int b, int scale) {
-        this->color[0] = r;
-        this->color[1] = g;
-        this->color[2] = b;
-        this->scale = scale;
+    ~MappedFile() {
+#ifdef _WIN32
+        if (this->data) { UnmapViewOfFile(this->data); }
+        if (this->mapping) { CloseHandle(this->mapping); }
+        if (this->file != INVALID_HANDLE_VALUE) { CloseHandle(this->file); }
+#else
+        if (this->data) { munmap((void*)this->data, this->size); }
+        if (this->fd >= 0) { close(this->fd); }
+#endif
     }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const {
+#ifdef _WIN32
+        return this->file != INVALID_HANDLE_VALUE;
+#else
+        return this->fd >= 0;
+#endif
+    }
+
+    const char* data;
+    size_t size;
+private:
+#ifdef _WIN32
+    HANDLE file, mapping;
+#else
+    int fd;
+#endif
 };
 
-Scenario::Scenario(const char* filepath) {
-    this->cubes = std::vector<Cube*>();
-    this->moves = std::vector<Move*>();
-    
-    std::unordered_map<int, VisGroup*> visgroups;
+inline bool _isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
 
-    // -- Load file and parse data into Cube and Move objects --
-    std::ifstream scenFile;
-    std::stringstream stream;
+Scenario::Scenario(const char* filepath, bool verbose) {
+    auto start = std::chrono::steady_clock::now();
+    this->numGroups = 0;
+    this->numCheckpoints = 0;
 
-    scenFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
+    std::unordered_map<int, VisGroup> visgroups;
 
-    try {
-        scenFile.open(filepath);
-        stream << scenFile.rdbuf();
-    } catch(std::ifstream::failure e) {
+    // -- Map the file and parse it in place into the module and move arrays --
+    MappedFile scenFile(filepath);
+    if (!scenFile.isOpen()) {
         std::cout << "ERROR::SCENARIO::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
+        return;
     }
+    const char* cur = scenFile.data;
+    const char* end = scenFile.data + scenFile.size;
+
+    // Every record takes a line, so the line count bounds the size of both arrays
+    size_t numLines = std::count(cur, end, '\n') + 1;
+    this->modules.reserve(numLines);
+    this->moves.reserve(numLines);
 
     int currentBlock = 0;       // Which block of the Scenario file we're currently parsing
     int buf[5];                 // Each line should have a maximum of 5 values. Any further will be ignored
     int i;                      // Helper iterator variable
-    std::string line, value;    // Each line will be (temp) stored in string. Each component of a line will be (temp) stored in value
+    int lineNum = 0;
     glm::vec3 anchorDir;        // anchorDirs are encoded using ints; we will decode them when constructing each Move
     bool sliding;               // As above: sliding moves are encoded by sign of int. Extract to this helper variable
-    VisGroup* vg;
-    Cube* cube;
     bool checkpointMove = true;
 
-    while (std::getline(stream, line)) {
-        line = line.substr(0, line.find("//"));
-        line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
-        if (line.empty()) {
+    while (cur < end) {
+        const char* lineEnd = (const char*)memchr(cur, '\n', end - cur);
+        if (!lineEnd) { lineEnd = end; }
+        const char* next = lineEnd < end ? lineEnd + 1 : end;
+        lineNum++;
+
+        // Strip comments
+        for (const char* c = cur; c + 1 < lineEnd; c++) {
+            if (c[0] == '/' && c[1] == '/') { lineEnd = c; break; }
+        }
+        while (cur < lineEnd && _isBlank(*cur)) { cur++; }
+        if (cur == lineEnd) {
             currentBlock++;
             checkpointMove = true;
-            if (currentBlock < 3) { std::cout << " -- Parsing new block -- " << currentBlock << std::endl; }
+            cur = next;
             continue;
         }
 
-        std::istringstream iss(line);
-        for (i = 0; std::getline(iss, value, ','); i++) {
-            buf[i] = std::stoi(value);
+        // Split on commas and parse each value
+        std::fill(buf, buf + 5, 0);
+        for (i = 0; cur < lineEnd; i++) {
+            while (cur < lineEnd && _isBlank(*cur)) { cur++; }
+            if (cur < lineEnd && *cur == '+') { cur++; }
+            int value;
+            std::from_chars_result result = std::from_chars(cur, lineEnd, value);
+            if (result.ec != std::errc()) {
+                throw std::invalid_argument("Invalid value in Scenario file on line " + std::to_string(lineNum));
+            }
+            if (i < 5) { buf[i] = value; }
+            cur = result.ptr;
+            while (cur < lineEnd && *cur != ',') { cur++; }
+            if (cur < lineEnd) { cur++; }
         }
+        cur = next;
 
         switch (currentBlock) {
             case 0: {
-                for (i = 1; i < 4; i++) { buf[i] = glm::clamp(buf[i], 0, 255); }    // Clamp color values to 0-255
-                buf[4] = glm::clamp(buf[4], 10, 100);                               // Clamp size value to 10-100
-                std::cout << "Parsing Group ID " << buf[0] << " with color " << buf[1] << ", " << buf[2] << ", " << buf[3] << ", size " << buf[4] << std::endl;
-                vg = new VisGroup(buf[1], buf[2], buf[3], buf[4]);
-                visgroups.insert(std::pair<int, VisGroup*>(buf[0], vg));
+                VisGroup vg;
+                for (i = 0; i < 3; i++) { vg.color[i] = glm::clamp(buf[i + 1], 0, 255); }  // Clamp color values to 0-255
+                vg.scale = glm::clamp(buf[4], 10, 100);                                   // Clamp size value to 10-100
+                visgroups[buf[0]] = vg;
+                this->numGroups++;
                 break; // Switch break
             }
             case 1: {
-                std::cout << "Creating Cube with ID " << buf[0] << " in group " << buf[1] << " at location " << buf[2] << ", " << buf[3] << ", " << buf[4] << std::endl;
-                cube = new Cube(buf[0], buf[2], buf[3], buf[4]);
-                vg = visgroups.at(buf[1]);
-                cube->setColor((float)vg->color[0]/255.0f, (float)vg->color[1]/255.0f, (float)vg->color[2]/255.0f); 
-                cube->setScale(vg->scale);
-                this->cubes.push_back(cube);
+                const VisGroup& vg = visgroups.at(buf[1]);
+                ScenarioModule module;
+                module.id = buf[0];
+                module.pos[0] = buf[2];
+                module.pos[1] = buf[3];
+                module.pos[2] = buf[4];
+                module.color = glm::vec3((float)vg.color[0]/255.0f, (float)vg.color[1]/255.0f, (float)vg.color[2]/255.0f);
+                module.scale = vg.scale;
+                this->modules.push_back(module);
                 break;
             }
             default: {
@@ -87,26 +186,61 @@ Scenario::Scenario(const char* filepath) {
                 }
                 sliding = buf[1] > 0 ? false : true;
 
-                this->moves.push_back(new Move(buf[0], anchorDir, glm::vec3(buf[2], buf[3], buf[4]), sliding, checkpointMove));
-                if (sliding) { std::cout << (checkpointMove ? " (c.p.) " : "        ") << "Creating Sliding Move of Cube ID " << buf[0] << " with anchorDir " << glm::to_string(anchorDir) << " with delta position " << buf[2] << ", " << buf[3] << ", " << buf[4] << std::endl; }
-                else { std::cout << (checkpointMove ? " (c.p.) " : "        ") << "Creating Pivot Move of Cube ID " << buf[0] << " with anchorDir " << glm::to_string(anchorDir) << " with delta position " << buf[2] << ", " << buf[3] << ", " << buf[4] << std::endl; }
-                if (checkpointMove) { checkpointMove = false; }
+                this->moves.emplace_back(buf[0], anchorDir, glm::vec3(buf[2], buf[3], buf[4]), sliding, checkpointMove);
+                if (checkpointMove) {
+                    this->numCheckpoints++;
+                    checkpointMove = false;
+                }
                 break; // Switch break
             }
         }
     }
+
+    if (verbose) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        std::cout << "Loaded " << filepath << ": " << this->numGroups << " groups, " << this->modules.size() << " modules, "
+                  << this->moves.size() << " moves (" << this->numCheckpoints << " checkpoints) in " << elapsed.count() << " ms" << std::endl;
+    }
 }
 
 ObjectCollection* Scenario::toObjectCollection(Shader* pshader, unsigned int vaoId, int texId) {
     ObjectCollection* cubes = new ObjectCollection(pshader, vaoId, texId);
 
-    for (Cube* cube : this->cubes) {
-        cubes->addObj(cube);
+    // Reserve up front so the Cubes never move: glob_objects and the collection hold pointers to them
+    this->cubes.reserve(this->modules.size());
+    for (const ScenarioModule& module : this->modules) {
+        this->cubes.emplace_back(module.id, module.pos[0], module.pos[1], module.pos[2]);
+        Cube& cube = this->cubes.back();
+        cube.setColor(module.color[0], module.color[1], module.color[2]);
+        cube.setScale(module.scale);
+        cubes->addObj(&cube);
     }
 
     return cubes;
 }
 
 MoveSequence* Scenario::toMoveSequence() {
-    return new MoveSequence(this->moves);
+    std::vector<Move*> moves;
+    moves.reserve(this->moves.size());
+    for (Move& move : this->moves) {
+        moves.push_back(&move);
+    }
+    return new MoveSequence(moves);
+}
+
+Timeline* Scenario::toTimeline(int interval) {
+    std::vector<int> moduleIds;
+    std::vector<glm::ivec3> positions;
+    std::vector<Move*> moves;
+    moduleIds.reserve(this->modules.size());
+    positions.reserve(this->modules.size());
+    moves.reserve(this->moves.size());
+    for (const ScenarioModule& module : this->modules) {
+        moduleIds.push_back(module.id);
+        positions.push_back(glm::ivec3(module.pos[0], module.pos[1], module.pos[2]));
+    }
+    for (Move& move : this->moves) {
+        moves.push_back(&move);
+    }
+    return new Timeline(moduleIds, positions, moves, interval);
 }
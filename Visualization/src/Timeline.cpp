@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <stdexcept>
+#include "Timeline.hpp"
+
+Timeline::Timeline(const std::vector<int>& moduleIds, const std::vector<glm::ivec3>& positions, const std::vector<Move*>& moves, int interval) {
+    this->moduleIds = moduleIds;
+    for (int i = 0; i < (int)moduleIds.size(); i++) {
+        this->moduleIndices.insert(std::pair<int, int>(moduleIds[i], i));
+    }
+
+    // Find where each checkpoint starts; the first move always starts one
+    this->moves.reserve(moves.size());
+    for (int i = 0; i < (int)moves.size(); i++) {
+        this->moves.push_back(moves[i]);
+        if (i == 0 || moves[i]->checkpointMove) { this->checkpointStarts.push_back(i); }
+    }
+    this->checkpointStarts.push_back(moves.size());
+
+    // Automatic interval: replay about as many moves per seek as there are modules, which balances seek time
+    //  against snapshot memory (a snapshot costs one entry per module)
+    if (interval < 1) {
+        int movesPerCheckpoint = std::max(1, (int)moves.size() / std::max(1, this->numCheckpoints()));
+        interval = std::max(1, (int)moduleIds.size() / movesPerCheckpoint);
+    }
+    this->interval = interval;
+
+    // Replay the whole sequence once, recording a snapshot every `interval` checkpoints
+    TimelineState state;
+    state.positions = positions;
+    state.rotations = std::vector<glm::quat>(positions.size(), glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+    for (int checkpoint = 0; checkpoint <= this->numCheckpoints(); checkpoint++) {
+        if (checkpoint % interval == 0) { this->snapshots.push_back(state); }
+        if (checkpoint == this->numCheckpoints()) { break; }
+        for (int i = this->checkpointStarts[checkpoint]; i < this->checkpointStarts[checkpoint + 1]; i++) {
+            applyMove(state, this->moduleIndices.at(this->moves[i]->moverId), *this->moves[i]);
+        }
+    }
+}
+
+int Timeline::numCheckpoints() {
+    return this->checkpointStarts.size() - 1;
+}
+
+int Timeline::checkpointStart(int checkpoint) {
+    return this->checkpointStarts.at(checkpoint);
+}
+
+int Timeline::checkpointOf(int move) {
+    // Last checkpoint starting at or before the move
+    auto it = std::upper_bound(this->checkpointStarts.begin(), this->checkpointStarts.end() - 1, move);
+    return std::max(0, (int)(it - this->checkpointStarts.begin()) - 1);
+}
+
+void Timeline::stateAt(int checkpoint, TimelineState& state) {
+    if (checkpoint < 0 || checkpoint > this->numCheckpoints()) { throw std::out_of_range("Timeline checkpoint out of range"); }
+    int snapshot = checkpoint / this->interval;
+    state = this->snapshots[snapshot];
+    for (int i = this->checkpointStarts[snapshot * this->interval]; i < this->checkpointStarts[checkpoint]; i++) {
+        applyMove(state, this->moduleIndices.at(this->moves[i]->moverId), *this->moves[i]);
+    }
+}
+
+const std::vector<int>& Timeline::getModuleIds() {
+    return this->moduleIds;
+}
+
+int Timeline::getInterval() {
+    return this->interval;
+}
+
+void Timeline::applyMove(TimelineState& state, int moduleIndex, const Move& move) {
+    state.positions[moduleIndex] += glm::ivec3(move.deltaPos);
+    if (!move.sliding) { // Pivot moves also turn the module, matching Cube::processAnimation()
+        state.rotations[moduleIndex] = glm::angleAxis(glm::radians(move.maxAngle), move.rotAxis) * state.rotations[moduleIndex];
+    }
+}
@@ -0,0 +1,212 @@
+/* Headless benchmark modes, run from the command line instead of opening the viewer */
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+#include "Scenario.hpp"
+
+extern float glob_deltaTime, glob_lastFrame;                                 // main.cpp
+extern float glob_resolution[2];
+extern const char *vertexShaderPath, *fragmentShaderPath, *texturePath;
+extern const char *instancedVertexShaderPath, *instancedFragmentShaderPath;
+extern GLFWwindow* createWindowAndContext(bool visible);                    // setuputils.cpp
+extern void setupGl(GLFWwindow* window);
+extern int loadTexture(const char *texturePath);
+
+// Parse a Scenario file repeatedly without creating a window or GL context, and report load times
+int benchmarkLoad(const char* scenPath, int iterations) {
+    double best = 1e30, total = 0.0;
+    size_t numModules = 0, numMoves = 0;
+
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        Scenario scenario = Scenario(scenPath, false);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+        total += elapsed.count();
+        numModules = scenario.modules.size();
+        numMoves = scenario.moves.size();
+    }
+
+    std::cout << "Loaded " << scenPath << " (" << numModules << " modules, " << numMoves << " moves) " << iterations << " times" << std::endl;
+    std::cout << "Best: " << best << " ms, mean: " << total / iterations << " ms" << std::endl;
+    return 0;
+}
+
+// Build a Timeline for a Scenario file, check every checkpoint against a straight replay of the moves, and time seeking
+int benchmarkSeek(const char* scenPath, int interval) {
+    Scenario scenario = Scenario(scenPath);
+
+    auto start = std::chrono::steady_clock::now();
+    Timeline* timeline = scenario.toTimeline(interval);
+    std::chrono::duration<double, std::milli> buildTime = std::chrono::steady_clock::now() - start;
+    std::cout << "Built timeline with " << timeline->numCheckpoints() << " checkpoints (snapshot every " << timeline->getInterval() << ") in " << buildTime.count() << " ms" << std::endl;
+
+    // Replay every move in order, comparing with the Timeline at each checkpoint
+    std::unordered_map<int, int> moduleIndices;
+    for (int i = 0; i < (int)timeline->getModuleIds().size(); i++) {
+        moduleIndices.insert(std::pair<int, int>(timeline->getModuleIds()[i], i));
+    }
+    TimelineState expected, actual;
+    for (const ScenarioModule& module : scenario.modules) {
+        expected.positions.push_back(glm::ivec3(module.pos[0], module.pos[1], module.pos[2]));
+        expected.rotations.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+    }
+    int mismatches = 0;
+    for (int checkpoint = 0; checkpoint <= timeline->numCheckpoints(); checkpoint++) {
+        timeline->stateAt(checkpoint, actual);
+        if (actual.positions != expected.positions) {
+            std::cout << "Mismatch at checkpoint " << checkpoint << std::endl;
+            mismatches++;
+        }
+        if (checkpoint == timeline->numCheckpoints()) { break; }
+        for (int i = timeline->checkpointStart(checkpoint); i < timeline->checkpointStart(checkpoint + 1); i++) {
+            const Move& move = scenario.moves[i];
+            Timeline::applyMove(expected, moduleIndices.at(move.moverId), move);
+        }
+    }
+
+    // Time seeks to checkpoints in a scrambled order
+    int numSeeks = std::min(timeline->numCheckpoints() + 1, 10000);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numSeeks; i++) {
+        timeline->stateAt((int)(((long long)i * 7919) % (timeline->numCheckpoints() + 1)), actual);
+    }
+    std::chrono::duration<double, std::milli> seekTime = std::chrono::steady_clock::now() - start;
+    std::cout << "Mean seek: " << seekTime.count() / numSeeks << " ms over " << numSeeks << " seeks" << std::endl;
+
+    delete timeline;
+    if (mismatches > 0) {
+        std::cout << mismatches << " checkpoints did not match a straight replay" << std::endl;
+        return 1;
+    }
+    std::cout << "All checkpoints match a straight replay" << std::endl;
+    return 0;
+}
+
+// Fire rays at the modules of a Scenario file, checking PickGrid against testing every module, and time both
+int benchmarkPick(const char* scenPath, int numRays) {
+    Scenario scenario = Scenario(scenPath);
+    if (scenario.modules.empty()) { return 0; }
+
+    PickGrid grid;
+    glm::vec3 center = glm::vec3(0.0f);
+    for (const ScenarioModule& module : scenario.modules) {
+        grid.insert(module.id, glm::ivec3(module.pos[0], module.pos[1], module.pos[2]), 0.005f * module.scale);
+        center += glm::vec3(module.pos[0], module.pos[1], module.pos[2]);
+    }
+    center /= (float)scenario.modules.size();
+
+    // Rays start on a sphere around the scene and aim near a module (so most of them hit), in a fixed pseudo-random order
+    std::vector<glm::vec3> origins, dirs;
+    unsigned int seed = 12345;
+    auto next = [&seed]() { seed = seed * 1664525 + 1013904223; return (float)(seed >> 8) / (float)(1 << 24); };
+    for (int i = 0; i < numRays; i++) {
+        float yaw = next() * 6.2831853f, pitch = (next() - 0.5f) * 3.1415926f;
+        glm::vec3 origin = center + 100.0f * glm::vec3(cos(yaw) * cos(pitch), sin(pitch), sin(yaw) * cos(pitch));
+        const ScenarioModule& target = scenario.modules[(size_t)(next() * scenario.modules.size()) % scenario.modules.size()];
+        glm::vec3 aim = glm::vec3(target.pos[0], target.pos[1], target.pos[2]) + glm::vec3(next(), next(), next()) - 0.5f;
+        origins.push_back(origin);
+        dirs.push_back(glm::normalize(aim - origin));
+    }
+
+    std::vector<int> gridHits(numRays), bruteHits(numRays);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numRays; i++) {
+        gridHits[i] = grid.pick(origins[i], dirs[i]);
+    }
+    std::chrono::duration<double, std::milli> gridTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numRays; i++) {
+        float best = 1e30f, tNear, tFar;
+        bruteHits[i] = -1;
+        for (const ScenarioModule& module : scenario.modules) {
+            glm::vec3 pos = glm::vec3(module.pos[0], module.pos[1], module.pos[2]);
+            float halfSize = 0.005f * module.scale;
+            if (rayBoxIntersect(origins[i], dirs[i], pos - halfSize, pos + halfSize, tNear, tFar) && tFar >= 0.0f && tNear < best) {
+                best = tNear;
+                bruteHits[i] = module.id;
+            }
+        }
+    }
+    std::chrono::duration<double, std::milli> bruteTime = std::chrono::steady_clock::now() - start;
+
+    int mismatches = 0, hits = 0;
+    for (int i = 0; i < numRays; i++) {
+        if (gridHits[i] != bruteHits[i]) { mismatches++; }
+        if (bruteHits[i] >= 0) { hits++; }
+    }
+    std::cout << numRays << " rays, " << hits << " hits" << std::endl;
+    std::cout << "Grid: " << gridTime.count() / numRays << " ms/pick, every module: " << bruteTime.count() / numRays << " ms/pick" << std::endl;
+    if (mismatches > 0) {
+        std::cout << mismatches << " picks did not match testing every module" << std::endl;
+        return 1;
+    }
+    std::cout << "All picks match testing every module" << std::endl;
+    return 0;
+}
+
+// Render a Scenario into an offscreen framebuffer, one cube at a time and then instanced, and report ms/frame for each.
+//  Moves are played back at a fixed 60 frames per second of animation time, so some cubes are animating throughout.
+int benchmarkFrames(const char* scenPath, int numFrames) {
+    GLFWwindow* window = createWindowAndContext(false);
+    setupGl(window);
+
+    unsigned int fbo, colorBuffer, depthBuffer;
+    int width = (int)glob_resolution[0], height = (int)glob_resolution[1];
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) { throw std::runtime_error("Failed to create offscreen framebuffer"); }
+    glViewport(0, 0, width, height);
+
+    Shader shader = Shader(vertexShaderPath, fragmentShaderPath);
+    Shader instancedShader = Shader(instancedVertexShaderPath, instancedFragmentShaderPath);
+    int texture = loadTexture(texturePath);
+    unsigned int VAO = _createCubeVAO();
+
+    Scenario scenario = Scenario(scenPath);
+    ObjectCollection* cubes = scenario.toObjectCollection(&shader, VAO, texture);
+    MoveSequence* moves = scenario.toMoveSequence();
+    camera.calcViewMat();
+
+    bool readyForNewAnim = true;
+    glob_deltaTime = 1.0f / 60.0f;
+    for (int pass = 0; pass < 2; pass++) {
+        cubes->setInstanced(pass == 0 ? NULL : &instancedShader);
+        glFinish();
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < numFrames; frame++) {
+            glob_lastFrame += glob_deltaTime;
+            if (readyForNewAnim) {
+                Move* move = moves->pop();
+                if (move) {
+                    glob_objects.at(move->moverId)->startAnimation(&readyForNewAnim, move);
+                    readyForNewAnim = false;
+                }
+            }
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            cubes->drawAll();
+        }
+        glFinish();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << (pass == 0 ? "Per-cube draws: " : "Instanced:      ") << elapsed.count() / numFrames << " ms/frame over "
+                  << numFrames << " frames (" << scenario.modules.size() << " cubes)" << std::endl;
+    }
+
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &colorBuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+    glfwTerminate();
+    return 0;
+}
@@ -19,14 +19,19 @@
 #include "Camera.hpp"
 
 #define AUTO_ROTATE 0
+#define INSTANCED_RENDERING 1                       // Draw all cubes with one instanced draw call, instead of one call per cube
+#define TIMELINE_INTERVAL 0                         // Checkpoints between Timeline snapshots (lower is faster to seek but uses more memory), 0 picks automatically
 
 std::unordered_map<int, Cube*> glob_objects;    // Hashmap of all <ID, object>. Global variable
+PickGrid glob_pickGrid;                         // Lattice grid of all cubes, for picking. Global variable
 
 float glob_resolution[2] = {1280.0f, 720.0f};        // Screen attributes
 float glob_aspectRatio = glob_resolution[0] / glob_resolution[1];
 
 const char *vertexShaderPath = "resources/shaders/vshader.glsl";    // Resource paths
 const char *fragmentShaderPath = "resources/shaders/fshader.glsl";
+const char *instancedVertexShaderPath = "resources/shaders/vshader_instanced.glsl";
+const char *instancedFragmentShaderPath = "resources/shaders/fshader_instanced.glsl";
 const char *texturePath = "resources/textures/face_debug.png";
 
 float glob_deltaTime = 0.0f;                    // Frame-time info
@@ -36,6 +41,7 @@ bool glob_animateRequest = false;               //  When the current animation c
 bool glob_animateChaining = false;              //  Continue fetching animations until reaching a checkpoint move
 bool glob_animateAuto = false;                  //  Is the scene in auto-animate mode? (will automatically set animateRequest to true upon reaching a checkpoint move)
 bool glob_animateForward = true;                //  Direction to fetch animations
+int glob_seekRequest = 0;                       // Checkpoints to jump by (without animating) once the current animation finishes
 
 Camera camera = Camera();
 
@@ -44,41 +50,51 @@ extern void processInput(GLFWwindow *window);
 
 // Forward declarations -- definitions for these are in setuputils.cpp
 extern int loadTexture(const char *texturePath);
-extern GLFWwindow* createWindowAndContext();
+extern GLFWwindow* createWindowAndContext(bool visible = true);
 extern void registerWindowCallbacks(GLFWwindow* window);
 extern void setupGl(GLFWwindow* window);
 
-// TODO clean this up, comment it, and bulletproof it
-Cube* raymarch(glm::vec3 pos, glm::vec3 dir) {
-    float dist;
-    float mindist = 100.0f;
-    int i;
-    Cube* cube;
-
-    for (i = 20; (i > 0) && (mindist > 0.0f); i--) {
-        mindist = 100.0f;
-        for (std::pair<int, Cube*> pair : glob_objects) {
-            cube = pair.second;
-            dist = cube->distanceTo(pos);
-            mindist = glm::min(dist, mindist);
-            if (mindist == 0.0f) {
-                std::cout << "Clicked on cube ID " << cube->id << std::endl;
-                for (std::pair<int, Cube*> _ : glob_objects) {
-                    _.second->setBorder();
-                }
-                cube->setBorderWidth(0.02f);
-                cube->setBorderColor(1.0f, 1.0f, 1.0f);
-                return cube;
-            }
-        }
-
-        pos += glm::max(0.1f, mindist * 0.99f) * dir;
+// Forward declarations -- definitions for these are in benchmarks.cpp
+extern int benchmarkLoad(const char* scenPath, int iterations);
+extern int benchmarkSeek(const char* scenPath, int interval);
+extern int benchmarkPick(const char* scenPath, int numRays);
+extern int benchmarkFrames(const char* scenPath, int numFrames);
+
+// Find the cube under a click ray and highlight it, walking only the lattice cells the ray crosses
+Cube* pickCube(glm::vec3 pos, glm::vec3 dir) {
+    static Cube* selected = NULL;
+    int id = glob_pickGrid.pick(pos, dir);
+    if (id < 0) {
+        std::cout << "No cube at click location" << std::endl;
+        return NULL;
     }
-    std::cout << "No cube at click location" << std::endl;
-    return NULL;
+
+    std::cout << "Clicked on cube ID " << id << std::endl;
+    if (selected) { selected->setBorder(); }
+    selected = glob_objects.at(id);
+    selected->setBorderWidth(0.02f);
+    selected->setBorderColor(1.0f, 1.0f, 1.0f);
+    return selected;
 }
 
 int main(int argc, char** argv) {
+    // Headless benchmark modes: "main --bench-load <path to .scen> [iterations]"
+    if (argc > 2 && std::string(argv[1]) == "--bench-load") {
+        return benchmarkLoad(argv[2], argc > 3 ? std::atoi(argv[3]) : 10); // benchmarks.cpp
+    }
+    //  "main --bench-seek <path to .scen> [snapshot interval]"
+    if (argc > 2 && std::string(argv[1]) == "--bench-seek") {
+        return benchmarkSeek(argv[2], argc > 3 ? std::atoi(argv[3]) : TIMELINE_INTERVAL); // benchmarks.cpp
+    }
+    //  "main --bench-pick <path to .scen> [rays]"
+    if (argc > 2 && std::string(argv[1]) == "--bench-pick") {
+        return benchmarkPick(argv[2], argc > 3 ? std::atoi(argv[3]) : 1000); // benchmarks.cpp
+    }
+    //  "main --bench-frames <path to .scen> [frames]" (needs a GL context, but renders offscreen)
+    if (argc > 2 && std::string(argv[1]) == "--bench-frames") {
+        return benchmarkFrames(argv[2], argc > 3 ? std::atoi(argv[3]) : 300); // benchmarks.cpp
+    }
+
     // Establishes a Window, creates an OpenGL context, and invokes GLAD
     GLFWwindow* window = createWindowAndContext(); // setuputils.cpp
     
@@ -90,6 +106,7 @@ int main(int argc, char** argv) {
 
     // Load shaders and textures
     Shader shader = Shader(vertexShaderPath, fragmentShaderPath);
+    Shader instancedShader = Shader(instancedVertexShaderPath, instancedFragmentShaderPath);
     int texture = loadTexture(texturePath); // setuputils.cpp
 
     // Create a Vertex Attribute Object for modules/cubes (collection of vertices and associated info on how to interpret them for GL)
@@ -103,7 +120,12 @@ int main(int argc, char** argv) {
    
     // Extract the modules and moves from the Scenario file
     ObjectCollection* scenCubes = scenario.toObjectCollection(&shader, VAO, texture);
+#if INSTANCED_RENDERING > 0
+    scenCubes->setInstanced(&instancedShader);
+#endif
     MoveSequence* scenMoveSeq = scenario.toMoveSequence();
+    Timeline* scenTimeline = scenario.toTimeline(TIMELINE_INTERVAL);
+    TimelineState seekState;
 
     // Initialize for our main loop: we are ready for the next animation
     bool readyForNewAnim = true;
@@ -126,6 +148,23 @@ int main(int argc, char** argv) {
         camera.calcViewMat(glm::vec3(0.0f));
 #endif
 
+        // Jump straight to another checkpoint: rebuild every module from the nearest Timeline snapshot
+        if (readyForNewAnim && glob_seekRequest != 0) {
+            long long target = (long long)scenTimeline->checkpointOf(scenMoveSeq->currentMove) + glob_seekRequest;
+            target = std::clamp(target, 0LL, (long long)scenTimeline->numCheckpoints());
+            scenTimeline->stateAt(target, seekState);
+            const std::vector<int>& moduleIds = scenTimeline->getModuleIds();
+            for (size_t i = 0; i < moduleIds.size(); i++) {
+                Cube* cube = glob_objects.at(moduleIds[i]);
+                cube->setPos(seekState.positions[i][0], seekState.positions[i][1], seekState.positions[i][2]);
+                cube->setRotation(glm::mat4_cast(seekState.rotations[i]));
+            }
+            scenMoveSeq->seek(scenTimeline->checkpointStart(target));
+            std::cout << "Jumped to checkpoint " << target << " of " << scenTimeline->numCheckpoints() << std::endl;
+            glob_seekRequest = 0;
+            glob_animateChaining = false;
+        }
+
         if (readyForNewAnim) {
             // If there's no need to fetch another move, bypass
             if (!glob_animateRequest && !glob_animateChaining) {
@@ -29,12 +29,13 @@ int loadTexture(const char *texturePath) {
     return texture;
 }
 
-GLFWwindow* createWindowAndContext() {
+GLFWwindow* createWindowAndContext(bool visible) {
     // Initialize GLFW and configure it to use version 3.3 with OGL Core Profile
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE); // Benchmarks render offscreen, behind a hidden window
 
     // Create the Window object and set it to the current Context
     GLFWwindow* window = glfwCreateWindow(glob_resolution[0], glob_resolution[1], "Modular Robotics", NULL, NULL);
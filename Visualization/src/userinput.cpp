@@ -1,13 +1,15 @@
 #include "Cube.hpp"
 #include "Camera.hpp"
 #include "glfw3.h"
+#include <climits>
 
 extern Camera camera;
 extern float glob_resolution[2];
 extern float glob_aspectRatio;
 extern float glob_animSpeed, glob_deltaTime;
 extern bool glob_animateAuto, glob_animateForward, glob_animateRequest;
-extern Cube* raymarch(glm::vec3 pos, glm::vec3 dir);
+extern int glob_seekRequest;
+extern Cube* pickCube(glm::vec3 pos, glm::vec3 dir);
 
 float lastX, lastY, yaw, pitch;         // Helper variables for user interaction
 bool rmbClicked = false;
@@ -85,7 +87,7 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
     } else if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) { // Left-click
         double xp, yp;
         glfwGetCursorPos(window, &xp, &yp);
-        raymarch(camera.getPos(), convertClickCoordToWorldDir(xp, yp));
+        pickCube(camera.getPos(), convertClickCoordToWorldDir(xp, yp));
     }
 }
 
@@ -113,6 +115,14 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     } else if ((key == GLFW_KEY_LEFT) && (action == GLFW_PRESS)) {  // Left arrow --
         glob_animateForward = false;
         glob_animateRequest = true;
+    } else if ((key == GLFW_KEY_PAGE_DOWN) && (action != GLFW_RELEASE)) { // Page Down -- jump 10 checkpoints forward
+        glob_seekRequest += 10;
+    } else if ((key == GLFW_KEY_PAGE_UP) && (action != GLFW_RELEASE)) {   // Page Up -- jump 10 checkpoints back
+        glob_seekRequest -= 10;
+    } else if ((key == GLFW_KEY_HOME) && (action == GLFW_PRESS)) {        // Home -- jump to the start
+        glob_seekRequest = INT_MIN / 2;
+    } else if ((key == GLFW_KEY_END) && (action == GLFW_PRESS)) {         // End -- jump to the end
+        glob_seekRequest = INT_MAX / 2;
     } else if ((key == GLFW_KEY_UP) && (action != GLFW_RELEASE)) {
         glob_animSpeed = std::min(25.0f, glob_animSpeed * (action == GLFW_PRESS ? 1.2f : 1.05f));
         std::cout << "Animation speed RAISED to " << glob_animSpeed << std::endl;
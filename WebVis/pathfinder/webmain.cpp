@@ -1,6 +1,7 @@
 #include <chrono>
 #include <iostream>
 #include <getopt.h>
+#include <memory>
 #include <string>
 #include "../../pathfinder/moves/MoveManager.h"
 #include "../../pathfinder/search/ConfigurationSpace.h"
@@ -61,7 +62,7 @@ extern "C" {
         scenInfo.scenName = config_json.contains("name") ? config_json["name"] : "scen_out";
         scenInfo.scenDesc = config_json.contains("description") ? config_json["description"] : "config2Scen output";
         scenInfo.scenType = config_json.contains("moduleType") ? config_json["moduleType"] : "CUBE";
-        Scenario::ExportToScen(path, scenInfo, scen);
+        Scenario::ExportToScen(result.path, scenInfo, scen);
         scen_str = scen.str();
         return scen_str.c_str();
     }
@@ -108,7 +109,7 @@ extern "C" {
 
         // Set up moves
         std::cout << "Initializing Move Manager..." << std::endl;
-        MoveManager::InitMoveManager(Lattice::Order(), Lattice::AxisSize());
+        MoveManager::InitMoveManager(Lattice::Order(), MoveManager::MaxDistance() + 1);
         std::cout << "Move Manager initialized." << std::endl << "Loading Moves..." << std::endl;
         for (const auto& path : settings_json["movePaths"]) {
             MoveManager::RegisterAllMoves(path);
@@ -177,22 +178,16 @@ extern "C" {
         std::cout << std::endl;
 
         // Pathfinding
-        Configuration start(Lattice::GetModuleInfo());
-        BDConfiguration bidirectionalStart(start.GetModData(), START);
-        Configuration end = LatticeSetup::SetupFinalFromJson(config_f_stream);
-        BDConfiguration bidirectionalEnd(end.GetModData(), END);
-        std::vector<const Configuration*> path;
+        std::set<ModuleData> startData = Lattice::GetModuleInfo();
+        std::set<ModuleData> endData = LatticeSetup::SetupFinalFromJson(config_f_stream).GetModData();
+        SearchResult result;
         try {
             std::cout << "Beginning search..." << std::endl;
-            const auto timeBegin = std::chrono::high_resolution_clock::now();
-            if (settings_json["search"] == "A*") {
-                path = ConfigurationSpace::AStar(&start, &end, settings_json["heuristic"]);
-            } else {
-                path = ConfigurationSpace::BiDirectionalBFS(&bidirectionalStart, &bidirectionalEnd);
-            }
-            const auto timeEnd = std::chrono::high_resolution_clock::now();
-            const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(timeEnd - timeBegin);
-            std::cout << "Search completed in " << duration.count() << " ms." << std::endl;
+            result = ConfigurationSpace::Search(std::move(startData), std::move(endData),
+                                                settings_json["search"] == "A*" ? "A*" : "BDBFS",
+                                                settings_json["heuristic"]);
+            std::cout << "Search completed in " << result.duration.count() << " ms after " << result.restarts
+                      << " restart(s)." << std::endl;
         } catch(SearchExcept& searchExcept) {
             std::cerr << searchExcept.what() << std::endl;
         } catch(std::exception& exception) {
@@ -208,7 +203,7 @@ extern "C" {
         scenInfo.scenDesc = config_initial_json.contains("description") ? config_initial_json["description"] : "config2Scen output";
         scenInfo.scenType = config_initial_json.contains("moduleType") ? config_initial_json["moduleType"] : "CUBE";
 
-        Scenario::ExportToScen(path, scenInfo, scen);
+        Scenario::ExportToScen(result.path, scenInfo, scen);
         std::cout << "Results exported." << std::endl << "Cleaning Modules..." << std::endl;
         ModuleIdManager::CleanupModules();
         std::cout << "Modules cleaned." << std::endl << "Cleaning Moves..." << std::endl;
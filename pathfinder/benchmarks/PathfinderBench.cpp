@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <benchmark/benchmark.h>
+#include "../lattice/Lattice.h"
+#include "../lattice/LatticeSetup.h"
+#include "../moves/MoveManager.h"
+#include "../search/ConfigurationSpace.h"
+
+/* Benchmark Coordinate Sample Configuration
+ * Amount of random coordinates each CoordTensor benchmark iteration looks up.
+ */
+#ifndef BENCH_COORD_SAMPLES
+#define BENCH_COORD_SAMPLES 4096
+#endif
+/* Benchmark Seed Configuration
+ * Seed used when generating random coordinates, kept fixed so runs can be compared.
+ */
+#ifndef BENCH_SEED
+#define BENCH_SEED 0x5EED
+#endif
+
+namespace {
+    // Scenario in Test-Resources along with the options needed to search it
+    struct Fixture {
+        std::string name;
+        std::string movesFolder;
+        bool ignoreColors;
+        AdjOverride adjCheckOverride;
+    };
+
+    const std::vector<Fixture> fixtures = {
+        {"Heuristic-Checker", "Moves_Pivot", false, NONE},
+        {"Z-Pentomino", "Moves_Pivot", true, NONE},
+        {"Color-Shuffle", "Moves_Pivot", false, NONE},
+        {"Color-Shuffle-3D", "Moves_Pivot", false, NONE},
+        {"Rhombic-Color", "Moves_Rhombic", false, RHOMDOD},
+        {"Mixed-Modules", "Moves_ColorRestricted", false, NONE}
+    };
+
+    // States loaded from the fixture, set up before any benchmark runs
+    const Configuration* initialConfig = nullptr;
+    const Configuration* finalConfig = nullptr;
+    const BDConfiguration* bdInitialConfig = nullptr;
+    const BDConfiguration* bdFinalConfig = nullptr;
+    // A state one move away from the initial state, and the delta that reaches it
+    std::set<ModuleData> neighborState;
+    StateDelta neighborDelta;
+
+    std::vector<std::valarray<int>> RandomCoords(const int order, const int axisSize) {
+        std::mt19937 rng(BENCH_SEED);
+        std::uniform_int_distribution dist(0, axisSize - 1);
+        std::vector<std::valarray<int>> coords(BENCH_COORD_SAMPLES, std::valarray<int>(order));
+        for (auto& coord : coords) {
+            for (auto& c : coord) {
+                c = dist(rng);
+            }
+        }
+        return coords;
+    }
+
+    void BM_CoordTensorElementAt(benchmark::State& state) {
+        const int order = static_cast<int>(state.range(0));
+        const bool useOffset = state.range(1) != 0;
+        // Keep the element count close to 2^16 regardless of order
+        const int axisSize = static_cast<int>(std::round(std::pow(65536.0, 1.0 / order)));
+        const CoordTensor<int> tensor(order, axisSize, 0, useOffset ? std::valarray<int>(1, order) : std::valarray<int>());
+        // Offset coordinates are shifted by 1 on every axis, so they have to stay clear of the upper bound
+        const auto coords = RandomCoords(order, useOffset ? axisSize - 1 : axisSize);
+        for (auto _ : state) {
+            for (const auto& coord : coords) {
+                benchmark::DoNotOptimize(tensor.ElementAt(coord));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(coords.size()));
+    }
+    BENCHMARK(BM_CoordTensorElementAt)->ArgNames({"order", "offset"})->ArgsProduct({{2, 3, 4}, {0, 1}});
+
+    void BM_MoveCheck(benchmark::State& state) {
+        Lattice::UpdateFromModuleInfo(initialConfig->GetModData());
+        const auto movableModules = Lattice::MovableModules();
+        const auto& moves = MoveManager::Moves();
+        for (auto _ : state) {
+            int legalMoves = 0;
+            for (const auto module : movableModules) {
+                for (const auto move : moves) {
+                    legalMoves += move->MoveCheck(Lattice::coordTensor, *module);
+                }
+            }
+            benchmark::DoNotOptimize(legalMoves);
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(movableModules.size() * moves.size()));
+        state.SetLabel(Lattice::Order() == 2 ? "Move2d" : "Move3d");
+    }
+    BENCHMARK(BM_MoveCheck);
+
+    void BM_CheckAllMoves(benchmark::State& state) {
+        Lattice::UpdateFromModuleInfo(initialConfig->GetModData());
+        const auto movableModules = Lattice::MovableModules();
+        for (auto _ : state) {
+            for (const auto module : movableModules) {
+                benchmark::DoNotOptimize(MoveManager::CheckAllMoves(Lattice::coordTensor, *module));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(movableModules.size()));
+    }
+    BENCHMARK(BM_CheckAllMoves);
+
+    void BM_EdgeCheck(benchmark::State& state) {
+        Lattice::UpdateFromModuleInfo(initialConfig->GetModData());
+        auto& freeModules = ModuleIdManager::FreeModules();
+        for (auto _ : state) {
+            // Adjacencies are cleared first so that repeated checks don't add duplicate edges
+            for (const auto& module : freeModules) {
+                Lattice::ClearAdjacencies(module.id);
+                Lattice::EdgeCheck(module);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(freeModules.size()));
+    }
+    BENCHMARK(BM_EdgeCheck);
+
+    void BM_BuildMovableModules(benchmark::State& state) {
+        Lattice::UpdateFromModuleInfo(initialConfig->GetModData());
+        for (auto _ : state) {
+            Lattice::BuildMovableModules();
+            benchmark::DoNotOptimize(Lattice::MovableModules().data());
+        }
+    }
+    BENCHMARK(BM_BuildMovableModules);
+
+    void BM_BuildMovableModulesNonRec(benchmark::State& state) {
+        Lattice::UpdateFromModuleInfo(initialConfig->GetModData());
+        for (auto _ : state) {
+            Lattice::BuildMovableModulesNonRec();
+            benchmark::DoNotOptimize(Lattice::MovableModules().data());
+        }
+    }
+    BENCHMARK(BM_BuildMovableModulesNonRec);
+
+    // Alternates between the initial state and either a neighboring state (0) or the final state (1)
+    void BM_UpdateFromModuleInfo(benchmark::State& state) {
+        const auto& other = state.range(0) == 0 ? neighborState : finalConfig->GetModData();
+        if (other.empty()) {
+            state.SkipWithError("Initial state of fixture has no legal moves");
+            return;
+        }
+        const auto& initial = initialConfig->GetModData();
+        Lattice::UpdateFromModuleInfo(initial);
+        for (auto _ : state) {
+            Lattice::UpdateFromModuleInfo(other);
+            Lattice::UpdateFromModuleInfo(initial);
+        }
+        state.SetItemsProcessed(state.iterations() * 2);
+        state.SetLabel(state.range(0) == 0 ? "neighbor" : "final");
+    }
+    BENCHMARK(BM_UpdateFromModuleInfo)->ArgName("target")->Arg(0)->Arg(1);
+
+    // Full hash of a state, as done when a configuration is created from module data
+    void BM_HashedStateFull(benchmark::State& state) {
+        const auto& modData = initialConfig->GetModData();
+        for (auto _ : state) {
+            const HashedState hashedState(modData);
+            benchmark::DoNotOptimize(std::hash<HashedState>()(hashedState));
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(modData.size()));
+    }
+    BENCHMARK(BM_HashedStateFull);
+
+    // Incremental hash of a successor state, as done for every successor during search
+    void BM_HashedStateDelta(benchmark::State& state) {
+        if (neighborDelta.moves.empty()) {
+            state.SkipWithError("Initial state of fixture has no legal moves");
+            return;
+        }
+        const auto& parent = initialConfig->GetHash();
+        for (auto _ : state) {
+            const HashedState hashedState(parent, neighborDelta);
+            benchmark::DoNotOptimize(std::hash<HashedState>()(hashedState));
+        }
+    }
+    BENCHMARK(BM_HashedStateDelta);
+
+    template<typename Config>
+    void BM_Heuristic(benchmark::State& state, float (Config::*heuristic)(const Configuration*) const, const Config* from, const Config* to) {
+        for (auto _ : state) {
+            benchmark::DoNotOptimize((from->*heuristic)(to));
+        }
+    }
+
+    // Heuristics are registered once the fixture is loaded, cached heuristics build their caches on first use
+    void RegisterHeuristicBenchmarks() {
+        std::vector<std::pair<std::string, float (Configuration::*)(const Configuration*) const>> heuristics = {
+            {"SymmetricDifference", &Configuration::SymmetricDifferenceHeuristic},
+            {"Manhattan", &Configuration::ManhattanDistance},
+            {"Chebyshev", &Configuration::ChebyshevDistance},
+            {"TrueChebyshev", &Configuration::TrueChebyshevDistance},
+            {"CacheMoveOffset", &Configuration::CacheMoveOffsetDistance}
+        };
+        // Building the Chebyshev cache runs out of memory outside of 2D lattices
+        if (Lattice::Order() == 2) {
+            heuristics.emplace_back("CacheChebyshev", &Configuration::CacheChebyshevDistance);
+        }
+        // The property-based caches don't work when properties are ignored or dynamic
+        const bool usePropertyCache = !Lattice::ignoreProperties && !ModuleProperties::AnyDynamicPropertiesLinked();
+        Lattice::UpdateFromModuleInfo(initialConfig->GetModData());
+        for (const auto& [name, heuristic] : heuristics) {
+            (initialConfig->*heuristic)(finalConfig);
+            benchmark::RegisterBenchmark(("BM_Heuristic/" + name).c_str(), BM_Heuristic<Configuration>, heuristic, initialConfig, finalConfig);
+        }
+        if (usePropertyCache) {
+            initialConfig->CacheMoveOffsetPropertyDistance(finalConfig);
+            benchmark::RegisterBenchmark("BM_Heuristic/CacheMoveOffsetProperty", BM_Heuristic<Configuration>,
+                &Configuration::CacheMoveOffsetPropertyDistance, initialConfig, finalConfig);
+        }
+        bdInitialConfig->BDCacheMoveOffsetDistance(bdFinalConfig);
+        benchmark::RegisterBenchmark("BM_Heuristic/BDCacheMoveOffset", BM_Heuristic<BDConfiguration>,
+            &BDConfiguration::BDCacheMoveOffsetDistance, bdInitialConfig, bdFinalConfig);
+        if (usePropertyCache) {
+            bdInitialConfig->BDCacheMoveOffsetPropertyDistance(bdFinalConfig);
+            benchmark::RegisterBenchmark("BM_Heuristic/BDCacheMoveOffsetProperty", BM_Heuristic<BDConfiguration>,
+                &BDConfiguration::BDCacheMoveOffsetPropertyDistance, bdInitialConfig, bdFinalConfig);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string fixtureName = "Heuristic-Checker";
+    std::string resourcesFolder = "Test-Resources/";
+    // Pull out suite options before handing the remaining arguments to Google Benchmark
+    int benchArgc = 0;
+    for (int i = 0; i < argc; i++) {
+        if (const std::string arg = argv[i]; arg.starts_with("--fixture=")) {
+            fixtureName = arg.substr(10);
+        } else if (arg.starts_with("--resources=")) {
+            resourcesFolder = arg.substr(12);
+            if (!resourcesFolder.ends_with('/')) {
+                resourcesFolder += '/';
+            }
+        } else {
+            argv[benchArgc++] = argv[i];
+        }
+    }
+    argc = benchArgc;
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    const auto fixture = std::find_if(fixtures.begin(), fixtures.end(), [&fixtureName](const Fixture& f) {
+        return f.name == fixtureName;
+    });
+    if (fixture == fixtures.end()) {
+        std::cerr << "Unknown fixture: " << fixtureName << ", expected one of:" << std::endl;
+        for (const auto& f : fixtures) {
+            std::cerr << "    " << f.name << std::endl;
+        }
+        return 1;
+    }
+    const std::string initialFile = resourcesFolder + fixture->name + "_initial.json";
+    const std::string finalFile = resourcesFolder + fixture->name + "_final.json";
+    const std::string movesFolder = resourcesFolder + fixture->movesFolder;
+
+    // Same setup as Pathfinder
+    ModuleProperties::LinkProperties();
+    MoveManager::PreprocessMoves(movesFolder);
+    LatticeSetup::Preprocess(initialFile, finalFile);
+    LatticeSetup::adjCheckOverride = fixture->adjCheckOverride;
+    Lattice::SetFlags(fixture->ignoreColors);
+    LatticeSetup::SetupFromJson(initialFile);
+    MoveManager::InitMoveManager(Lattice::Order(), MoveManager::MaxDistance() + 1);
+    MoveManager::RegisterAllMoves(movesFolder);
+    const Configuration start(Lattice::GetModuleInfo());
+    const Configuration end = LatticeSetup::SetupFinalFromJson(finalFile);
+    const BDConfiguration bdStart(start.GetModData(), START);
+    const BDConfiguration bdEnd(end.GetModData(), END);
+    initialConfig = &start;
+    finalConfig = &end;
+    bdInitialConfig = &bdStart;
+    bdFinalConfig = &bdEnd;
+    if (auto deltas = start.MakeAllMoves(); !deltas.empty()) {
+        neighborDelta = std::move(deltas.front());
+        HashedState neighbor(start.GetHash(), neighborDelta);
+        neighbor.Materialize();
+        neighborState = neighbor.GetState();
+    }
+    RegisterHeuristicBenchmarks();
+
+    benchmark::AddCustomContext("fixture", fixture->name);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    ModuleIdManager::CleanupModules();
+    Isometry::CleanupTransforms();
+    return 0;
+}
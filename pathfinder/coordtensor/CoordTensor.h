@@ -1,5 +1,7 @@
 #include <valarray>
 #include <vector>
+#include <map>
+#include <memory>
 #include <cstring>
 
 #include <iostream>
@@ -9,6 +11,38 @@
 #ifndef TENSORFINAL_COORDTENSOR_H
 #define TENSORFINAL_COORDTENSOR_H
 
+// Shape of a tensor, shared by every tensor with the same axis sizes
+struct CoordTensorLayout {
+    // Length of each axis, the amount of axes is the order of the tensor
+    std::valarray<int> axisSizes;
+    // Amount of elements in a tensor of this shape
+    int size;
+    // Index distance between neighboring coordinates along each axis
+    std::valarray<int> strides;
+
+    // Get the layout for a shape, creating it if no living tensor uses it
+    static std::shared_ptr<const CoordTensorLayout> Get(const std::valarray<int>& axisSizes);
+};
+
+inline std::shared_ptr<const CoordTensorLayout> CoordTensorLayout::Get(const std::valarray<int>& axisSizes) {
+    static std::map<std::vector<int>, std::weak_ptr<const CoordTensorLayout>> layouts;
+    auto& cached = layouts[std::vector<int>(std::begin(axisSizes), std::end(axisSizes))];
+    if (auto layout = cached.lock()) {
+        return layout;
+    }
+    auto layout = std::make_shared<CoordTensorLayout>();
+    layout->axisSizes = axisSizes;
+    layout->strides.resize(axisSizes.size());
+    int stride = 1;
+    for (int i = 0; i < axisSizes.size(); i++) {
+        layout->strides[i] = stride;
+        stride *= axisSizes[i];
+    }
+    layout->size = stride;
+    cached = layout;
+    return layout;
+}
+
 template <typename T>
 class CoordTensor {
 public:
@@ -19,8 +53,12 @@ public:
     // would mean that only the integers 0-9 would be valid coordinates.
     CoordTensor(int order, int axisSize, const typename std::vector<T>::value_type& value, const std::valarray<int>& originOffset = {});
 
+    // Same as above but every axis has its own length, the order is
+    // the amount of axis sizes given.
+    CoordTensor(const std::valarray<int>& axisSizes, const typename std::vector<T>::value_type& value, const std::valarray<int>& originOffset = {});
+
     // Gets a reference to an ID directly from the internal array, this
-    // is always faster than calling IdAtInternal but requires a pre-calculated
+    // is always faster than calling ElementAt but requires a pre-calculated
     // index in order to work.
     typename std::vector<T>::reference GetElementDirect(int index);
 
@@ -49,16 +87,25 @@ public:
     [[nodiscard]]
     int Order() const;
 
-    // Get a copy of axisSize
+    // Get the length of an axis
+    [[nodiscard]]
+    int AxisSize(int axis) const;
+
+    // Get the length of every axis
     [[nodiscard]]
-    int AxisSize() const;
+    const std::valarray<int>& AxisSizes() const;
 
     // Get a coordinate vector from an index
     [[nodiscard]]
-    const std::valarray<int>& CoordsFromIndex(int index) const;
+    std::valarray<int> CoordsFromIndex(int index) const;
+
+    // Same as above but writes into an existing coordinate vector,
+    // which avoids an allocation when walking over many indices
+    void CoordsFromIndex(int index, std::valarray<int>& coords) const;
 
     // Get an index from a coordinate vector
     // (Coordinates do not need to be within bounds)
+    [[nodiscard]]
     int IndexFromCoords(const std::valarray<int>& coords) const;
 
     // Assign a value to every position in the tensor
@@ -66,43 +113,29 @@ public:
 
     void FillFromVector(const std::vector<T>& vec);
 
+    // Get amount of memory used to store elements, in bytes
+    [[nodiscard]]
+    std::size_t ElementMemoryUsage() const;
+
+    // Get amount of memory used by the layout, in bytes
+    // (The layout is shared with other tensors of the same shape)
+    [[nodiscard]]
+    std::size_t CoordsMemoryUsage() const;
+
     // Comparison Operators
     bool operator==(const CoordTensor<T>& right) const;
     bool operator!=(const CoordTensor<T>& right) const;
 private:
     int _order;
-    // Axis size, useful for bounds checking
-    int _axisSize;
-    // Origin offset
-    std::valarray<int> _offset;
-    // Coordinate multiplier cache for tensors of order > 3
-    std::valarray<int> _axisMultipliers;
-    // Internal array for rapid conversion from index to coordinate
-    std::vector<std::valarray<int>> _coordsInternal;
+    // Strides of the 2nd and 3rd axes, kept here so common lookups don't go through the layout
+    int _stride1 = 0;
+    int _stride2 = 0;
+    // Index of the origin offset, added to every coordinate lookup
+    int _offsetIndex = 0;
+    // Strides and sizes, shared between tensors of the same shape
+    std::shared_ptr<const CoordTensorLayout> _layout;
     // Internal array responsible for holding module IDs
     std::vector<T> _arrayInternal;
-    // Internal array responsible for holding slices of _arrayInternal
-    std::vector<T*> _arrayInternal2D;
-    // Internal array responsible for holding slices of _arrayInternal2D
-    std::vector<T**> _arrayInternal3D;
-    // Did you know that calling member function pointers looks really weird?
-    typename std::vector<T>::reference (CoordTensor::*IdAtInternal)(const std::valarray<int>& coords);
-    typename std::vector<T>::const_reference (CoordTensor::*IdAtInternalConst)(const std::valarray<int>& coords) const;
-    typename std::vector<T>::reference (CoordTensor::*IdAtInternalOffset)(const std::valarray<int>& coords);
-    typename std::vector<T>::const_reference (CoordTensor::*IdAtInternalOffsetConst)(const std::valarray<int>& coords) const;
-    // 2nd and 3rd order tensors benefit from specialized IdAt functions
-    typename std::vector<T>::reference ElemAt2ndOrder (const std::valarray<int>& coords);
-    [[nodiscard]]
-    typename std::vector<T>::const_reference ElemAt2ndOrderConst (const std::valarray<int>& coords) const;
-    typename std::vector<T>::reference ElemAt3rdOrder (const std::valarray<int>& coords);
-    [[nodiscard]]
-    typename std::vector<T>::const_reference ElemAt3rdOrderConst (const std::valarray<int>& coords) const;
-    // Generalized IdAtInternal function
-    typename std::vector<T>::reference ElemAtNthOrder (const std::valarray<int>& coords);
-    typename std::vector<T>::const_reference ElemAtNthOrderConst (const std::valarray<int>& coords) const;
-    // Offset IdAt
-    typename std::vector<T>::reference ElemAtNthOrderOffset (const std::valarray<int>& coords);
-    typename std::vector<T>::const_reference ElemAtNthOrderOffsetConst (const std::valarray<int>& coords) const;
 };
 
 template<typename T>
@@ -121,155 +154,78 @@ int CoordTensor<T>::Order() const {
 }
 
 template<typename T>
-int CoordTensor<T>::AxisSize() const {
-    return _axisSize;
+int CoordTensor<T>::AxisSize(const int axis) const {
+    return _layout->axisSizes[axis];
 }
 
 template<typename T>
-const std::valarray<int>& CoordTensor<T>::CoordsFromIndex(int index) const {
-    return _coordsInternal[index];
+const std::valarray<int>& CoordTensor<T>::AxisSizes() const {
+    return _layout->axisSizes;
 }
 
 template<typename T>
-int CoordTensor<T>::IndexFromCoords(const std::valarray<int> &coords) const {
-    return (coords * _axisMultipliers).sum();
+std::valarray<int> CoordTensor<T>::CoordsFromIndex(int index) const {
+    std::valarray<int> coords(_order);
+    CoordsFromIndex(index, coords);
+    return coords;
 }
 
-template <typename T>
-CoordTensor<T>::CoordTensor(int order, int axisSize, const typename std::vector<T>::value_type& value, const std::valarray<int>& originOffset) {
-    _order = order;
-    _axisSize = axisSize;
-    // Calculate number of elements in tensor
-    int internalSize = (int) std::pow(_axisSize, order);
-    // Resize internal array to accommodate all elements
-    _arrayInternal.resize(internalSize, value);
-    // Setup Index -> Coordinate array
-    _coordsInternal.resize(internalSize);
-    std::valarray<int> coords;
-    coords.resize(order, 0);
-    for (int i = 0; i < internalSize; i++) {
-        _coordsInternal[i] = coords;
-        for (int j = 0; j < order; j++) {
-            if (++coords[j] == axisSize) {
-                coords[j] = 0;
-            } else break;
-        }
+template<typename T>
+void CoordTensor<T>::CoordsFromIndex(int index, std::valarray<int>& coords) const {
+    for (int i = 0; i < _order; i++) {
+        coords[i] = index % _layout->axisSizes[i];
+        index /= _layout->axisSizes[i];
     }
-    // Set size of 2nd order array
-    internalSize = _axisSize;
-    switch (order) {
-        case 3:
-            // 2nd order array will need to be larger if tensor is 3rd order
-            internalSize *= _axisSize;
+}
+
+template<typename T>
+std::size_t CoordTensor<T>::ElementMemoryUsage() const {
+    return _arrayInternal.capacity() * sizeof(T);
+}
+
+template<typename T>
+std::size_t CoordTensor<T>::CoordsMemoryUsage() const {
+    return sizeof(CoordTensorLayout) + (_layout->axisSizes.size() + _layout->strides.size()) * sizeof(int);
+}
+
+template<typename T>
+inline int CoordTensor<T>::IndexFromCoords(const std::valarray<int> &coords) const {
+    // 2nd and 3rd order tensors are by far the most common, so they skip the stride loop
+    switch (_order) {
         case 2:
-            // Initialize 2nd order array
-            _arrayInternal2D.resize(internalSize);
-            for (int i = 0; i < internalSize; i++) {
-                _arrayInternal2D[i] = &(_arrayInternal[i * _axisSize]);
-            }
-            if (internalSize == _axisSize) {
-                // If internalSize wasn't modified by case 3, then tensor is 2nd order
-                IdAtInternal = &CoordTensor::ElemAt2ndOrder;
-                IdAtInternalConst = &CoordTensor::ElemAt2ndOrderConst;
-                DEBUG("2nd order tensor created\n");
-                break;
-            }
-            // Otherwise tensor is 3rd order
-            // Initialize 3rd order array
-            _arrayInternal3D.resize(_axisSize);
-            for (int i = 0; i < _axisSize; i++) {
-                _arrayInternal3D[i] = &(_arrayInternal2D[i * _axisSize]);
-            }
-            IdAtInternal = &CoordTensor::ElemAt3rdOrder;
-            IdAtInternalConst = &CoordTensor::ElemAt3rdOrderConst;
-            DEBUG("3rd order tensor created\n");
-            break;
+            return coords[0] + coords[1] * _stride1;
+        case 3:
+            return coords[0] + coords[1] * _stride1 + coords[2] * _stride2;
         default:
-            // Use coordinate multiplier cache for arbitrary dimensions
-            IdAtInternal = &CoordTensor::ElemAtNthOrder;
-            IdAtInternalConst = &CoordTensor::ElemAtNthOrderConst;
-            DEBUG("Tensor of order " << order << " created\n");
-    }
-    // If the tensor is not 2nd or 3rd order then the
-    // coordinate multiplier cache needs to be set up
-    // Also useful for index caching
-    _axisMultipliers.resize(order);
-    int multiplier = 1;
-    for (int i = 0; i < order; i++) {
-        _axisMultipliers[i] = multiplier;
-        multiplier *= _axisSize;
-    }
-    // Offset setup
-    if (originOffset.size() != 0) {
-        _offset = originOffset;
-        IdAtInternalOffset = IdAtInternal;
-        IdAtInternalOffsetConst = IdAtInternalConst;
-        IdAtInternal = &CoordTensor::ElemAtNthOrderOffset;
-        IdAtInternalConst = &CoordTensor::ElemAtNthOrderOffsetConst;
+            int index = 0;
+            for (int i = 0; i < _order; i++) {
+                index += coords[i] * _layout->strides[i];
+            }
+            return index;
     }
-#ifndef NDEBUG
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "ConstantConditionsOC"
-#pragma ide diagnostic ignored "UnreachableCode"
-    std::cout << "IdAtInternal Function: " << (
-            IdAtInternal == &CoordTensor::ElemAt3rdOrder ? "ElemAt3rdOrder" :
-            IdAtInternal == &CoordTensor::ElemAt2ndOrder ? "ElemAt2ndOrder" :
-            IdAtInternal == &CoordTensor::ElemAtNthOrder ? "ElemAtNthOrder" :
-            IdAtInternal == &CoordTensor::ElemAtNthOrderOffset ? "ElemAtNthOrderOffset" :
-            "Invalid Function!") << std::endl;
-#pragma clang diagnostic pop
-#endif
 }
 
-template<>
-inline CoordTensor<bool>::CoordTensor(int order, int axisSize, const typename std::vector<bool>::value_type& value, const std::valarray<int>& originOffset) {
-    _order = order;
-    _axisSize = axisSize;
-    // Calculate number of elements in tensor
-    int internalSize = (int) std::pow(_axisSize, order);
-    // Resize internal array to accommodate all elements
-    _arrayInternal.resize(internalSize, value);
-    // Setup Index -> Coordinate array
-    _coordsInternal.resize(internalSize);
-    std::valarray<int> coords;
-    coords.resize(order, 0);
-    for (int i = 0; i < internalSize; i++) {
-        _coordsInternal[i] = coords;
-        for (int j = 0; j < order; j++) {
-            if (++coords[j] == axisSize) {
-                coords[j] = 0;
-            } else break;
-        }
+template <typename T>
+CoordTensor<T>::CoordTensor(int order, int axisSize, const typename std::vector<T>::value_type& value, const std::valarray<int>& originOffset)
+    : CoordTensor(std::valarray<int>(axisSize, order), value, originOffset) {}
+
+template <typename T>
+CoordTensor<T>::CoordTensor(const std::valarray<int>& axisSizes, const typename std::vector<T>::value_type& value, const std::valarray<int>& originOffset) {
+    _order = static_cast<int>(axisSizes.size());
+    _layout = CoordTensorLayout::Get(axisSizes);
+    if (_order > 1) {
+        _stride1 = _layout->strides[1];
     }
-    // If the tensor is not 2nd or 3rd order then the
-    // coordinate multiplier cache needs to be set up
-    _axisMultipliers.resize(order);
-    int multiplier = 1;
-    for (int i = 0; i < order; i++) {
-        _axisMultipliers[i] = multiplier;
-        multiplier *= _axisSize;
+    if (_order > 2) {
+        _stride2 = _layout->strides[2];
     }
-    IdAtInternal = &CoordTensor::ElemAtNthOrder;
-    IdAtInternalConst = &CoordTensor::ElemAtNthOrderConst;
-    DEBUG("Tensor of order " << order << " created\n");
-    // Offset setup
+    // Resize internal array to accommodate all elements
+    _arrayInternal.resize(_layout->size, value);
+    // Offset setup, since indexing is linear the offset can be applied to the index instead of the coordinates
     if (originOffset.size() != 0) {
-        _offset = originOffset;
-        IdAtInternalOffset = IdAtInternal;
-        IdAtInternalOffsetConst = IdAtInternalConst;
-        IdAtInternal = &CoordTensor::ElemAtNthOrderOffset;
-        IdAtInternalConst = &CoordTensor::ElemAtNthOrderOffsetConst;
+        _offsetIndex = IndexFromCoords(originOffset);
     }
-#ifndef NDEBUG
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "ConstantConditionsOC"
-#pragma ide diagnostic ignored "UnreachableCode"
-    std::cout << "IdAtInternal Function: " << (
-            IdAtInternal == &CoordTensor::ElemAtNthOrder ? "ElemAtNthOrder" :
-            IdAtInternal == &CoordTensor::ElemAtNthOrderOffset ? "ElemAtNthOrderOffset" :
-            "Invalid Function!") << std::endl;
-#pragma clang diagnostic pop
-#endif
+    DEBUG("Tensor of order " << _order << " created\n");
 }
 
 template <typename T>
@@ -284,55 +240,22 @@ typename std::vector<T>::const_reference CoordTensor<T>::GetElementDirect(int in
 
 template <typename T>
 inline typename std::vector<T>::reference CoordTensor<T>::ElementAt(const std::valarray<int>& coords) {
-    // Told you calling member function pointers looks weird
-    return (this->*IdAtInternal)(coords);
-    // This would look even worse if IdAtInternal were called from outside,
-    // it'd look like this: (tensor3D.*(tensor3D.IdAtInternal))({8, 4, 6}) <-- Not Good
+    return _arrayInternal[IndexFromCoords(coords) + _offsetIndex];
 }
 
 template <typename T>
 inline typename std::vector<T>::const_reference CoordTensor<T>::ElementAt(const std::valarray<int>& coords) const {
-    return (this->*IdAtInternalConst)(coords);
-}
-
-template <typename T>
-typename std::vector<T>::reference CoordTensor<T>::ElemAt2ndOrder (const std::valarray<int>& coords) {
-    return _arrayInternal2D[coords[1]][coords[0]];
-}
-
-template <typename T>
-typename std::vector<T>::const_reference CoordTensor<T>::ElemAt2ndOrderConst (const std::valarray<int>& coords) const {
-    return _arrayInternal2D[coords[1]][coords[0]];
-}
-
-template <typename T>
-typename std::vector<T>::reference CoordTensor<T>::ElemAt3rdOrder (const std::valarray<int>& coords) {
-    return _arrayInternal3D[coords[2]][coords[1]][coords[0]];
-}
-
-template <typename T>
-typename std::vector<T>::const_reference CoordTensor<T>::ElemAt3rdOrderConst (const std::valarray<int>& coords) const {
-    return _arrayInternal3D[coords[2]][coords[1]][coords[0]];
-}
-
-template <typename T>
-typename std::vector<T>::reference CoordTensor<T>::ElemAtNthOrder (const std::valarray<int>& coords) {
-    return _arrayInternal[(coords * _axisMultipliers).sum()];
-}
-
-template <typename T>
-typename std::vector<T>::const_reference CoordTensor<T>::ElemAtNthOrderConst (const std::valarray<int>& coords) const {
-    return _arrayInternal[(coords * _axisMultipliers).sum()];
+    return _arrayInternal[IndexFromCoords(coords) + _offsetIndex];
 }
 
 template <typename T>
 typename std::vector<T>::reference CoordTensor<T>::operator[](const std::valarray<int>& coords) {
-    return (this->*IdAtInternal)(coords);
+    return ElementAt(coords);
 }
 
 template <typename T>
 typename std::vector<T>::const_reference CoordTensor<T>::operator[](const std::valarray<int>& coords) const {
-    return (this->*IdAtInternalConst)(coords);
+    return ElementAt(coords);
 }
 
 template <typename T>
@@ -340,16 +263,6 @@ const std::vector<T>& CoordTensor<T>::GetArrayInternal() const {
     return _arrayInternal;
 }
 
-template <typename T>
-inline typename std::vector<T>::reference CoordTensor<T>::ElemAtNthOrderOffset (const std::valarray<int>& coords) {
-    return (this->*IdAtInternalOffset)(coords + _offset);
-}
-
-template <typename T>
-inline typename std::vector<T>::const_reference CoordTensor<T>::ElemAtNthOrderOffsetConst (const std::valarray<int>& coords) const {
-    return (this->*IdAtInternalOffsetConst)(coords + _offset);
-}
-
 template<typename T>
 void CoordTensor<T>::Fill(const typename std::vector<T>::value_type& value) {
     std::memset(_arrayInternal.data(), value, sizeof(_arrayInternal));
@@ -5,8 +5,15 @@
 #include <map>
 #include "../utility/debug_util.h"
 #include "../utility/color_util.h"
+#include "../search/Profiler.h"
+#include "../search/MemoryTracker.h"
+#include "../moves/MoveManager.h"
 #include "Lattice.h"
 
+const char* LatticeEdgeExcept::what() const noexcept {
+    return "Module too close to the edge of the lattice!";
+}
+
 const std::vector<std::valarray<int>> LatticeUtils::cubeAdjOffsets = {
     { 1,  0,  0},
     { 0,  1,  0},
@@ -33,13 +40,20 @@ const std::vector<std::valarray<int>> LatticeUtils::rhomDodAdjOffsets = {
 
 std::vector<std::vector<int>> Lattice::adjList;
 int Lattice::order;
-int Lattice::axisSize;
+std::valarray<int> Lattice::axisSizes;
 int Lattice::boundarySize;
+int Lattice::edgeDistance = 0;
 int Lattice::time = 0;
 int Lattice::moduleCount = 0;
 bool Lattice::ignoreProperties = false;
 std::valarray<int> Lattice::boundaryOffset;
 std::vector<Module*> Lattice::movableModules;
+std::size_t Lattice::revision = 0;
+std::size_t Lattice::generation = 0;
+std::vector<std::valarray<int>> Lattice::bounds;
+std::vector<std::valarray<int>> Lattice::adjOffsets;
+std::size_t Lattice::trackedElementBytes = 0;
+std::size_t Lattice::trackedCoordsBytes = 0;
 CoordTensor<int> Lattice::coordTensor(1, 1, -1);
 
 void Lattice::ClearAdjacencies(const int moduleId) {
@@ -54,20 +68,61 @@ void Lattice::ClearAdjacencies(const int moduleId) {
     adjList[moduleId].clear();
 }
 
-void Lattice::InitLattice(const int _order, const int _axisSize, const int _boundarySize) {
-    order = _order;
-    axisSize = _axisSize + 2 * _boundarySize;
+void Lattice::InitLattice(const std::valarray<int>& _axisSizes, const int _boundarySize) {
+    order = static_cast<int>(_axisSizes.size());
+    axisSizes = _axisSizes + 2 * _boundarySize;
     boundarySize = _boundarySize;
     boundaryOffset = std::valarray<int>(boundarySize, order);
-    coordTensor = CoordTensor<int>(order, axisSize, OUT_OF_BOUNDS);
+    coordTensor = CoordTensor<int>(axisSizes, OUT_OF_BOUNDS);
+    MoveManager::ClearLegalMoves();
+    revision++;
+    generation++;
+    TrackTensorMemory();
+    std::valarray<int> coords(order);
     for (int i = 0; i < coordTensor.GetArrayInternal().size(); i++) {
-        if (std::any_of(begin(coordTensor.CoordsFromIndex(i)), end(coordTensor.CoordsFromIndex(i)), [](const int coord) {
-            return coord < boundarySize || coord >= (axisSize - boundarySize);
-        })) {
-            continue;
+        coordTensor.CoordsFromIndex(i, coords);
+        bool inBounds = true;
+        for (int j = 0; j < order && inBounds; j++) {
+            inBounds = coords[j] >= boundarySize && coords[j] < axisSizes[j] - boundarySize;
         }
-        coordTensor.GetElementDirect(i) = FREE_SPACE;
+        if (inBounds) {
+            coordTensor.GetElementDirect(i) = FREE_SPACE;
+        }
+    }
+}
+
+void Lattice::TrackTensorMemory() {
+    // The placeholder tensor from before initialization isn't tracked
+    if (trackedElementBytes != 0) {
+        MemoryTracker::Deallocate(MEM_COORD_TENSORS, trackedElementBytes);
+        MemoryTracker::Deallocate(MEM_COORD_TABLES, trackedCoordsBytes);
+    }
+    trackedElementBytes = coordTensor.ElementMemoryUsage();
+    trackedCoordsBytes = coordTensor.CoordsMemoryUsage();
+    MemoryTracker::Allocate(MEM_COORD_TENSORS, trackedElementBytes);
+    MemoryTracker::Allocate(MEM_COORD_TABLES, trackedCoordsBytes);
+}
+
+void Lattice::Resize(const std::valarray<int>& _axisSizes, const std::valarray<int>& shift) {
+    InitLattice(_axisSizes, boundarySize);
+    // Adjacency indices depend on the axis sizes
+    const auto offsets = std::move(adjOffsets);
+    adjOffsets.clear();
+    adjIndices.clear();
+    SetAdjIndicesFromOffsets(offsets);
+    // Put everything back in the same order it was originally added
+    adjList.clear();
+    moduleCount = 0;
+    for (auto& mod : ModuleIdManager::Modules()) {
+        mod.coords += shift;
+        AddModule(mod);
+    }
+    const auto oldBounds = std::move(bounds);
+    bounds.clear();
+    for (const auto& bound : oldBounds) {
+        AddBound(bound + shift);
     }
+    BuildMovableModules();
 }
 
 void Lattice::SetFlags(const bool _ignoreColors) {
@@ -77,6 +132,8 @@ void Lattice::SetFlags(const bool _ignoreColors) {
 void Lattice::AddModule(const Module& mod) {
     // Update coord tensor
     coordTensor[mod.coords] = mod.id;
+    MoveManager::ClearLegalMoves();
+    revision++;
     // Adjacency check
 #if LATTICE_OLD_EDGECHECK
 #if LATTICE_RD_EDGECHECK
@@ -93,6 +150,9 @@ void Lattice::AddModule(const Module& mod) {
 
 void Lattice::AddBound(const std::valarray<int>& coords) {
     coordTensor[coords] = OUT_OF_BOUNDS;
+    bounds.push_back(coords);
+    MoveManager::ClearLegalMoves();
+    revision++;
 }
 
 bool Lattice::CheckConnected(int permitMissing) {
@@ -116,10 +176,22 @@ bool Lattice::CheckConnected(int permitMissing) {
     return visitedCount >= moduleCount - permitMissing;
 }
 
+bool Lattice::NearEdge() {
+    if (edgeDistance == 0) return false;
+    for (const auto& mod : ModuleIdManager::FreeModules()) {
+        for (int i = 0; i < order; i++) {
+            if (mod.coords[i] < boundarySize + edgeDistance || mod.coords[i] >= axisSizes[i] - boundarySize - edgeDistance) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 std::vector<int> Lattice::adjIndices;
 
 void Lattice::EdgeCheck(const Module& mod) {
-    static const int maxIdx = coordTensor.GetArrayInternal().size() - 1;
+    const int maxIdx = static_cast<int>(coordTensor.GetArrayInternal().size()) - 1;
     const int modIdx = coordTensor.IndexFromCoords(mod.coords);
     for (const int idx : adjIndices) {
         if (modIdx + idx < 0 || modIdx + idx > maxIdx) continue;
@@ -137,6 +209,7 @@ void Lattice::SetAdjIndicesFromOffsets(const std::vector<std::valarray<int>>& of
         }
         if (int idx = coordTensor.IndexFromCoords(offset); idx != 0) {
             adjIndices.push_back(idx);
+            adjOffsets.push_back(offset);
         }
     }
 }
@@ -156,7 +229,7 @@ void Lattice::CubeEdgeCheck(const Module& mod) {
             AddEdge(mod.id, coordTensor[adjCoords]);
         }
         // Don't want to check both ways if it can be avoided, also don't want to check index beyond max value
-        if (adjCoords[i] + 2 == axisSize) {
+        if (adjCoords[i] + 2 == axisSizes[i]) {
             adjCoords[i]++;
             continue;
         }
@@ -188,7 +261,7 @@ void Lattice::RDEdgeCheck(const Module& mod) {
             // offset: 1, -1, 0
             adjCoords[0]++;
         }
-        if (adjCoords[0] != axisSize) {
+        if (adjCoords[0] != axisSizes[0]) {
             if (coordTensor[adjCoords] >= 0) {
                 AddEdge(mod.id, coordTensor[adjCoords]);
             }
@@ -207,7 +280,7 @@ void Lattice::RDEdgeCheck(const Module& mod) {
             // offset: 0, -1, 1
             adjCoords[2]++;
         }
-        if (adjCoords[2] != axisSize) {
+        if (adjCoords[2] != axisSizes[2]) {
             if (coordTensor[adjCoords] >= 0) {
                 AddEdge(mod.id, coordTensor[adjCoords]);
             }
@@ -219,7 +292,7 @@ void Lattice::RDEdgeCheck(const Module& mod) {
         // offset: 0, 1, 0
         adjCoords[1]++;
     }
-    if (adjCoords[1] != axisSize) {
+    if (adjCoords[1] != axisSizes[1]) {
         if (adjCoords[0] != 0) {
             // offset: -1, 1, 0
             adjCoords[0]--;
@@ -232,7 +305,7 @@ void Lattice::RDEdgeCheck(const Module& mod) {
             // offset: 1, 1, 0
             adjCoords[0]++;
         }
-        if (adjCoords[0] != axisSize) {
+        if (adjCoords[0] != axisSizes[0]) {
             if (coordTensor[adjCoords] >= 0) {
                 AddEdge(mod.id, coordTensor[adjCoords]);
             }
@@ -251,7 +324,7 @@ void Lattice::RDEdgeCheck(const Module& mod) {
             // offset: 0, 1, 1
             adjCoords[2]++;
         }
-        if (adjCoords[2] != axisSize) {
+        if (adjCoords[2] != axisSizes[2]) {
             if (coordTensor[adjCoords] >= 0) {
                 AddEdge(mod.id, coordTensor[adjCoords]);
             }
@@ -278,7 +351,7 @@ void Lattice::RDEdgeCheck(const Module& mod) {
             // offset: -1, 0, 1
             adjCoords[2]++;
         }
-        if (adjCoords[2] != axisSize) {
+        if (adjCoords[2] != axisSizes[2]) {
             if (coordTensor[adjCoords] >= 0) {
                 AddEdge(mod.id, coordTensor[adjCoords]);
             }
@@ -290,7 +363,7 @@ void Lattice::RDEdgeCheck(const Module& mod) {
         // offset: 1, 0, 0
         adjCoords[0]++;
     }
-    if (adjCoords[0] != axisSize) {
+    if (adjCoords[0] != axisSizes[0]) {
         if (adjCoords[2] != 0) {
             // offset: -1, 0, -1
             adjCoords[2]--;
@@ -303,7 +376,7 @@ void Lattice::RDEdgeCheck(const Module& mod) {
             // offset: -1, 0, 1
             adjCoords[2]++;
         }
-        if (adjCoords[2] != axisSize) {
+        if (adjCoords[2] != axisSizes[2]) {
             if (coordTensor[adjCoords] >= 0) {
                 AddEdge(mod.id, coordTensor[adjCoords]);
             }
@@ -345,6 +418,7 @@ void Lattice::APUtil(const int u, std::vector<bool>& visited, std::vector<bool>&
 }
 
 void Lattice::BuildMovableModules() {
+    PROFILE_SCOPE(PROFILE_BUILD_MOVABLE_MODULES);
     time = 0;
     std::vector<bool> visited(moduleCount, false);
     std::vector<int> disc(moduleCount, -1);
@@ -373,6 +447,7 @@ void Lattice::BuildMovableModules() {
 }
 
 void Lattice::BuildMovableModulesNonRec() {
+    PROFILE_SCOPE(PROFILE_BUILD_MOVABLE_MODULES);
     // Clear movableModules vector
     movableModules.clear();
 
@@ -447,7 +522,9 @@ const std::vector<Module*>& Lattice::MovableModules() {
     return movableModules;
 }
 
-void Lattice::UpdateFromModuleInfo(const std::set<ModuleData>& moduleInfo) {
+int Lattice::UpdateFromModuleInfo(const std::set<ModuleData>& moduleInfo) {
+    PROFILE_SCOPE(PROFILE_UPDATE_FROM_MODULE_INFO);
+    revision++;
     std::queue<const ModuleData*> destinations;
     std::unordered_set<int> modsToMove;
     for (int id = 0; id < ModuleIdManager::MinStaticID(); id++) {
@@ -460,6 +537,7 @@ void Lattice::UpdateFromModuleInfo(const std::set<ModuleData>& moduleInfo) {
             modsToMove.erase(id);
             if (mod.properties != info.Properties()) {
                 mod.properties = info.Properties();
+                MoveManager::InvalidateLegalMoves(mod.coords);
             }
         } else {
             destinations.push(&info);
@@ -467,11 +545,12 @@ void Lattice::UpdateFromModuleInfo(const std::set<ModuleData>& moduleInfo) {
     }
     if (modsToMove.size() != destinations.size()) {
         std::cerr << "Update partially completed due to state error, program likely non-functional!" << std::endl;
-        return;
+        return 0;
     }
     for (const auto id : modsToMove) {
         auto& mod = ModuleIdManager::GetModule(id);
         Lattice::coordTensor[mod.coords] = FREE_SPACE;
+        MoveManager::InvalidateLegalMoves(mod.coords);
         mod.coords = destinations.front()->Coords();
         ClearAdjacencies(id);
 #if LATTICE_OLD_EDGECHECK
@@ -484,12 +563,15 @@ void Lattice::UpdateFromModuleInfo(const std::set<ModuleData>& moduleInfo) {
         EdgeCheck(mod);
 #endif
         Lattice::coordTensor[mod.coords] = mod.id;
+        MoveManager::InvalidateLegalMoves(mod.coords);
         mod.properties = destinations.front()->Properties();
         destinations.pop();
     }
+    return modsToMove.size();
 }
 
 std::set<ModuleData> Lattice::GetModuleInfo() {
+    PROFILE_SCOPE(PROFILE_GET_MODULE_INFO);
     std::set<ModuleData> modInfo;
     for (int id = 0; id < ModuleIdManager::MinStaticID(); id++) {
         const auto& mod = ModuleIdManager::GetModule(id);
@@ -502,8 +584,20 @@ int Lattice::Order() {
     return order;
 }
 
-int Lattice::AxisSize() {
-    return axisSize;
+int Lattice::AxisSize(const int axis) {
+    return axisSizes[axis];
+}
+
+const std::valarray<int>& Lattice::AxisSizes() {
+    return axisSizes;
+}
+
+std::size_t Lattice::Revision() {
+    return revision;
+}
+
+std::size_t Lattice::Generation() {
+    return generation;
 }
 
 std::string Lattice::ToString() {
@@ -542,7 +636,7 @@ std::string Lattice::ToString() {
         } else {
             out << "⋅";
         }
-        if ((i + 1) % axisSize == 0) {
+        if ((i + 1) % axisSizes[0] == 0) {
             out << '\n';
         }
     }
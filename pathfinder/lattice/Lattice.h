@@ -37,6 +37,13 @@ enum TensorContents {
     OCCUPIED_NO_ANCHOR = std::numeric_limits<int>::max()
 };
 
+// Thrown by searches when a module gets close enough to the edge of the lattice that moves could be blocked by it
+class LatticeEdgeExcept final : public std::exception {
+public:
+    [[nodiscard]]
+    const char* what() const noexcept override;
+};
+
 namespace LatticeUtils {
     extern const std::vector<std::valarray<int>> cubeAdjOffsets;
 
@@ -49,17 +56,27 @@ private:
     static std::vector<std::vector<int>> adjList;
     // Order of coordinate tensor / # of dimensions
     static int order;
-    // Length of every axis
-    static int axisSize;
+    // Length of each axis
+    static std::valarray<int> axisSizes;
     // Time variable for DFS
     static int time;
     // # of modules
     static int moduleCount;
     // Vector of movable modules
     static std::vector<Module*> movableModules;
-
-    // Clear adjacency list for module ID, and remove module ID from other lists
-    static void ClearAdjacencies(int moduleId);
+    // Incremented whenever the lattice is changed other than by moves that are later undone
+    static std::size_t revision;
+    // Incremented whenever the lattice is initialized or resized, since coordinates change meaning
+    static std::size_t generation;
+    // Boundaries and adjacency offsets, kept so they can be placed again when the lattice is resized
+    static std::vector<std::valarray<int>> bounds;
+    static std::vector<std::valarray<int>> adjOffsets;
+    // Memory of the module tensor currently reported to the memory tracker
+    static std::size_t trackedElementBytes;
+    static std::size_t trackedCoordsBytes;
+
+    // Report the module tensor's memory to the memory tracker in place of what was reported before
+    static void TrackTensorMemory();
 
 public:
     // Module tensor
@@ -69,12 +86,17 @@ public:
     static std::valarray<int> boundaryOffset;
     // Color flag
     static bool ignoreProperties;
+    // Modules closer than this to the boundary padding are near the edge, 0 if the lattice can't grow any further
+    static int edgeDistance;
 
     Lattice() = delete;
     Lattice(Lattice&) = delete;
 
-    //Lattice(int order, int axisSize);
-    static void InitLattice(int _order, int _axisSize, int _boundarySize = 5);
+    // Axis sizes don't include the boundary padding, which is added to both ends of every axis
+    static void InitLattice(const std::valarray<int>& _axisSizes, int _boundarySize = 5);
+
+    // Reinitialize the lattice with new axis sizes, moving every module and boundary by shift
+    static void Resize(const std::valarray<int>& _axisSizes, const std::valarray<int>& shift);
 
     static void SetFlags(bool _ignoreColors);
 
@@ -86,6 +108,12 @@ public:
 
     static bool CheckConnected(int permitMissing = 0);
 
+    // Check if any non-static module is near the edge of the lattice
+    static bool NearEdge();
+
+    // Clear adjacency list for module ID, and remove module ID from other lists
+    static void ClearAdjacencies(int moduleId);
+
     // General Adjacency Check + Adjacency index helper function
     static std::vector<int> adjIndices;
     static void EdgeCheck(const Module& mod);
@@ -111,15 +139,23 @@ public:
     // Get movable modules
     static const std::vector<Module*>& MovableModules();
 
-    // Update lattice using a vector of non-static module information
-    static void UpdateFromModuleInfo(const std::set<ModuleData>& moduleInfo);
+    // Update lattice using a vector of non-static module information, returns how many modules were relocated
+    static int UpdateFromModuleInfo(const std::set<ModuleData>& moduleInfo);
 
     // Get non-static module information
     static std::set<ModuleData> GetModuleInfo();
 
     static int Order();
 
-    static int AxisSize();
+    static int AxisSize(int axis);
+
+    static const std::valarray<int>& AxisSizes();
+
+    // Get lattice revision, if it hasn't changed then neither has the lattice
+    static std::size_t Revision();
+
+    // Get lattice generation, if it hasn't changed then coordinates still refer to the same cells
+    static std::size_t Generation();
 
     static std::string ToString();
 
@@ -1,5 +1,7 @@
 #include "LatticeSetup.h"
 #include <set>
+#include <algorithm>
+#include <limits>
 #include <vector>
 #include <fstream>
 #include <iostream>
@@ -32,62 +34,51 @@ void LatticeSetup::Preprocess(const std::string& filename_s, const std::string&
     file_t.close();
 }
 
+namespace {
+    // Bounding boxes of the static modules and of every module in a configuration
+    struct ConfigBounds {
+        bool hasStatic = false;
+        std::valarray<int> staticMin;
+        std::valarray<int> min;
+        std::valarray<int> max;
+        int nonStaticCount = 0;
+    };
+
+    ConfigBounds FindBounds(const nlohmann::json& j, const int order) {
+        ConfigBounds bounds;
+        bounds.min.resize(order, std::numeric_limits<int>::max());
+        bounds.max.resize(order, std::numeric_limits<int>::min());
+        bounds.staticMin.resize(order, std::numeric_limits<int>::max());
+        for (const auto& module : j["modules"]) {
+            std::vector<int> position = module["position"];
+            for (int i = 0; i < order; i++) {
+                bounds.min[i] = std::min(bounds.min[i], position[i]);
+                bounds.max[i] = std::max(bounds.max[i], position[i]);
+            }
+            if (module["static"]) {
+                bounds.hasStatic = true;
+                for (int i = 0; i < order; i++) {
+                    bounds.staticMin[i] = std::min(bounds.staticMin[i], position[i]);
+                }
+            } else {
+                bounds.nonStaticCount++;
+            }
+        }
+        return bounds;
+    }
+}
+
 void LatticeSetup::Preprocess(std::istream& is_s, std::istream& is_t) {
+    preInitData = {};
     // Preprocess initial state
     nlohmann::json j_s;
     is_s >> j_s;
     int order = j_s["order"];
-    std::vector<int> minStaticCoords(order);
-    std::vector<int> maxStaticCoords(order);
-    std::vector<int> minNonStaticCoords(order);
-    std::vector<int> maxNonStaticCoords(order);
-    bool staticCoordsInitialized = false;
-    bool nonStaticCoordsInitialized = false;
     DEBUG("Preprocessing initial state..." << std::endl);
-    for (const auto& module : j_s["modules"]) {
-        std::vector<int> position = module["position"];
-        if (module["static"]) {
-            if (!staticCoordsInitialized) {
-                minStaticCoords = position;
-                maxStaticCoords = position;
-                staticCoordsInitialized = true;
-            } else for (int i = 0; i < order; i++) {
-                if (position[i] < minStaticCoords[i]) {
-                    minStaticCoords[i] = position[i];
-                } else if (position[i] > maxStaticCoords[i]) {
-                    maxStaticCoords[i] = position[i];
-                }
-            }
-        } else {
-            if (!nonStaticCoordsInitialized) {
-                minNonStaticCoords = position;
-                maxNonStaticCoords = position;
-                nonStaticCoordsInitialized = true;
-            } else for (int i = 0; i < order; i++) {
-                if (position[i] < minNonStaticCoords[i]) {
-                    minNonStaticCoords[i] = position[i];
-                } else if (position[i] > maxNonStaticCoords[i]) {
-                    maxNonStaticCoords[i] = position[i];
-                }
-            }
-            preInitData.nonStaticCount++;
-        }
-    }
-    if (!staticCoordsInitialized) {
-        preInitData.fullNonStatic = true;
-    } else {
-        preInitData.fullNonStatic = false;
-        int staticSize = 0;
-        for (int i = 0; i < order; i++) {
-            if (const int staticAxisSize = maxStaticCoords[i] - minStaticCoords[i]; staticAxisSize > staticSize) {
-                staticSize = staticAxisSize;
-            }
-        }
-        preInitData.staticConfigSize = staticSize + 1;
-        std::ranges::transform(minStaticCoords, minStaticCoords.begin(), [](const int coord) { return -coord; });
-        const std::valarray<int> zero_offset(minStaticCoords.data(), minStaticCoords.size());
-        preInitData.staticZeroOffset_s = zero_offset;
-    }
+    const auto bounds_s = FindBounds(j_s, order);
+    preInitData.nonStaticCount = bounds_s.nonStaticCount;
+    preInitData.fullNonStatic = !bounds_s.hasStatic;
+    preInitData.staticZeroOffset_s = preInitData.fullNonStatic ? std::valarray<int>(0, order) : -bounds_s.staticMin;
     if (j_s.contains("adjacencyOffsets")) {
         int maxConnectDist = 0;
         for (const auto& offset : j_s["adjacencyOffsets"]) {
@@ -104,48 +95,23 @@ void LatticeSetup::Preprocess(std::istream& is_s, std::istream& is_t) {
     // Preprocess final state
     nlohmann::json j_t;
     is_t >> j_t;
-    staticCoordsInitialized = false;
     DEBUG("Preprocessing final state..." << std::endl);
-    for (const auto& module : j_t["modules"]) {
-        std::vector<int> position = module["position"];
-        if (module["static"]) {
-            if (!staticCoordsInitialized) {
-                minStaticCoords = position;
-                maxStaticCoords = position;
-                staticCoordsInitialized = true;
-            } else for (int i = 0; i < order; i++) {
-                if (position[i] < minStaticCoords[i]) {
-                    minStaticCoords[i] = position[i];
-                } else if (position[i] > maxStaticCoords[i]) {
-                    maxStaticCoords[i] = position[i];
-                }
-            }
-        } else for (int i = 0; i < order; i++) {
-            if (position[i] < minNonStaticCoords[i]) {
-                minNonStaticCoords[i] = position[i];
-            } else if (position[i] > maxNonStaticCoords[i]) {
-                maxNonStaticCoords[i] = position[i];
-            }
-        }
-    }
-    if (!preInitData.fullNonStatic) {
-        if (!staticCoordsInitialized) {
-            // No static modules given in final state, have to assume offset is same
-            preInitData.staticZeroOffset_t = preInitData.staticZeroOffset_s;
-        } else {
-            std::ranges::transform(minStaticCoords, minStaticCoords.begin(),
-                                   [](const int coord) { return -coord; });
-            const std::valarray<int> zero_offset(minStaticCoords.data(), minStaticCoords.size());
-            preInitData.staticZeroOffset_t = zero_offset;
-        }
+    const auto bounds_t = FindBounds(j_t, order);
+    if (preInitData.fullNonStatic || !bounds_t.hasStatic) {
+        // No static modules given in final state, have to assume offset is same
+        preInitData.staticZeroOffset_t = preInitData.staticZeroOffset_s;
+    } else {
+        preInitData.staticZeroOffset_t = -bounds_t.staticMin;
     }
-    int nonStaticSize = 0;
+    // Combine bounding boxes, with both states lined up by their static modules
+    preInitData.configMin = bounds_s.min + preInitData.staticZeroOffset_s;
+    preInitData.configMax = bounds_s.max + preInitData.staticZeroOffset_s;
     for (int i = 0; i < order; i++) {
-        if (const int nonStaticAxisSize = maxNonStaticCoords[i] - minNonStaticCoords[i]; nonStaticAxisSize > nonStaticSize) {
-            nonStaticSize = nonStaticAxisSize;
-        }
+        preInitData.configMin[i] = std::min(preInitData.configMin[i], bounds_t.min[i] + preInitData.staticZeroOffset_t[i]);
+        preInitData.configMax[i] = std::max(preInitData.configMax[i], bounds_t.max[i] + preInitData.staticZeroOffset_t[i]);
     }
-    preInitData.nonStaticConfigSize = nonStaticSize + 1;
+    // Connected non-static modules can't spread further than a line of all of them
+    preInitData.maxReach = preInitData.maxConnectionDistance * preInitData.nonStaticCount;
     DEBUG("Preprocessing complete." << std::endl);
 }
 
@@ -166,19 +132,15 @@ void LatticeSetup::SetupFromJson(std::istream& is) {
     nlohmann::json j;
     is >> j;
     std::cout << "\tCreating Lattice...   ";
-    const int paddingSize = MoveManager::MaxDistance();
-    if (preInitData.fullNonStatic) {
-        if (j.contains("tensorPadding")) {
-            Lattice::InitLattice(j["order"], preInitData.nonStaticConfigSize + 2 * preInitData.maxConnectionDistance * preInitData.nonStaticCount, std::max(static_cast<int>(j["tensorPadding"]), paddingSize));
-        } else {
-            Lattice::InitLattice(j["order"], preInitData.nonStaticConfigSize + 2 * preInitData.maxConnectionDistance * preInitData.nonStaticCount, paddingSize);
-        }
-        preInitData.fullOffset = Lattice::boundaryOffset + preInitData.maxConnectionDistance * preInitData.nonStaticCount;
-    } else {
-        const int axisSize = preInitData.staticConfigSize + 2 * preInitData.maxConnectionDistance * preInitData.nonStaticCount;
-        Lattice::InitLattice(j["order"], axisSize, paddingSize);
-        preInitData.fullOffset = Lattice::boundaryOffset + preInitData.staticZeroOffset_s + preInitData.maxConnectionDistance * preInitData.nonStaticCount;
-    };
+    int paddingSize = MoveManager::MaxDistance();
+    if (j.contains("tensorPadding")) {
+        paddingSize = std::max(static_cast<int>(j["tensorPadding"]), paddingSize);
+    }
+    // Start with room for a few moves past the bounding box, searches grow the lattice if modules need more
+    preInitData.reach = std::min(LATTICESETUP_INITIAL_REACH * MoveManager::MaxDistance(), preInitData.maxReach);
+    Lattice::InitLattice(preInitData.configMax - preInitData.configMin + 1 + 2 * preInitData.reach, paddingSize);
+    Lattice::edgeDistance = preInitData.reach < preInitData.maxReach ? MoveManager::MaxDistance() : 0;
+    preInitData.fullOffset = Lattice::boundaryOffset + preInitData.reach - preInitData.configMin + preInitData.staticZeroOffset_s;
     std::cout << "Done." << std::endl << "\tConfiguring Adjacency Checks...   ";
     if (adjCheckOverride == NONE) {
         if (j.contains("adjacencyMode")) {
@@ -220,7 +182,7 @@ void LatticeSetup::SetupFromJson(std::istream& is) {
         std::valarray<int> coords(position.data(), position.size());
         coords += preInitData.fullOffset;
 #if FLIP_Y_COORD
-        coords[1] = Lattice::AxisSize() - coords[1] - 1;
+        coords[1] = Lattice::AxisSize(1) - coords[1] - 1;
 #endif
         if (!Lattice::ignoreProperties && module.contains("properties")) {
             ModuleIdManager::RegisterModule(coords, module["static"], module["properties"]);
@@ -255,7 +217,7 @@ void LatticeSetup::SetupFromJson(std::istream& is) {
             std::valarray<int> coords = bound;
             coords += preInitData.fullOffset;
 #if FLIP_Y_COORD
-            coords[1] = Lattice::AxisSize() - coords[1] - 1;
+            coords[1] = Lattice::AxisSize(1) - coords[1] - 1;
 #endif
             if (Lattice::coordTensor[coords] < 0) {
                 Lattice::AddBound(coords);
@@ -282,16 +244,14 @@ Configuration LatticeSetup::SetupFinalFromJson(std::istream& is) {
     nlohmann::json j;
     is >> j;
     std::set<ModuleData> desiredState;
-    std::valarray<int> placementOffset = preInitData.fullNonStatic
-                                             ? preInitData.fullOffset
-                                             : Lattice::boundaryOffset + preInitData.staticZeroOffset_t + preInitData.maxConnectionDistance * preInitData.nonStaticCount;
+    std::valarray<int> placementOffset = preInitData.fullOffset - preInitData.staticZeroOffset_s + preInitData.staticZeroOffset_t;
     for (const auto& module : j["modules"]) {
         if (module["static"] == true) continue;
         std::vector<int> position = module["position"];
         std::valarray<int> coords(position.data(), position.size());
         coords += placementOffset;
 #if FLIP_Y_COORD
-        coords[1] = Lattice::AxisSize() - coords[1] - 1;
+        coords[1] = Lattice::AxisSize(1) - coords[1] - 1;
 #endif
         ModuleProperties props;
         if (!Lattice::ignoreProperties && module.contains("properties")) {
@@ -300,4 +260,17 @@ Configuration LatticeSetup::SetupFinalFromJson(std::istream& is) {
         desiredState.insert({coords, props});
     }
     return Configuration(desiredState);
-}
\ No newline at end of file
+}
+
+int LatticeSetup::GrowLattice(int reach) {
+    reach = std::min(reach, preInitData.maxReach);
+    if (reach <= preInitData.reach) {
+        return 0;
+    }
+    const int shift = reach - preInitData.reach;
+    preInitData.reach = reach;
+    preInitData.fullOffset += shift;
+    Lattice::Resize(preInitData.configMax - preInitData.configMin + 1 + 2 * reach, std::valarray<int>(shift, Lattice::Order()));
+    Lattice::edgeDistance = reach < preInitData.maxReach ? MoveManager::MaxDistance() : 0;
+    return shift;
+}
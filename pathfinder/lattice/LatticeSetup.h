@@ -5,6 +5,15 @@
 #include "../search/ConfigurationSpace.h"
 #include <nlohmann/json.hpp>
 
+/* Lattice Reach Configuration
+ * How far the lattice initially extends past the initial and final configurations, in multiples of the longest move.
+ * Searches grow the lattice whenever a module gets within one move of its edge, up to the furthest that modules could
+ * ever spread out from the configurations.
+ */
+#ifndef LATTICESETUP_INITIAL_REACH
+#define LATTICESETUP_INITIAL_REACH 2
+#endif
+
 enum AdjOverride {
     NONE,
     CUBE,
@@ -15,10 +24,14 @@ struct ConfigPreprocessData {
     bool fullNonStatic;
     std::valarray<int> staticZeroOffset_s;
     std::valarray<int> staticZeroOffset_t;
-    int staticConfigSize = 0;
-    int nonStaticConfigSize = 0;
+    // Bounding box of every module in both states, with the static modules of both states lined up
+    std::valarray<int> configMin;
+    std::valarray<int> configMax;
     int nonStaticCount = 0;
     int maxConnectionDistance;
+    // How far the lattice currently extends past the bounding box, and how far it could ever need to
+    int reach = 0;
+    int maxReach = 0;
     std::valarray<int> fullOffset;
 };
 
@@ -38,6 +51,10 @@ namespace LatticeSetup {
     Configuration SetupFinalFromJson(const std::string& filename);
 
     Configuration SetupFinalFromJson(std::istream& is);
+
+    // Grow the lattice to extend the given reach past the bounding box (limited to the max reach), moving every
+    // module and boundary to stay centered, returns how far everything was moved
+    int GrowLattice(int reach);
 }
 
 #endif
\ No newline at end of file
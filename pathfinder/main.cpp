@@ -1,6 +1,8 @@
 #include <chrono>
 #include <iostream>
 #include <getopt.h>
+#include <memory>
+#include <random>
 #include <string>
 #include "moves/MoveManager.h"
 #include "search/ConfigurationSpace.h"
@@ -10,6 +12,8 @@
 #include "moves/Scenario.h"
 #include "search/SearchAnalysis.h"
 #include "search/HeuristicCache.h"
+#include "search/MemoryTracker.h"
+#include "search/Profiler.h"
 
 #ifndef GENERATE_FINAL_STATE
 #define GENERATE_FINAL_STATE false
@@ -21,6 +25,14 @@
 
 int main(int argc, char* argv[]) {
     bool ignoreColors = false;
+    bool lazyNodes = false;
+    bool profile = false;
+    bool calibrate = false;
+    int recordInterval = -1;
+    double memoryBudget = 0;
+    int generateMoves = GENERATE_FINAL_STATE ? 8 : 0;
+    long long generateSeed = -1;
+    std::string timeSeriesFile;
     std::string initialFile;
     std::string finalFile;
     std::string exportFile;
@@ -29,6 +41,7 @@ int main(int argc, char* argv[]) {
     std::string searchMethod;
     std::string heuristic;
     std::string edgeCheck;
+    std::string convertFile;
 
     // Define the long options
     static option long_options[] = {
@@ -41,12 +54,21 @@ int main(int argc, char* argv[]) {
         {"search-method", required_argument, nullptr, 's'},
         {"heuristic", required_argument, nullptr, 'h'},
         {"edge-check", required_argument, nullptr, 'c'},
+        {"lazy-nodes", no_argument, nullptr, 'l'},
+        {"convert-scenb", required_argument, nullptr, 'b'},
+        {"profile", no_argument, nullptr, 'p'},
+        {"record-interval", required_argument, nullptr, 'r'},
+        {"time-series", required_argument, nullptr, 't'},
+        {"memory-budget", required_argument, nullptr, 'M'},
+        {"generate-final", required_argument, nullptr, 'g'},
+        {"seed", required_argument, nullptr, 'S'},
+        {"calibrate", no_argument, nullptr, 'C'},
         {nullptr, 0, nullptr, 0}
     };
 
     int option_index = 0;
     int c;
-    while ((c = getopt_long(argc, argv, "iI:F:e:a:m:s:h:c:", long_options, &option_index)) != -1) {
+    while ((c = getopt_long(argc, argv, "iI:F:e:a:m:s:h:c:lb:pr:t:M:g:S:C", long_options, &option_index)) != -1) {
         switch (c) {
             case 'i':
                 ignoreColors = true;
@@ -75,6 +97,33 @@ int main(int argc, char* argv[]) {
             case 'c':
                 edgeCheck = optarg;
                 break;
+            case 'l':
+                lazyNodes = true;
+                break;
+            case 'b':
+                convertFile = optarg;
+                break;
+            case 'p':
+                profile = true;
+                break;
+            case 'r':
+                recordInterval = std::stoi(optarg);
+                break;
+            case 't':
+                timeSeriesFile = optarg;
+                break;
+            case 'M':
+                memoryBudget = std::stod(optarg);
+                break;
+            case 'g':
+                generateMoves = std::stoi(optarg);
+                break;
+            case 'S':
+                generateSeed = std::stoll(optarg);
+                break;
+            case 'C':
+                calibrate = true;
+                break;
             case '?':
                 break;
             default:
@@ -82,6 +131,26 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    // Time the calibration workload and exit if requested, used to normalize performance test results
+    if (calibrate) {
+        std::cout << "Calibration completed in " << Profiler::Calibrate() << " us." << std::endl;
+        return 0;
+    }
+
+    // Convert a binary scenario file to text and exit if requested
+    if (!convertFile.empty()) {
+        if (exportFile.empty() || std::filesystem::path(exportFile).extension() == ".scenb") {
+            exportFile = std::filesystem::path(convertFile).replace_extension(".scen").string();
+        }
+        try {
+            Scenario::ConvertScenbToScen(convertFile, exportFile);
+        } catch (std::ios_base::failure& failure) {
+            std::cerr << failure.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
     // Prompt user for names for initial and final state files if they are not given as command line arguments
     if (initialFile.empty()) {
         std::cout << "Path to initial state:" << std::endl;
@@ -102,8 +171,13 @@ int main(int argc, char* argv[]) {
         }
     }
     std::size_t trimPos;
-#if !GENERATE_FINAL_STATE
-    if (finalFile.empty()) {
+    const bool generateFinal = generateMoves > 0;
+    if (generateFinal) {
+        // Pick a seed now so that it can be reported
+        if (generateSeed < 0) {
+            generateSeed = std::random_device{}();
+        }
+    } else if (finalFile.empty()) {
         if ((trimPos = initialFile.find("_initial")) != std::string::npos) {
             finalFile = initialFile;
             finalFile.erase(trimPos, 8);
@@ -111,7 +185,7 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    if (finalFile.empty() || !std::filesystem::exists(finalFile)) {
+    if (!generateFinal && (finalFile.empty() || !std::filesystem::exists(finalFile))) {
         std::cout << "Path to final state:" << std::endl;
         int numTries = 0;
         bool invalidPath = true;
@@ -129,7 +203,6 @@ int main(int argc, char* argv[]) {
             }
         }
     }
-#endif
 
     // Generate names for export and analysis files if they are not specified
     if (exportFile.empty()) {
@@ -164,8 +237,8 @@ int main(int argc, char* argv[]) {
         MoveManager::PreprocessMoves(movesFolder);
     }
 
-    // Preprocess configurations
-    LatticeSetup::Preprocess(initialFile, finalFile);
+    // Preprocess configurations, a generated final state fits in the lattice sized for the initial state
+    LatticeSetup::Preprocess(initialFile, generateFinal ? initialFile : finalFile);
 
     // Set up Lattice
     std::cout << "Initializing Lattice..." << std::endl;
@@ -196,14 +269,15 @@ int main(int argc, char* argv[]) {
     
     // Set up moves
     std::cout << "Initializing Move Manager..." << std::endl;
-    MoveManager::InitMoveManager(Lattice::Order(), Lattice::AxisSize());
+    MoveManager::InitMoveManager(Lattice::Order(), MoveManager::MaxDistance() + 1);
     std::cout << "Move Manager initialized." << std::endl << "Loading Moves..." << std::endl;
     if(movesFolder.empty()) {
         MoveManager::RegisterAllMoves();
     } else {
         MoveManager::RegisterAllMoves(movesFolder);
     }
-    std::cout << "Moves loaded." << std::endl;
+    std::cout << "Moves loaded, " << MoveManager::Moves().size() << " moves with set hash " << MoveManager::MoveSetHash()
+              << '.' << std::endl;
 
     // Print some useful information
     std::cout << std::endl << "Module Representation: ";
@@ -215,11 +289,11 @@ int main(int argc, char* argv[]) {
     std::cout << "INVALID" << std::endl;
 #endif
     std::cout << "Final State Generator: ";
-#if GENERATE_FINAL_STATE
-    std::cout << "ENABLED" << std::endl;
-#else
-    std::cout << "DISABLED" << std::endl;
-#endif
+    if (generateFinal) {
+        std::cout << "ENABLED (" << generateMoves << " moves, seed " << generateSeed << ")" << std::endl;
+    } else {
+        std::cout << "DISABLED" << std::endl;
+    }
     std::cout << "Edge Check Mode:       ";
 #if LATTICE_OLD_EDGECHECK
 #if LATTICE_RD_EDGECHECK
@@ -274,43 +348,85 @@ int main(int argc, char* argv[]) {
     } else if (searchMethod == "BDBFS" || searchMethod == "bdbfs") {
         std::cout << "BDBFS" << std::endl;
     }
+    ConfigurationSpace::lazyNodes = lazyNodes;
+    std::cout << "Node Storage:          " << (lazyNodes ? "LAZY" : "FULL") << std::endl;
+    // Set up search analysis recording
+    if (CONFIG_OUTPUT_JSON || recordInterval >= 0 || !timeSeriesFile.empty()) {
+        SearchAnalysis::Enable(true);
+        if (recordInterval >= 0) {
+            SearchAnalysis::SetSampleInterval(std::chrono::milliseconds(recordInterval));
+        }
+        if (!timeSeriesFile.empty()) {
+            SearchAnalysis::StreamTo(timeSeriesFile);
+        }
+    }
+    std::cout << "Search Analysis:       " << (SearchAnalysis::Enabled() ? "ENABLED" : "DISABLED") << std::endl;
+    std::cout << "Profiler:              ";
+#if CONFIG_PROFILER
+    std::cout << (profile ? "ENABLED" : "DISABLED") << std::endl;
+#else
+    std::cout << "NOT COMPILED" << std::endl;
+#endif
+    // Set up memory budget, given in MiB
+    MemoryTracker::SetBudget(static_cast<std::size_t>(memoryBudget * 1024 * 1024));
+    std::cout << "Memory Budget:         ";
+    if (memoryBudget > 0) {
+        std::cout << memoryBudget << " MiB" << std::endl;
+    } else {
+        std::cout << "NONE" << std::endl;
+    }
     std::cout << std::endl;
 
     // Pathfinding
-    Configuration start(Lattice::GetModuleInfo());
-    BDConfiguration bidirectionalStart(start.GetModData(), START);
-#if GENERATE_FINAL_STATE
-    Configuration end = ConfigurationSpace::GenerateRandomFinal();
-#else
-    Configuration end = LatticeSetup::SetupFinalFromJson(finalFile);
-#endif
-    BDConfiguration bidirectionalEnd(end.GetModData(), END);
-    std::vector<const Configuration*> path;
+    if (generateFinal) {
+        // Make room for the generated moves up front, so that generating the final state never reaches the edge
+        LatticeSetup::GrowLattice(LatticeSetup::preInitData.reach + generateMoves * MoveManager::MaxDistance());
+    }
+    std::set<ModuleData> startData = Lattice::GetModuleInfo();
+    std::set<ModuleData> endData = (generateFinal
+                                    ? ConfigurationSpace::GenerateRandomFinal(generateMoves, static_cast<std::uint_fast32_t>(generateSeed))
+                                    : LatticeSetup::SetupFinalFromJson(finalFile)).GetModData();
+    SearchResult result;
     try {
         std::cout << "Beginning search..." << std::endl;
-        const auto timeBegin = std::chrono::high_resolution_clock::now();
-        if (searchMethod.empty() || searchMethod == "A*" || searchMethod == "a*") {
-            path = ConfigurationSpace::AStar(&start, &end, heuristic);
-        } else if (searchMethod == "BDA*" || searchMethod == "bda*") {
-            path = ConfigurationSpace::BDAStar(&bidirectionalStart, &bidirectionalEnd, heuristic);
-        } else if (searchMethod == "BDBFS" || searchMethod == "bdbfs") {
-            path = ConfigurationSpace::BiDirectionalBFS(&bidirectionalStart, &bidirectionalEnd);
-        } else if (searchMethod == "BFS" || searchMethod == "bfs") {
-            path = ConfigurationSpace::BFS(&start, &end);
-        }
-        const auto timeEnd = std::chrono::high_resolution_clock::now();
-        const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(timeEnd - timeBegin);
-        std::cout << "Search completed in " << duration.count() << " ms." << std::endl;
-#if CONFIG_OUTPUT_JSON
-        SearchAnalysis::ExportData(analysisFile);
-#endif
+        Profiler::Enable(profile);
+        result = ConfigurationSpace::Search(std::move(startData), std::move(endData), searchMethod, heuristic);
+        Profiler::Enable(false);
+        std::cout << "Search completed in " << result.duration.count() << " ms after " << result.restarts
+                  << " restart(s)." << std::endl;
+        SearchAnalysis::InsertData("Restarts", result.restarts);
     } catch(SearchExcept& searchExcept) {
+        Profiler::Enable(false);
         std::cerr << searchExcept.what() << std::endl;
+    } catch(MemoryBudgetExcept& memoryBudgetExcept) {
+        Profiler::Enable(false);
+        std::cerr << memoryBudgetExcept.what() << std::endl;
+    }
+    if (profile) {
+        Profiler::Print(std::cout);
+        SearchAnalysis::InsertData("Profile", Profiler::ToJson());
+        const auto& switches = Configuration::SwitchStats();
+        std::cout << "Lattice switches: " << switches.moveSwitches << " by moves (" << switches.moveCellUpdates
+                  << " cell updates), " << switches.rebuilds << " by rebuilding (" << switches.rebuildCellUpdates
+                  << " cell updates)" << std::endl;
+        SearchAnalysis::InsertData("LatticeSwitches", {
+            {"MoveSwitches", switches.moveSwitches},
+            {"MoveCellUpdates", switches.moveCellUpdates},
+            {"Rebuilds", switches.rebuilds},
+            {"RebuildCellUpdates", switches.rebuildCellUpdates}
+        });
+    }
+    if (memoryBudget > 0 || profile) {
+        MemoryTracker::Print(std::cout);
+    }
+    SearchAnalysis::InsertData("Memory", MemoryTracker::ToJson());
+    if ((SearchAnalysis::Enabled() || profile) && !analysisFile.empty()) {
+        SearchAnalysis::ExportData(analysisFile);
     }
 
 #if PRINT_PATH
     std::cout << "Path:\n";
-    for (const auto config : path) {
+    for (const auto config : result.path) {
         Lattice::UpdateFromModuleInfo(config->GetModData());
         std::cout << Lattice::ToString();
     }
@@ -323,7 +439,7 @@ int main(int argc, char* argv[]) {
     scenInfo.scenDesc = Scenario::TryGetScenDesc(initialFile);
     scenInfo.scenType = Scenario::TryGetScenType(initialFile);
     
-    Scenario::ExportToScenFile(path, scenInfo);
+    Scenario::ExportToScenFile(result.path, scenInfo);
     std::cout << "Results exported." << std::endl << "Cleaning Modules..." << std::endl;
     ModuleIdManager::CleanupModules();
     std::cout << "Modules cleaned." << std::endl << "Cleaning Moves..." << std::endl;
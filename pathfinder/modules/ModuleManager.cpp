@@ -1,6 +1,7 @@
 #include <set>
 #include "../lattice/Lattice.h"
 #include "../utility/debug_util.h"
+#include "../search/MemoryTracker.h"
 #include "ModuleManager.h"
 
 
@@ -78,12 +79,28 @@ bool ModuleInt64::operator<(const IModuleBasic& right) const {
     return modInt < r.modInt;
 }
 
+namespace {
+    // Links and color of the red-black tree node a std::set keeps each module data object in
+    constexpr std::size_t SET_NODE_OVERHEAD = 4 * sizeof(void*);
+}
+
+std::size_t ModuleData::EstimatedBytes() {
+#if CONFIG_MOD_DATA_STORAGE == MM_DATA_FULL
+    return SET_NODE_OVERHEAD + sizeof(ModuleData) + sizeof(ModuleBasic) + Lattice::Order() * sizeof(int);
+#else
+    return SET_NODE_OVERHEAD + sizeof(ModuleData) + sizeof(ModuleInt64);
+#endif
+}
+
 ModuleData::ModuleData(const ModuleData& modData) {
 #if CONFIG_MOD_DATA_STORAGE == MM_DATA_FULL
     module = std::make_unique<ModuleBasic>(modData.Coords(), modData.Properties());
 #else
     module = std::make_unique<ModuleInt64>(modData.Coords(), modData.Properties());
 #endif
+#if CONFIG_TRACK_MODULE_DATA
+    MemoryTracker::Allocate(MEM_MODULE_DATA, EstimatedBytes());
+#endif
 }
 
 
@@ -93,6 +110,15 @@ ModuleData::ModuleData(const std::valarray<int>& coords, const ModuleProperties&
 #else
     module = std::make_unique<ModuleInt64>(coords, properties);
 #endif
+#if CONFIG_TRACK_MODULE_DATA
+    MemoryTracker::Allocate(MEM_MODULE_DATA, EstimatedBytes());
+#endif
+}
+
+ModuleData::~ModuleData() {
+#if CONFIG_TRACK_MODULE_DATA
+    MemoryTracker::Deallocate(MEM_MODULE_DATA, EstimatedBytes());
+#endif
 }
 
 const std::valarray<int>& ModuleData::Coords() const {
@@ -128,7 +154,7 @@ ModuleData& ModuleData::operator=(const ModuleData& modData) {
 
 std::size_t std::hash<ModuleData>::operator()(const ModuleData& modData) const noexcept {
 #if CONFIG_MOD_DATA_STORAGE == MM_DATA_FULL
-    auto m = reinterpret_cast<const ModuleBasic&>(*modData.module);
+    auto& m = const_cast<ModuleBasic&>(reinterpret_cast<const ModuleBasic&>(*modData.module));
     constexpr std::hash<ModuleBasic> hasher;
     return hasher(m);
 #else
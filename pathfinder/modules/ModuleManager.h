@@ -22,6 +22,14 @@
 #ifndef CONFIG_MOD_DATA_STORAGE
 #define CONFIG_MOD_DATA_STORAGE MM_DATA_FULL
 #endif
+/* Module Data Memory Tracking Configuration
+ * Enabling this reports every module data object to the memory tracker, including the node of the set holding it.
+ * This is done on a hot path and isn't thread-safe, so it's only enabled by the TRACK_MODULE_DATA CMake option.
+ * Otherwise search states charge an estimate for the module data they hold whenever it is built or dropped.
+ */
+#ifndef CONFIG_TRACK_MODULE_DATA
+#define CONFIG_TRACK_MODULE_DATA false
+#endif
 
 
 
@@ -50,6 +58,8 @@ public:
 
     ModuleData(const std::valarray<int>& coords, const ModuleProperties& properties);
 
+    ~ModuleData() override;
+
     [[nodiscard]]
     const std::valarray<int>& Coords() const override;
 
@@ -64,6 +74,11 @@ public:
 
     ModuleData& operator=(const ModuleData& modData);
 
+    // Estimated size of one module data object in a std::set, property internals owned by property libraries aren't
+    // counted
+    [[nodiscard]]
+    static std::size_t EstimatedBytes();
+
     friend class std::hash<ModuleData>;
 };
 
@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <set>
 #include "ModuleProperties.h"
@@ -73,66 +78,352 @@ std::unordered_map<std::string, boost::shared_ptr<boost::any (*)(IModuleProperty
 
 int ModuleProperties::_propertiesLinkedCount = 0;
 
-ModuleProperties::ModuleProperties(const ModuleProperties& other) {
-    _properties.clear();
-    for (const auto& property : other._properties) {
-        _properties.insert(property->MakeCopy());
+std::vector<InternedProperty>& ModuleProperties::Values() {
+    static std::vector<InternedProperty> _values;
+    return _values;
+}
+
+std::unordered_multimap<std::size_t, int>& ModuleProperties::ValueIds() {
+    static std::unordered_multimap<std::size_t, int> _valueIds;
+    return _valueIds;
+}
+
+std::vector<InternedPropertySet>& ModuleProperties::Sets() {
+    static std::vector<InternedPropertySet> _sets = {{{}, 0}};
+    return _sets;
+}
+
+std::map<std::vector<int>, int>& ModuleProperties::SetIds() {
+    static std::map<std::vector<int>, int> _setIds = {{{}, 0}};
+    return _setIds;
+}
+
+std::vector<PropertyFunctionDef>& ModuleProperties::Checks() {
+    static std::vector<PropertyFunctionDef> _checks;
+    return _checks;
+}
+
+std::vector<std::vector<std::int8_t>>& ModuleProperties::CheckResults() {
+    static std::vector<std::vector<std::int8_t>> _checkResults;
+    return _checkResults;
+}
+
+std::vector<PropertyFunctionDef>& ModuleProperties::Updates() {
+    static std::vector<PropertyFunctionDef> _updates;
+    return _updates;
+}
+
+std::vector<std::vector<int>>& ModuleProperties::Transitions() {
+    static std::vector<std::vector<int>> _transitions;
+    return _transitions;
+}
+
+namespace {
+    // Imported function, or null if none was imported
+    template<typename Func>
+    Func FunctionOrNull(const boost::shared_ptr<Func>& function) {
+        return function ? *function : nullptr;
     }
-    _dynamicProperties.clear();
-    if (other._dynamicProperties.empty()) {
-        return;
+
+    // Whether two definitions of the same function type call the same function, only the member for that type is set
+    bool SameFunction(const PropertyFunctionDef& left, const PropertyFunctionDef& right) {
+        switch (left.functionType) {
+            case STATIC_NOARGS:
+                return FunctionOrNull(left.function.staticFunction) == FunctionOrNull(right.function.staticFunction);
+            case INSTANCE_NOARGS:
+                return FunctionOrNull(left.function.instanceFunction) == FunctionOrNull(right.function.instanceFunction);
+            case STATIC_ARGS:
+                return FunctionOrNull(left.function.argStaticFunction) == FunctionOrNull(right.function.argStaticFunction);
+            case INSTANCE_ARGS:
+                return FunctionOrNull(left.function.argInstanceFunction) == FunctionOrNull(right.function.argInstanceFunction);
+        }
+        return false;
+    }
+
+    // Get index of an equal function definition, adding it if there isn't one
+    int FindOrAddFunctionDef(std::vector<PropertyFunctionDef>& defs, const PropertyFunctionDef& def) {
+        for (int i = 0; i < defs.size(); i++) {
+            if (defs[i].key == def.key && defs[i].functionType == def.functionType && SameFunction(defs[i], def) &&
+                defs[i].args == def.args) {
+                return i;
+            }
+        }
+        defs.push_back(def);
+        return static_cast<int>(defs.size()) - 1;
     }
-    for (const auto& dynamicProperty : other._dynamicProperties) {
-        _dynamicProperties.insert(dynamicProperty->MakeCopy());
+}
+
+int ModuleProperties::InternValue(IModuleProperty* property, const bool dynamic) {
+    const auto hash = property->GetHash();
+    auto [begin, end] = ValueIds().equal_range(hash);
+    for (auto it = begin; it != end; ++it) {
+        const auto& value = Values()[it->second];
+        if (value.dynamic == dynamic && value.property->key == property->key && value.property->CompareProperty(*property)) {
+            delete property;
+            return it->second;
+        }
     }
+    const int id = static_cast<int>(Values().size());
+    Values().push_back({property, hash, dynamic});
+    ValueIds().emplace(hash, id);
+    return id;
 }
 
-void ModuleProperties::LinkProperties() {
-    for (const auto& propertyFile : std::filesystem::directory_iterator("Module Properties/")) {
-        if (propertyFile.path().extension() != ".json") continue;
-        std::ifstream file(propertyFile.path());
-        nlohmann::json propertyClassDef = nlohmann::json::parse(file);
-        std::string propertyLibPath, propertyLibName = propertyClassDef["filename"];
-        std::string propertyName = propertyClassDef["name"];
-        std::cout << "\tSearching..." << std::endl;
-        for (const auto& libraryFile : std::filesystem::recursive_directory_iterator("Module Properties/")) {
-            std::cout << "\t\tFile: " << libraryFile.path() << std::endl << "\t\tStem: " << libraryFile.path().stem() << std::endl;
-            if (libraryFile.path().stem().string() == propertyLibName) {
-                propertyLibPath = libraryFile.path().string();
+int ModuleProperties::InternSet(std::vector<int> values) {
+    std::ranges::sort(values);
+    if (const auto it = SetIds().find(values); it != SetIds().end()) {
+        return it->second;
+    }
+    // Same hash the property set had before interning, so iteration order of hashed module containers is unchanged
+    auto cmp = [](const int a, const int b) { return a < b; };
+    std::set<std::size_t, decltype(cmp)> hashes(cmp);
+    for (const auto valueId : values) {
+        hashes.insert(Values()[valueId].hash);
+    }
+    const int id = static_cast<int>(Sets().size());
+    Sets().push_back({values, boost::hash_range(hashes.begin(), hashes.end())});
+    SetIds().emplace(std::move(values), id);
+    return id;
+}
+
+namespace {
+    constexpr auto PROPERTY_DIRECTORY = "Module Properties/";
+
+    // Kept outside of the property directory, so writing it doesn't change the stamps of the directories it records
+    constexpr auto PROPERTY_MANIFEST = "Property Cache/properties.manifest";
+
+    // Bump whenever the manifest layout changes
+    constexpr int PROPERTY_MANIFEST_VERSION = 2;
+
+    // JSON keys of property definitions listing functions, in the same order as PropertyFunctionType
+    constexpr std::array<const char*, 4> FUNCTION_LIST_KEYS = {
+        "staticFunctions", "instanceFunctions", "argumentStaticFunctions", "argumentInstanceFunctions"
+    };
+
+    // What LinkProperties needs to know about a property, cached so definitions don't need to be found and parsed
+    struct PropertyManifestEntry {
+        std::string name;
+        std::string definitionPath;
+        std::uint64_t definitionStamp;
+        std::string libraryPath;
+        std::uint64_t libraryStamp;
+        std::array<std::vector<std::string>, 4> functions;
+    };
+
+    // Hash of a file's size and modification time, used to tell if a file changed since the manifest was written
+    std::uint64_t FileStamp(const std::filesystem::path& path) {
+        std::error_code ec;
+        std::size_t stamp = 0;
+        if (!std::filesystem::is_directory(path, ec)) {
+            boost::hash_combine(stamp, std::filesystem::file_size(path, ec));
+        }
+        boost::hash_combine(stamp, std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+        return stamp;
+    }
+
+    // Read the manifest, returns false if it is missing or anything it lists has changed
+    bool ReadManifest(std::vector<PropertyManifestEntry>& entries) {
+        std::ifstream file(PROPERTY_MANIFEST);
+        if (!file) {
+            return false;
+        }
+        const auto manifest = nlohmann::json::parse(file, nullptr, false);
+        if (manifest.is_discarded() || manifest.value("version", 0) != PROPERTY_MANIFEST_VERSION) {
+            return false;
+        }
+        // Files being added to or removed from any scanned directory changes that directory's stamp
+        for (const auto& directoryDef : manifest["directories"]) {
+            if (directoryDef["stamp"] != FileStamp(directoryDef["path"].get<std::string>())) {
+                return false;
             }
         }
-        if (propertyLibPath.empty()) {
-            std::cout << "\tFailed to link " << propertyLibName << '.' << std::endl;
-            continue;
+        for (const auto& entryDef : manifest["properties"]) {
+            PropertyManifestEntry entry;
+            entry.name = entryDef["name"];
+            entry.definitionPath = entryDef["definition"];
+            entry.definitionStamp = entryDef["definitionStamp"];
+            entry.libraryPath = entryDef["library"];
+            entry.libraryStamp = entryDef["libraryStamp"];
+            // Libraries that weren't found have no stamp, adding them changes the directory stamp instead
+            if (entry.definitionStamp != FileStamp(entry.definitionPath) ||
+                !entry.libraryPath.empty() && entry.libraryStamp != FileStamp(entry.libraryPath)) {
+                entries.clear();
+                return false;
+            }
+            for (int i = 0; i < FUNCTION_LIST_KEYS.size(); i++) {
+                entry.functions[i] = entryDef[FUNCTION_LIST_KEYS[i]].get<std::vector<std::string>>();
+            }
+            entries.push_back(std::move(entry));
         }
-        std::cout << "\tLinking " << propertyLibName << "..." << std::endl;
-        if (propertyClassDef.contains("staticFunctions")) {
-            for (const auto& functionName : propertyClassDef["staticFunctions"]) {
-                auto ptrName = propertyName + "_" + static_cast<std::string>(functionName);
-                Functions()[functionName] = boost::dll::import_alias<boost::any(*)()>(propertyLibPath, ptrName);
+        return true;
+    }
+
+    // Find property definitions and their libraries in a single pass over the property directory, recording every
+    // directory that was scanned
+    void ScanProperties(std::vector<PropertyManifestEntry>& entries, std::vector<std::string>& directories) {
+        std::vector<std::filesystem::path> definitionFiles;
+        std::unordered_map<std::string, std::filesystem::path> libraryFiles;
+        const auto librarySuffix = boost::dll::shared_library::suffix().string();
+        directories.emplace_back(PROPERTY_DIRECTORY);
+        for (auto it = std::filesystem::recursive_directory_iterator(PROPERTY_DIRECTORY); it != std::filesystem::recursive_directory_iterator(); ++it) {
+            if (it->is_directory()) {
+                directories.push_back(it->path().string());
+                continue;
+            }
+            if (!it->is_regular_file()) continue;
+            const auto& path = it->path();
+            if (path.extension() == ".json") {
+                if (it.depth() == 0) {
+                    definitionFiles.push_back(path);
+                }
+            } else if (path.extension() == librarySuffix || !libraryFiles.contains(path.stem().string())) {
+                // Prefer files with the platform's library suffix over other files sharing the stem (import libs, etc.)
+                libraryFiles[path.stem().string()] = path;
             }
         }
-        if (propertyClassDef.contains("instanceFunctions")) {
-            for (const auto& functionName : propertyClassDef["instanceFunctions"]) {
-                auto ptrName = propertyName + "_" + static_cast<std::string>(functionName);
-                InstFunctions()[functionName] = boost::dll::import_alias<boost::any(*)(IModuleProperty*)>(propertyLibPath, ptrName);
+        std::ranges::sort(definitionFiles);
+        for (const auto& definitionFile : definitionFiles) {
+            std::ifstream file(definitionFile);
+            nlohmann::json propertyClassDef = nlohmann::json::parse(file);
+            PropertyManifestEntry entry;
+            entry.name = propertyClassDef["name"];
+            entry.definitionPath = definitionFile.string();
+            entry.definitionStamp = FileStamp(definitionFile);
+            entry.libraryStamp = 0;
+            if (const std::string propertyLibName = propertyClassDef["filename"]; libraryFiles.contains(propertyLibName)) {
+                entry.libraryPath = libraryFiles[propertyLibName].string();
+                entry.libraryStamp = FileStamp(entry.libraryPath);
             }
+            for (int i = 0; i < FUNCTION_LIST_KEYS.size(); i++) {
+                if (propertyClassDef.contains(FUNCTION_LIST_KEYS[i])) {
+                    entry.functions[i] = propertyClassDef[FUNCTION_LIST_KEYS[i]].get<std::vector<std::string>>();
+                }
+            }
+            entries.push_back(std::move(entry));
+        }
+    }
+
+    void WriteManifest(const std::vector<PropertyManifestEntry>& entries, const std::vector<std::string>& directories) {
+        nlohmann::json manifest;
+        manifest["version"] = PROPERTY_MANIFEST_VERSION;
+        manifest["directories"] = nlohmann::json::array();
+        for (const auto& directory : directories) {
+            manifest["directories"].push_back({{"path", directory}, {"stamp", FileStamp(directory)}});
         }
-        if (propertyClassDef.contains("argumentStaticFunctions")) {
-            for (const auto& functionName : propertyClassDef["argumentStaticFunctions"]) {
-                auto ptrName = propertyName + "_" + static_cast<std::string>(functionName);
-                ArgFunctions()[functionName] = boost::dll::import_alias<boost::any(*)(const nlohmann::basic_json<>&)>(propertyLibPath, ptrName);
+        manifest["properties"] = nlohmann::json::array();
+        for (const auto& entry : entries) {
+            nlohmann::json entryDef;
+            entryDef["name"] = entry.name;
+            entryDef["definition"] = entry.definitionPath;
+            entryDef["definitionStamp"] = entry.definitionStamp;
+            entryDef["library"] = entry.libraryPath;
+            entryDef["libraryStamp"] = entry.libraryStamp;
+            for (int i = 0; i < FUNCTION_LIST_KEYS.size(); i++) {
+                entryDef[FUNCTION_LIST_KEYS[i]] = entry.functions[i];
             }
+            manifest["properties"].push_back(entryDef);
         }
-        if (propertyClassDef.contains("argumentInstanceFunctions")) {
-            for (const auto& functionName : propertyClassDef["argumentInstanceFunctions"]) {
-                auto ptrName = propertyName + "_" + static_cast<std::string>(functionName);
-                ArgInstFunctions()[functionName] = boost::dll::import_alias<boost::any(*)(IModuleProperty*, const nlohmann::basic_json<>&)>(propertyLibPath, ptrName);
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(PROPERTY_MANIFEST).parent_path(), ec);
+        // Written under a temporary name and then renamed, so concurrent runs never see a partially written manifest
+        const auto tempPath = std::string(PROPERTY_MANIFEST) + '.' +
+            std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+        {
+            std::ofstream file(tempPath);
+            if (!(file << manifest.dump(4))) {
+                file.close();
+                std::filesystem::remove(tempPath, ec);
+                return;
             }
         }
-        std::cout << "\tLinked " << propertyLibName << '.' << std::endl;
-        _propertiesLinkedCount++;
+        std::filesystem::rename(tempPath, PROPERTY_MANIFEST, ec);
+        if (ec) {
+            std::filesystem::remove(tempPath, ec);
+        }
+    }
+
+    // Function from a loaded library, sharing ownership of the library so it stays loaded while the function is held
+    template<typename Func>
+    boost::shared_ptr<Func> ImportFunction(const boost::shared_ptr<boost::dll::shared_library>& library, const std::string& symbol) {
+        return boost::shared_ptr<Func>(library, &library->get_alias<Func>(symbol));
+    }
+}
+
+std::vector<boost::shared_ptr<boost::dll::shared_library>>& ModuleProperties::Libraries() {
+    static std::vector<boost::shared_ptr<boost::dll::shared_library>> _libraries;
+    return _libraries;
+}
+
+std::unordered_set<std::string>& ModuleProperties::BuiltinProperties() {
+    static std::unordered_set<std::string> _builtinProperties;
+    return _builtinProperties;
+}
+
+void ModuleProperties::LinkProperties() {
+    std::vector<PropertyManifestEntry> entries;
+    if (ReadManifest(entries)) {
+        std::cout << "\tUsing cached property manifest." << std::endl;
+    } else if (std::filesystem::is_directory(PROPERTY_DIRECTORY)) {
+        std::vector<std::string> directories;
+        ScanProperties(entries, directories);
+        WriteManifest(entries, directories);
+    }
+    std::unordered_set<std::string> linkedNames;
+    std::unordered_map<std::string, boost::shared_ptr<boost::dll::shared_library>> loadedLibraries;
+    for (const auto& entry : entries) {
+        if (BuiltinProperties().contains(entry.name)) {
+            continue;
+        }
+        if (entry.libraryPath.empty()) {
+            std::cout << "\tFailed to link " << entry.name << ", library not found." << std::endl;
+            continue;
+        }
+        std::cout << "\tLinking " << entry.name << "..." << std::endl;
+        auto& library = loadedLibraries[entry.libraryPath];
+        if (!library) {
+            library = boost::make_shared<boost::dll::shared_library>(entry.libraryPath);
+            Libraries().push_back(library);
+        }
+        for (const auto& functionName : entry.functions[STATIC_NOARGS]) {
+            Functions()[functionName] = ImportFunction<boost::any(*)()>(library, entry.name + "_" + functionName);
+        }
+        for (const auto& functionName : entry.functions[INSTANCE_NOARGS]) {
+            InstFunctions()[functionName] = ImportFunction<boost::any(*)(IModuleProperty*)>(library, entry.name + "_" + functionName);
+        }
+        for (const auto& functionName : entry.functions[STATIC_ARGS]) {
+            ArgFunctions()[functionName] = ImportFunction<boost::any(*)(const nlohmann::basic_json<>&)>(library, entry.name + "_" + functionName);
+        }
+        for (const auto& functionName : entry.functions[INSTANCE_ARGS]) {
+            ArgInstFunctions()[functionName] = ImportFunction<boost::any(*)(IModuleProperty*, const nlohmann::basic_json<>&)>(library, entry.name + "_" + functionName);
+        }
+        std::cout << "\tLinked " << entry.name << '.' << std::endl;
+        linkedNames.insert(entry.name);
+    }
+    for (const auto& name : BuiltinProperties()) {
+        std::cout << "\tUsing built-in " << name << '.' << std::endl;
+        linkedNames.insert(name);
     }
+    _propertiesLinkedCount = static_cast<int>(linkedNames.size());
+}
+
+void ModuleProperties::RegisterBuiltinFunction(const std::string& propertyName, const std::string& functionName, boost::any (*function)()) {
+    BuiltinProperties().insert(propertyName);
+    Functions()[functionName] = boost::make_shared<boost::any(*)()>(function);
+}
+
+void ModuleProperties::RegisterBuiltinFunction(const std::string& propertyName, const std::string& functionName, boost::any (*function)(IModuleProperty*)) {
+    BuiltinProperties().insert(propertyName);
+    InstFunctions()[functionName] = boost::make_shared<boost::any(*)(IModuleProperty*)>(function);
+}
+
+void ModuleProperties::RegisterBuiltinFunction(const std::string& propertyName, const std::string& functionName, boost::any (*function)(const nlohmann::basic_json<>&)) {
+    BuiltinProperties().insert(propertyName);
+    ArgFunctions()[functionName] = boost::make_shared<boost::any(*)(const nlohmann::basic_json<>&)>(function);
+}
+
+void ModuleProperties::RegisterBuiltinFunction(const std::string& propertyName, const std::string& functionName, boost::any (*function)(IModuleProperty*, const nlohmann::basic_json<>&)) {
+    BuiltinProperties().insert(propertyName);
+    ArgInstFunctions()[functionName] = boost::make_shared<boost::any(*)(IModuleProperty*, const nlohmann::basic_json<>&)>(function);
 }
 
 int ModuleProperties::PropertyCount() {
@@ -190,82 +481,117 @@ void ModuleProperties::CallFunction(const boost::shared_ptr<boost::any(*)(const
 }
 
 void ModuleProperties::InitProperties(const nlohmann::basic_json<>& propertyDefs) {
+    std::vector<int> values = Sets()[_id].values;
     for (const auto& key : PropertyKeys()) {
         if (propertyDefs.contains(key)) {
             auto property = Constructors()[key](propertyDefs[key]);
-            _properties.insert(property);
+            bool dynamic = false;
             if (propertyDefs[key].contains("static") && propertyDefs[key]["static"] == false) {
-                if (auto dynamicProperty = dynamic_cast<IModuleDynamicProperty*>(property); dynamicProperty == nullptr) {
+                if (dynamic_cast<IModuleDynamicProperty*>(property) == nullptr) {
                     std::cerr << "Property definition for " << key
                     << " is marked as non-static but implementation class does not inherit from IModuleDynamicProperty."
                     << std::endl;
                 } else {
                     _anyDynamicProperties = true;
-                    _dynamicProperties.insert(dynamicProperty);
+                    dynamic = true;
                 }
             }
+            values.push_back(InternValue(property, dynamic));
         }
     }
+    _id = InternSet(std::move(values));
 }
 
-void ModuleProperties::UpdateProperties(const std::valarray<int>& moveInfo) const {
-    for (const auto property : _dynamicProperties) {
+void ModuleProperties::UpdateProperties(const std::valarray<int>& moveInfo) {
+    std::vector<int> values = Sets()[_id].values;
+    bool changed = false;
+    for (auto& valueId : values) {
+        if (!Values()[valueId].dynamic) continue;
+        const auto property = dynamic_cast<IModuleDynamicProperty*>(Values()[valueId].property)->MakeCopy();
         property->UpdateProperty(moveInfo);
+        valueId = InternValue(property, true);
+        changed = true;
+    }
+    if (changed) {
+        _id = InternSet(std::move(values));
     }
 }
 
-bool ModuleProperties::operator==(const ModuleProperties& right) const {
-    if (_properties.size() != right._properties.size()) {
-        return false;
+int ModuleProperties::RegisterCheck(const PropertyFunctionDef& check) {
+    const int id = FindOrAddFunctionDef(Checks(), check);
+    if (id >= CheckResults().size()) {
+        CheckResults().resize(id + 1);
     }
+    return id;
+}
 
-    for (const auto rProp : right._properties) {
-        if (const auto lProp = Find(rProp->key); lProp == nullptr || !lProp->CompareProperty(*rProp)) {
-            return false;
+bool ModuleProperties::Check(const int checkId) const {
+    auto& results = CheckResults()[checkId];
+    if (_id < results.size() && results[_id] >= 0) {
+        return results[_id];
+    }
+    const auto& check = Checks()[checkId];
+    bool result = false;
+    if (const auto property = Find(check.key); property != nullptr) {
+        if (check.functionType == INSTANCE_ARGS) {
+            result = property->CallFunction<bool>(check.function.argInstanceFunction, check.args);
+        } else {
+            result = property->CallFunction<bool>(check.function.instanceFunction);
         }
     }
-
-    return true;
+    if (_id >= results.size()) {
+        results.resize(Sets().size(), -1);
+    }
+    results[_id] = result;
+    return result;
 }
 
-bool ModuleProperties::operator!=(const ModuleProperties& right) const {
-    if (_properties.size() != right._properties.size()) {
-        return true;
+int ModuleProperties::RegisterUpdate(const PropertyFunctionDef& update) {
+    const int id = FindOrAddFunctionDef(Updates(), update);
+    if (id >= Transitions().size()) {
+        Transitions().resize(id + 1);
     }
+    return id;
+}
 
-    for (const auto rProp : right._properties) {
-        if (const auto lProp = Find(rProp->key); lProp == nullptr || !lProp->CompareProperty(*rProp)) {
-            return true;
+void ModuleProperties::ApplyUpdate(const int updateId) {
+    auto& transitions = Transitions()[updateId];
+    const int transitionIndex = _id * 2 + _reversing;
+    if (transitionIndex < transitions.size() && transitions[transitionIndex] >= 0) {
+        _id = transitions[transitionIndex];
+        return;
+    }
+    const auto& update = Updates()[updateId];
+    std::vector<int> values = Sets()[_id].values;
+    for (auto& valueId : values) {
+        if (Values()[valueId].property->key != update.key) continue;
+        const auto property = Values()[valueId].property->MakeCopy();
+        if (update.functionType == INSTANCE_ARGS) {
+            property->CallFunction(update.function.argInstanceFunction, update.args);
+        } else {
+            property->CallFunction(update.function.instanceFunction);
         }
+        valueId = InternValue(property, Values()[valueId].dynamic);
     }
+    const int updatedId = InternSet(std::move(values));
+    if (transitionIndex >= transitions.size()) {
+        transitions.resize(Sets().size() * 2, -1);
+    }
+    transitions[transitionIndex] = updatedId;
+    _id = updatedId;
+}
 
-    return false;
+bool ModuleProperties::operator==(const ModuleProperties& right) const {
+    return _id == right._id;
 }
 
-ModuleProperties& ModuleProperties::operator=(const ModuleProperties& right) {
-    for (const auto property : _properties) {
-        delete property;
-    }
-    _properties.clear();
-    for (const auto property : right._properties) {
-        _properties.insert(property->MakeCopy());
-    }
-    for (const auto property : _dynamicProperties) {
-        delete property;
-    }
-    _dynamicProperties.clear();
-    if (right._dynamicProperties.empty()) {
-        return *this;
-    }
-    for (const auto dynamicProperty : right._dynamicProperties) {
-        _dynamicProperties.insert(dynamicProperty->MakeCopy());
-    }
-    return *this;
+bool ModuleProperties::operator!=(const ModuleProperties& right) const {
+    return _id != right._id;
 }
 
 IModuleProperty* ModuleProperties::Find(const std::string& key) const {
-    for (const auto property : _properties) {
-        if (property->key == key) {
+    for (const auto valueId : Sets()[_id].values) {
+        if (const auto property = Values()[valueId].property; property->key == key) {
             return property;
         }
     }
@@ -273,24 +599,31 @@ IModuleProperty* ModuleProperties::Find(const std::string& key) const {
 }
 
 std::uint_fast64_t ModuleProperties::AsInt() const {
-    if (_properties.empty()) {
+    const auto& values = Sets()[_id].values;
+    if (values.empty()) {
         return 0;
     }
-    if (_properties.size() == 1) {
-        return (*_properties.begin())->AsInt();
+    if (values.size() == 1) {
+        return Values()[values.front()].property->AsInt();
     }
     std::cerr << "Representing multiple properties as an integer is not supported." << std::endl
-        << "Detected " << _properties.size() << " Properties:" << std::endl;
-    for (const auto property : _properties) {
-        std::cerr << '\t' << property->key << std::endl;
+        << "Detected " << values.size() << " Properties:" << std::endl;
+    for (const auto valueId : values) {
+        std::cerr << '\t' << Values()[valueId].property->key << std::endl;
     }
     exit(1);
 }
 
-ModuleProperties::~ModuleProperties() {
-    for (const auto property : _properties) {
-        delete property;
-    }
+int ModuleProperties::Id() const {
+    return _id;
+}
+
+int ModuleProperties::ValueCount() {
+    return static_cast<int>(Values().size());
+}
+
+int ModuleProperties::SetCount() {
+    return static_cast<int>(Sets().size());
 }
 
 PropertyInitializer::PropertyInitializer(const std::string& name, IModuleProperty* (*constructor)(const nlohmann::basic_json<>&)) {
@@ -300,10 +633,5 @@ PropertyInitializer::PropertyInitializer(const std::string& name, IModulePropert
 }
 
 std::size_t boost::hash<ModuleProperties>::operator()(const ModuleProperties& moduleProperties) const noexcept {
-    auto cmp = [](const int a, const int b) { return a < b; };
-    std::set<std::size_t, decltype(cmp)> hashes(cmp);
-    for (const auto property : moduleProperties._properties) {
-        hashes.insert(property->GetHash());
-    }
-    return boost::hash_range(hashes.begin(), hashes.end());
+    return ModuleProperties::Sets()[moduleProperties._id].hash;
 }
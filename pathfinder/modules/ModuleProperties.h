@@ -1,5 +1,7 @@
 #ifndef MODULEPROPERTIES_H
 #define MODULEPROPERTIES_H
+#include <cstdint>
+#include <map>
 #include <string>
 #include <unordered_set>
 #include <boost/container_hash/hash.hpp>
@@ -40,6 +42,28 @@ struct PropertyFunction {
     boost::shared_ptr<boost::any (*)(IModuleProperty*, const nlohmann::basic_json<>&)> argInstanceFunction;
 };
 
+// A distinct property value, stored once and shared by every module holding an equal value
+struct InternedProperty {
+    IModuleProperty* property;
+    std::size_t hash;
+    bool dynamic;
+};
+
+// A distinct combination of property values, position in the set table is the ID held by ModuleProperties
+struct InternedPropertySet {
+    // Sorted IDs of interned property values
+    std::vector<int> values;
+    std::size_t hash;
+};
+
+// An instance function called on one property of a module, registered so its results can be looked up
+struct PropertyFunctionDef {
+    std::string key;
+    PropertyFunctionType functionType;
+    PropertyFunction function;
+    nlohmann::basic_json<> args;
+};
+
 // Class used by modules to track and update their properties (other than coordinate info)
 class ModuleProperties {
 private:
@@ -61,6 +85,12 @@ private:
     // Static data for mapping strings to dynamic property functions with arguments
     static std::unordered_map<std::string, boost::shared_ptr<boost::any (*)(IModuleProperty*, const nlohmann::basic_json<>&)>>& ArgInstFunctions();
 
+    // Static data for libraries loaded by LinkProperties, each library is loaded once and shared by its functions
+    static std::vector<boost::shared_ptr<boost::dll::shared_library>>& Libraries();
+
+    // Static data for names of properties whose functions are compiled into the executable
+    static std::unordered_set<std::string>& BuiltinProperties();
+
     // # of properties linked
     static int _propertiesLinkedCount;
 
@@ -70,19 +100,55 @@ private:
     // Boolean to track if a move is being reversed
     static bool _reversing;
 
-    // Properties of a module
-    std::unordered_set<IModuleProperty*> _properties;
+    // Static data for interned property values, indexed by value ID
+    static std::vector<InternedProperty>& Values();
+
+    // Static data for mapping property hashes to value IDs sharing that hash
+    static std::unordered_multimap<std::size_t, int>& ValueIds();
+
+    // Static data for interned property sets, indexed by set ID, set 0 is always the empty set
+    static std::vector<InternedPropertySet>& Sets();
+
+    // Static data for mapping sorted value IDs to set IDs
+    static std::map<std::vector<int>, int>& SetIds();
+
+    // Static data for registered property checks, indexed by check ID
+    static std::vector<PropertyFunctionDef>& Checks();
+
+    // Static data for check results, indexed by check ID and then by set ID, -1 if not yet evaluated
+    static std::vector<std::vector<std::int8_t>>& CheckResults();
+
+    // Static data for registered property updates, indexed by update ID
+    static std::vector<PropertyFunctionDef>& Updates();
+
+    // Static data for update results, indexed by update ID and then by set ID * 2 + reversing, -1 if not yet applied
+    static std::vector<std::vector<int>>& Transitions();
 
-    // Dynamic properties
-    std::unordered_set<IModuleDynamicProperty*> _dynamicProperties;
+    // Get ID of a property value, takes ownership of the property and deletes it if an equal value is already interned
+    static int InternValue(IModuleProperty* property, bool dynamic);
+
+    // Get ID of a set of property values, assigning a new one if it hasn't been seen before
+    static int InternSet(std::vector<int> values);
+
+    // ID of this module's property set
+    int _id = 0;
 public:
 
     ModuleProperties() = default;
 
-    ModuleProperties(const ModuleProperties& other);
-
+    // Link functions of every property in "Module Properties/", built-in properties are linked without loading a
+    // library, and property definitions are read from a cached manifest when none of them have changed
     static void LinkProperties();
 
+    // Used by built-in properties to add their functions, the property's library will not be loaded by LinkProperties
+    static void RegisterBuiltinFunction(const std::string& propertyName, const std::string& functionName, boost::any (*function)());
+
+    static void RegisterBuiltinFunction(const std::string& propertyName, const std::string& functionName, boost::any (*function)(IModuleProperty*));
+
+    static void RegisterBuiltinFunction(const std::string& propertyName, const std::string& functionName, boost::any (*function)(const nlohmann::basic_json<>&));
+
+    static void RegisterBuiltinFunction(const std::string& propertyName, const std::string& functionName, boost::any (*function)(IModuleProperty*, const nlohmann::basic_json<>&));
+
     static int PropertyCount();
 
     static bool AnyDynamicPropertiesLinked();
@@ -161,20 +227,41 @@ public:
 
     void InitProperties(const nlohmann::basic_json<>& propertyDefs);
 
-    void UpdateProperties(const std::valarray<int>& moveInfo) const;
+    void UpdateProperties(const std::valarray<int>& moveInfo);
+
+    // Register an instance function check so that it can be evaluated with Check, equal checks share an ID
+    static int RegisterCheck(const PropertyFunctionDef& check);
+
+    // Result of a registered check, false if the checked property is missing, only the first evaluation of a check
+    // against a given property set calls into the property library
+    [[nodiscard]]
+    bool Check(int checkId) const;
+
+    // Register an instance function update so that it can be applied with ApplyUpdate, equal updates share an ID
+    static int RegisterUpdate(const PropertyFunctionDef& update);
+
+    // Replace the updated property with the result of a registered update, only the first application of an update
+    // to a given property set calls into the property library
+    void ApplyUpdate(int updateId);
 
     bool operator==(const ModuleProperties& right) const;
 
     bool operator!=(const ModuleProperties& right) const;
 
-    ModuleProperties& operator=(const ModuleProperties& right);
-
+    // Interned properties are shared between modules, they must not be modified through the returned pointer
     IModuleProperty* Find(const std::string& key) const;
 
     [[nodiscard]]
     std::uint_fast64_t AsInt() const;
 
-    ~ModuleProperties();
+    // Get ID of the interned property set, equal properties always have equal IDs
+    [[nodiscard]]
+    int Id() const;
+
+    // Get # of distinct property values and property sets interned so far
+    static int ValueCount();
+
+    static int SetCount();
 
     friend class IModuleProperty;
     friend struct PropertyInitializer;
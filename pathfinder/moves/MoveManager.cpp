@@ -1,9 +1,18 @@
 #include <string>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
 #include <fstream>
 #include <filesystem>
 #include <execution>
+#if !__EMSCRIPTEN__
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#endif
 #include "MoveManager.h"
 #include "../search/ConfigurationSpace.h"
+#include "../search/Profiler.h"
 
 void Move::RotateAnim(Move::AnimType& anim, const int a, const int b) {
     // For easily rotating move types
@@ -150,19 +159,20 @@ MovePropertyCheck::MovePropertyCheck(const nlohmann::basic_json<> &propertyCheck
     } else {
         reflectOnNormalRotation = false;
     }
+    functionName = propertyCheckDef["function"].get<std::string>();
     if (isInstance) {
         if (hasArguments) {
-            propertyFunction.argInstanceFunction = ModuleProperties::ArgInstFunctions()[propertyCheckDef["function"]];
+            propertyFunction.argInstanceFunction = ModuleProperties::ArgInstFunctions()[functionName];
             functionType = INSTANCE_ARGS;
         } else {
-            propertyFunction.instanceFunction = ModuleProperties::InstFunctions()[propertyCheckDef["function"]];
+            propertyFunction.instanceFunction = ModuleProperties::InstFunctions()[functionName];
             functionType = INSTANCE_NOARGS;
         }
     } else if (hasArguments) {
-        propertyFunction.argStaticFunction = ModuleProperties::ArgFunctions()[propertyCheckDef["function"]];
+        propertyFunction.argStaticFunction = ModuleProperties::ArgFunctions()[functionName];
         functionType = STATIC_ARGS;
     } else {
-        propertyFunction.staticFunction = ModuleProperties::Functions()[propertyCheckDef["function"]];
+        propertyFunction.staticFunction = ModuleProperties::Functions()[functionName];
         functionType = STATIC_NOARGS;
     }
 }
@@ -171,23 +181,43 @@ bool MovePropertyCheck::DoCheck(const std::valarray<int>& checkFromPosition) con
     switch (functionType) {
         case STATIC_NOARGS:
             return ModuleProperties::CallFunction<bool>(propertyFunction.staticFunction);
-        case INSTANCE_NOARGS: {
-            const auto modIdToCheck = Lattice::coordTensor[checkFromPosition + modOffset];
-            const auto prop = ModuleIdManager::GetModule(modIdToCheck).properties.Find(propertyName);
-            return prop->CallFunction<bool>(propertyFunction.instanceFunction);
-        }
         case STATIC_ARGS:
             return ModuleProperties::CallFunction<bool>(propertyFunction.argStaticFunction, args);
+        case INSTANCE_NOARGS:
         case INSTANCE_ARGS: {
+            // Instance checks only depend on the interned properties, so results are looked up rather than recomputed
+            if (checkId < 0) {
+                checkId = ModuleProperties::RegisterCheck({propertyName, functionType, propertyFunction, args});
+            }
             const auto modIdToCheck = Lattice::coordTensor[checkFromPosition + modOffset];
-            const auto prop = ModuleIdManager::GetModule(modIdToCheck).properties.Find(propertyName);
-            return prop->CallFunction<bool>(propertyFunction.argInstanceFunction, args);
+            return ModuleIdManager::GetModule(modIdToCheck).properties.Check(checkId);
         }
         default:
             return false;
     }
 }
 
+bool MovePropertyCheck::IsStatic() const {
+    return functionType == STATIC_NOARGS || functionType == STATIC_ARGS;
+}
+
+nlohmann::basic_json<> MovePropertyCheck::ToJson() const {
+    nlohmann::basic_json<> def;
+    def["function"] = functionName;
+    if (functionType == INSTANCE_NOARGS || functionType == INSTANCE_ARGS) {
+        def["module"] = std::vector<int>(std::begin(modOffset), std::end(modOffset));
+        def["property"] = propertyName;
+    }
+    if (functionType == STATIC_ARGS || functionType == INSTANCE_ARGS) {
+        def["args"] = args;
+    }
+    def["rotateArgs"] = allArgsRotate ? nlohmann::basic_json<>(true) : nlohmann::basic_json<>(rotateArgIndices);
+    def["reflectArgs"] = allArgsReflect ? nlohmann::basic_json<>(true) : nlohmann::basic_json<>(reflectArgIndices);
+    def["inverseReflection"] = invertReflection;
+    def["reflectOnNormalRotation"] = reflectOnNormalRotation;
+    return def;
+}
+
 MovePropertyCheck *MovePropertyCheck::MakeCopy() const {
     const auto copy = new MovePropertyCheck(*this);
     *copy = *this;
@@ -195,6 +225,7 @@ MovePropertyCheck *MovePropertyCheck::MakeCopy() const {
 }
 
 void MovePropertyCheck::Rotate(int a, int b) {
+    checkId = -1;
     std::swap(modOffset[a], modOffset[b]);
     if (allArgsRotate) for (auto& arg : args) {
         if (arg.is_array()) {
@@ -212,6 +243,7 @@ void MovePropertyCheck::Rotate(int a, int b) {
 }
 
 void MovePropertyCheck::Reflect(int index) {
+    checkId = -1;
     modOffset[index] *= -1;
     if (allArgsReflect) for (auto& arg : args) {
         if (arg.is_array()) {
@@ -282,19 +314,20 @@ MovePropertyUpdate::MovePropertyUpdate(const nlohmann::basic_json<> &propertyUpd
     } else {
         reflectOnNormalRotation = false;
     }
+    functionName = propertyUpdateDef["function"].get<std::string>();
     if (isInstance) {
         if (hasArguments) {
-            propertyFunction.argInstanceFunction = ModuleProperties::ArgInstFunctions()[propertyUpdateDef["function"]];
+            propertyFunction.argInstanceFunction = ModuleProperties::ArgInstFunctions()[functionName];
             functionType = INSTANCE_ARGS;
         } else {
-            propertyFunction.instanceFunction = ModuleProperties::InstFunctions()[propertyUpdateDef["function"]];
+            propertyFunction.instanceFunction = ModuleProperties::InstFunctions()[functionName];
             functionType = INSTANCE_NOARGS;
         }
     } else if (hasArguments) {
-        propertyFunction.argStaticFunction = ModuleProperties::ArgFunctions()[propertyUpdateDef["function"]];
+        propertyFunction.argStaticFunction = ModuleProperties::ArgFunctions()[functionName];
         functionType = STATIC_ARGS;
     } else {
-        propertyFunction.staticFunction = ModuleProperties::Functions()[propertyUpdateDef["function"]];
+        propertyFunction.staticFunction = ModuleProperties::Functions()[functionName];
         functionType = STATIC_NOARGS;
     }
 }
@@ -305,25 +338,47 @@ void MovePropertyUpdate::DoUpdate(const std::valarray<int>& updateFromPosition)
             ModuleProperties::CallFunction(propertyFunction.staticFunction);
             break;
         }
-        case INSTANCE_NOARGS: {
+        case INSTANCE_NOARGS:
+        case INSTANCE_ARGS: {
+            // Properties are interned, so the module is switched to the updated value rather than modified in place
+            if (updateId < 0) {
+                updateId = ModuleProperties::RegisterUpdate({propertyName, functionType, propertyFunction, args});
+            }
             const auto modIdToCheck = Lattice::coordTensor[updateFromPosition + modOffset];
-            const auto prop = ModuleIdManager::GetModule(modIdToCheck).properties.Find(propertyName);
-            prop->CallFunction(propertyFunction.instanceFunction);
+            ModuleIdManager::GetModule(modIdToCheck).properties.ApplyUpdate(updateId);
             break;
         }
         case STATIC_ARGS: {
             ModuleProperties::CallFunction(propertyFunction.argStaticFunction, args);
             break;
         }
-        case INSTANCE_ARGS: {
-            const auto modIdToCheck = Lattice::coordTensor[updateFromPosition + modOffset];
-            const auto prop = ModuleIdManager::GetModule(modIdToCheck).properties.Find(propertyName);
-            prop->CallFunction(propertyFunction.argInstanceFunction, args);
-            break;
-        }
     }
 }
 
+int MovePropertyUpdate::UpdateTarget(const std::valarray<int>& updateFromPosition) const {
+    if (functionType == INSTANCE_NOARGS || functionType == INSTANCE_ARGS) {
+        return Lattice::coordTensor[updateFromPosition + modOffset];
+    }
+    return -1;
+}
+
+nlohmann::basic_json<> MovePropertyUpdate::ToJson() const {
+    nlohmann::basic_json<> def;
+    def["function"] = functionName;
+    if (functionType == INSTANCE_NOARGS || functionType == INSTANCE_ARGS) {
+        def["module"] = std::vector<int>(std::begin(modOffset), std::end(modOffset));
+        def["property"] = propertyName;
+    }
+    if (functionType == STATIC_ARGS || functionType == INSTANCE_ARGS) {
+        def["args"] = args;
+    }
+    def["rotateArgs"] = allArgsRotate ? nlohmann::basic_json<>(true) : nlohmann::basic_json<>(rotateArgIndices);
+    def["reflectArgs"] = allArgsReflect ? nlohmann::basic_json<>(true) : nlohmann::basic_json<>(reflectArgIndices);
+    def["inverseReflection"] = invertReflection;
+    def["reflectOnNormalRotation"] = reflectOnNormalRotation;
+    return def;
+}
+
 MovePropertyUpdate *MovePropertyUpdate::MakeCopy() const {
     const auto copy = new MovePropertyUpdate(*this);
     *copy = *this;
@@ -331,6 +386,7 @@ MovePropertyUpdate *MovePropertyUpdate::MakeCopy() const {
 }
 
 void MovePropertyUpdate::Rotate(int a, int b) {
+    updateId = -1;
     std::swap(modOffset[a], modOffset[b]);
     if (allArgsRotate) for (auto& arg : args) {
         if (arg.is_array()) {
@@ -348,6 +404,7 @@ void MovePropertyUpdate::Rotate(int a, int b) {
 }
 
 void MovePropertyUpdate::Reflect(int index) {
+    updateId = -1;
     modOffset[index] *= -1;
     if (allArgsReflect) for (auto& arg : args) {
         if (arg.is_array()) {
@@ -419,6 +476,16 @@ void MoveBase::ApplyUpdates(const Module& mod) const {
     }
 }
 
+std::vector<int> MoveBase::UpdatedModules(const Module& mod) const {
+    std::vector<int> updated;
+    for (const auto& update : propertyUpdates) {
+        if (const auto id = update.UpdateTarget(mod.coords); id >= 0 && id != mod.id) {
+            updated.push_back(id);
+        }
+    }
+    return updated;
+}
+
 void MoveBase::Rotate(const int a, const int b) {
     std::swap(initPos[a], initPos[b]);
     std::swap(finalPos[a], finalPos[b]);
@@ -457,6 +524,12 @@ void MoveBase::Reflect(const int index) {
     }
 }
 
+bool MoveBase::PropertyCheck(const Module& mod) const {
+    return std::all_of(propertyChecks.begin(), propertyChecks.end(), [&mod](const MovePropertyCheck& check) {
+        return check.DoCheck(mod.coords);
+    });
+}
+
 const std::valarray<int>& MoveBase::MoveOffset() const {
     return finalPos;
 }
@@ -465,28 +538,41 @@ const std::vector<std::pair<Move::AnimType, std::valarray<int>>>& MoveBase::Anim
     return animSequence;
 }
 
+std::pair<std::vector<std::pair<std::vector<int>, bool>>, std::vector<std::string>> MoveBase::CanonicalChecks() const {
+    std::pair<std::vector<std::pair<std::vector<int>, bool>>, std::vector<std::string>> canonical;
+    auto& [cells, checks] = canonical;
+    cells.reserve(moves.size());
+    for (const auto& [offset, hasModule] : moves) {
+        cells.emplace_back(std::vector<int>(std::begin(offset), std::end(offset)), hasModule);
+    }
+    std::sort(cells.begin(), cells.end());
+    checks.reserve(propertyChecks.size());
+    for (const auto& check : propertyChecks) {
+        checks.push_back(check.ToJson().dump());
+    }
+    std::sort(checks.begin(), checks.end());
+    return canonical;
+}
+
+std::size_t MoveBase::Hash() const {
+    const auto [cells, checks] = CanonicalChecks();
+    auto hash = boost::hash_range(std::begin(finalPos), std::end(finalPos));
+    for (const auto& [offset, hasModule] : cells) {
+        boost::hash_combine(hash, boost::hash_range(offset.begin(), offset.end()));
+        boost::hash_combine(hash, hasModule);
+    }
+    boost::hash_range(hash, checks.begin(), checks.end());
+    return hash;
+}
+
 bool MoveBase::operator==(const MoveBase& rhs) const {
-    std::valarray<bool> valArrComparison = finalPos == rhs.finalPos;
-    for (const auto result : valArrComparison) {
-        if (!result) {
-            return false;
-        }
-    }
-    if (moves.size() != rhs.moves.size()) {
+    if (finalPos.size() != rhs.finalPos.size() || (finalPos != rhs.finalPos).max()) {
         return false;
     }
-    for (auto it = moves.begin(), it2 = rhs.moves.begin(); it != moves.end(); ++it, ++it2) {
-        valArrComparison = it->first == it2->first;
-        for (const auto result : valArrComparison) {
-            if (!result) {
-                return false;
-            }
-        }
-        if (it->second != it->second) {
-            return false;
-        }
+    if (moves.size() != rhs.moves.size() || propertyChecks.size() != rhs.propertyChecks.size()) {
+        return false;
     }
-    return true;
+    return CanonicalChecks() == rhs.CanonicalChecks();
 }
 
 
@@ -582,7 +668,7 @@ bool Move2d::MoveCheck(const CoordTensor<int>& tensor, const Module& mod) {
     // Bounds checking
 #if MOVEMANAGER_BOUNDS_CHECKS
     for (int i = 0; i < order; i++) {
-        if (mod.coords[i] - bounds[i].first < 0 || mod.coords[i] + bounds[i].second >= Lattice::AxisSize()) {
+        if (mod.coords[i] - bounds[i].first < 0 || mod.coords[i] + bounds[i].second >= Lattice::AxisSize(i)) {
             return false;
         }
     }
@@ -594,10 +680,8 @@ bool Move2d::MoveCheck(const CoordTensor<int>& tensor, const Module& mod) {
         }
         return true;
     });
-    if (result && !Lattice::ignoreProperties) for (const auto& check : propertyChecks) {
-        if (!check.DoCheck(mod.coords)) {
-            return false;
-        }
+    if (result && !Lattice::ignoreProperties) {
+        return PropertyCheck(mod);
     }
     return result;
 }
@@ -706,7 +790,7 @@ bool Move3d::MoveCheck(const CoordTensor<int>& tensor, const Module& mod) {
     // Bounds checking
 #if MOVEMANAGER_BOUNDS_CHECKS
     for (int i = 0; i < order; i++) {
-        if (mod.coords[i] - bounds[i].first < 0 || mod.coords[i] + bounds[i].second >= tensor.AxisSize()) {
+        if (mod.coords[i] - bounds[i].first < 0 || mod.coords[i] + bounds[i].second >= tensor.AxisSize(i)) {
             return false;
         }
     }
@@ -718,20 +802,321 @@ bool Move3d::MoveCheck(const CoordTensor<int>& tensor, const Module& mod) {
         }
         return true;
     });
-    if (result && !Lattice::ignoreProperties) for (const auto& check : propertyChecks) {
-        if (!check.DoCheck(mod.coords)) {
-            return false;
-        }
+    if (result && !Lattice::ignoreProperties) {
+        return PropertyCheck(mod);
     }
     return result;
 }
 
+const char* LegalMoveCacheExcept::what() const noexcept {
+    return "Cached legal moves don't match a fresh computation!";
+}
+
 std::vector<MoveBase*> MoveManager::_moves;
 CoordTensor<std::vector<MoveBase*>> MoveManager::_movesByOffset(1, 1, {});
 std::vector<std::valarray<int>> MoveManager::_offsets;
+std::unordered_multimap<std::size_t, MoveBase*> MoveManager::_movesByHash;
+int MoveManager::_redundantMoves = 0;
+std::vector<MoveBase*> MoveManager::_folderMoves;
+std::vector<std::valarray<int>> MoveManager::_neighborhoodCells;
+std::vector<int> MoveManager::_neighborhoodIndexOffsets;
+std::size_t MoveManager::_neighborhoodGeneration = 0;
+std::vector<std::vector<std::pair<MoveBase*, std::vector<std::pair<int, bool>>>>> MoveManager::_neighborhoodChecks;
+std::unordered_map<MoveManager::NeighborhoodSignature, std::vector<std::vector<MoveBase*>>,
+        boost::hash<MoveManager::NeighborhoodSignature>> MoveManager::_neighborhoodTable;
+std::vector<std::vector<MoveBase*>> MoveManager::_legalMoves;
+std::vector<bool> MoveManager::_legalMovesValid;
+bool MoveManager::_cacheLegalMoves = true;
+std::vector<int> MoveManager::_legalMoveRangeOffsets;
+std::size_t MoveManager::_legalMoveRangeGeneration = 0;
+bool MoveManager::_holdLegalMoves = false;
 int MoveManager::_maxDist = 0;
 
+namespace {
+    // Bump whenever the move library layout changes
+    constexpr std::uint32_t MOVE_LIBRARY_VERSION = 2;
+
+    constexpr std::uint32_t MOVE_LIBRARY_MAGIC = 0x4C4D4650; // "PFML"
+
+    // FNV-1a, move folder hashes name cached libraries so they must not change between runs or builds
+    void HashBytes(std::uint64_t& hash, const char* data, const std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 0x100000001B3;
+        }
+    }
+
+    // Hash of the contents of every file in a move folder along with their paths relative to it
+    std::uint64_t HashMoveFolder(const std::string& movePath) {
+        std::vector<std::filesystem::path> moveFiles;
+        for (const auto& moveFile : std::filesystem::recursive_directory_iterator(movePath)) {
+            if (moveFile.is_regular_file()) {
+                moveFiles.push_back(moveFile.path());
+            }
+        }
+        std::ranges::sort(moveFiles);
+        std::uint64_t hash = 0xCBF29CE484222325;
+        for (const auto& moveFile : moveFiles) {
+            const auto relativePath = std::filesystem::relative(moveFile, movePath).generic_string();
+            HashBytes(hash, relativePath.data(), relativePath.size() + 1);
+            std::ifstream file(moveFile, std::ios::binary);
+            const std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            HashBytes(hash, contents.data(), contents.size());
+        }
+        return hash;
+    }
+
+    class MoveLibraryWriter {
+    private:
+        std::ofstream out;
+    public:
+        explicit MoveLibraryWriter(const std::string& path) : out(path, std::ios::binary) {}
+
+        template<typename T>
+        void Write(const T value) {
+            out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void Write(const std::valarray<int>& values) {
+            Write<std::int32_t>(static_cast<std::int32_t>(values.size()));
+            for (const auto value : values) {
+                Write<std::int32_t>(value);
+            }
+        }
+
+        void Write(const std::vector<std::uint8_t>& bytes) {
+            Write<std::int32_t>(static_cast<std::int32_t>(bytes.size()));
+            out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        }
+
+        [[nodiscard]]
+        bool Good() const {
+            return out.good();
+        }
+    };
+
+    class MoveLibraryReader {
+    private:
+        const char* pos;
+        const char* end;
+        bool good = true;
+    public:
+        MoveLibraryReader(const void* data, const std::size_t size) : pos(static_cast<const char*>(data)), end(pos + size) {}
+
+        template<typename T>
+        T Read() {
+            T value{};
+            if (end - pos < static_cast<std::ptrdiff_t>(sizeof(T))) {
+                good = false;
+                return value;
+            }
+            std::memcpy(&value, pos, sizeof(T));
+            pos += sizeof(T);
+            return value;
+        }
+
+        std::valarray<int> ReadArray() {
+            const auto size = Read<std::int32_t>();
+            if (size < 0 || end - pos < static_cast<std::ptrdiff_t>(size * sizeof(std::int32_t))) {
+                good = false;
+                return {};
+            }
+            std::valarray<int> values(size);
+            for (auto& value : values) {
+                value = Read<std::int32_t>();
+            }
+            return values;
+        }
+
+        std::vector<std::uint8_t> ReadBytes() {
+            const auto size = Read<std::int32_t>();
+            if (size < 0 || end - pos < size) {
+                good = false;
+                return {};
+            }
+            std::vector<std::uint8_t> bytes(pos, pos + size);
+            pos += size;
+            return bytes;
+        }
+
+        [[nodiscard]]
+        bool Good() const {
+            return good;
+        }
+    };
+
+    // Hash of a move folder, only computed once per folder
+    std::uint64_t MoveFolderHash(const std::string& movePath) {
+        static std::unordered_map<std::string, std::uint64_t> folderHashes;
+        if (!folderHashes.contains(movePath)) {
+            folderHashes[movePath] = HashMoveFolder(movePath);
+        }
+        return folderHashes[movePath];
+    }
+
+    // Read the maximum move distance from a move library's header, returns false if there is no usable library
+    bool ReadMoveLibraryMaxDist(const std::string& libraryPath, int& maxDist) {
+        std::ifstream file(libraryPath, std::ios::binary);
+        char header[4 * sizeof(std::uint32_t) + sizeof(std::uint64_t)];
+        if (!file.read(header, sizeof(header))) {
+            return false;
+        }
+        MoveLibraryReader reader(header, sizeof(header));
+        if (reader.Read<std::uint32_t>() != MOVE_LIBRARY_MAGIC || reader.Read<std::uint32_t>() != MOVE_LIBRARY_VERSION) {
+            return false;
+        }
+        reader.Read<std::uint64_t>();
+        reader.Read<std::int32_t>();
+        maxDist = std::max(maxDist, reader.Read<std::int32_t>());
+        return true;
+    }
+}
+
+std::string MoveManager::MoveLibraryPath(const std::string& movePath, const int order) {
+    if (std::string(MOVEMANAGER_LIBRARY_CACHE).empty() || !std::filesystem::is_directory(movePath)) {
+        return "";
+    }
+    std::stringstream path;
+    path << MOVEMANAGER_LIBRARY_CACHE << std::hex << std::setw(16) << std::setfill('0') << MoveFolderHash(movePath)
+         << std::dec << '-' << order << "d.movelib";
+    return path.str();
+}
+
+bool MoveManager::LoadMoveLibrary(const std::string& movePath) {
+#if __EMSCRIPTEN__
+    return false;
+#else
+    const auto libraryPath = MoveLibraryPath(movePath, Lattice::order);
+    if (libraryPath.empty() || !std::filesystem::is_regular_file(libraryPath) || std::filesystem::file_size(libraryPath) == 0) {
+        return false;
+    }
+    std::vector<MoveBase*> loadedMoves;
+    try {
+        const boost::interprocess::file_mapping file(libraryPath.c_str(), boost::interprocess::read_only);
+        const boost::interprocess::mapped_region region(file, boost::interprocess::read_only);
+        MoveLibraryReader reader(region.get_address(), region.get_size());
+        if (reader.Read<std::uint32_t>() != MOVE_LIBRARY_MAGIC || reader.Read<std::uint32_t>() != MOVE_LIBRARY_VERSION) {
+            return false;
+        }
+        if (reader.Read<std::uint64_t>() != MoveFolderHash(movePath) || reader.Read<std::int32_t>() != Lattice::order) {
+            return false;
+        }
+        _maxDist = std::max(_maxDist, reader.Read<std::int32_t>());
+        const auto moveCount = reader.Read<std::int32_t>();
+        for (int i = 0; i < moveCount && reader.Good(); i++) {
+            MoveBase* move;
+            if (reader.Read<std::int32_t>() == 2) {
+                move = new Move2d();
+            } else {
+                move = new Move3d();
+            }
+            Isometry::transformsToFree.push_back(move);
+            move->initPos = reader.ReadArray();
+            move->finalPos = reader.ReadArray();
+            for (auto& [lower, upper] : move->bounds) {
+                lower = reader.Read<std::int32_t>();
+                upper = reader.Read<std::int32_t>();
+            }
+            const auto checkCount = reader.Read<std::int32_t>();
+            for (int j = 0; j < checkCount && reader.Good(); j++) {
+                auto offset = reader.ReadArray();
+                move->moves.emplace_back(std::move(offset), reader.Read<std::int32_t>() != 0);
+            }
+            const auto animCount = reader.Read<std::int32_t>();
+            for (int j = 0; j < animCount && reader.Good(); j++) {
+                const auto animType = static_cast<Move::AnimType>(reader.Read<std::int32_t>());
+                move->animSequence.emplace_back(animType, reader.ReadArray());
+            }
+            for (const auto& checkDef : nlohmann::json::from_msgpack(reader.ReadBytes())) {
+                move->propertyChecks.emplace_back(checkDef);
+            }
+            for (const auto& updateDef : nlohmann::json::from_msgpack(reader.ReadBytes())) {
+                move->propertyUpdates.emplace_back(updateDef);
+            }
+            loadedMoves.push_back(move);
+        }
+        if (!reader.Good()) {
+            return false;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load move library " << libraryPath << ": " << e.what() << std::endl;
+        return false;
+    }
+    for (const auto move : loadedMoves) {
+        RegisterSingleMove(move);
+    }
+    IndexMovesByOffset();
+#if MOVEMANAGER_VERBOSE > MM_LOG_NONE
+    DEBUG("Loaded " << loadedMoves.size() << " moves from move library " << libraryPath << std::endl);
+#endif
+    return true;
+#endif
+}
+
+void MoveManager::SaveMoveLibrary(const std::string& movePath, const std::span<MoveBase* const> moves) {
+    const auto libraryPath = MoveLibraryPath(movePath, Lattice::order);
+    if (libraryPath.empty()) {
+        return;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(libraryPath).parent_path(), ec);
+    // Written under a temporary name and then renamed, so concurrent runs never see a partially written library
+    const auto tempPath = libraryPath + '.' + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+    {
+        MoveLibraryWriter writer(tempPath);
+        writer.Write<std::uint32_t>(MOVE_LIBRARY_MAGIC);
+        writer.Write<std::uint32_t>(MOVE_LIBRARY_VERSION);
+        writer.Write<std::uint64_t>(MoveFolderHash(movePath));
+        writer.Write<std::int32_t>(Lattice::order);
+        writer.Write<std::int32_t>(_maxDist);
+        writer.Write<std::int32_t>(static_cast<std::int32_t>(moves.size()));
+        for (const auto move : moves) {
+            writer.Write<std::int32_t>(move->order);
+            writer.Write(move->initPos);
+            writer.Write(move->finalPos);
+            for (const auto& [lower, upper] : move->bounds) {
+                writer.Write<std::int32_t>(lower);
+                writer.Write<std::int32_t>(upper);
+            }
+            writer.Write<std::int32_t>(static_cast<std::int32_t>(move->moves.size()));
+            for (const auto& [offset, check] : move->moves) {
+                writer.Write(offset);
+                writer.Write<std::int32_t>(check);
+            }
+            writer.Write<std::int32_t>(static_cast<std::int32_t>(move->animSequence.size()));
+            for (const auto& [animType, offset] : move->animSequence) {
+                writer.Write<std::int32_t>(animType);
+                writer.Write(offset);
+            }
+            auto checkDefs = nlohmann::json::array();
+            for (const auto& check : move->propertyChecks) {
+                checkDefs.push_back(check.ToJson());
+            }
+            writer.Write(nlohmann::json::to_msgpack(checkDefs));
+            auto updateDefs = nlohmann::json::array();
+            for (const auto& update : move->propertyUpdates) {
+                updateDefs.push_back(update.ToJson());
+            }
+            writer.Write(nlohmann::json::to_msgpack(updateDefs));
+        }
+        if (!writer.Good()) {
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(tempPath, libraryPath, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+    }
+}
+
 void MoveManager::PreprocessMoves(const std::string& movePath) {
+    // A cached library of either order already knows the maximum move distance
+    for (const int order : {2, 3}) {
+        if (ReadMoveLibraryMaxDist(MoveLibraryPath(movePath, order), _maxDist)) {
+            return;
+        }
+    }
     nlohmann::json moveJson;
     for (const auto& moveFile : std::filesystem::recursive_directory_iterator(movePath)) {
         if (!moveFile.is_regular_file()) continue;
@@ -775,13 +1160,27 @@ void MoveManager::InitMoveManager(const int order, const int maxDistance) {
 }
 
 void MoveManager::MoveModule(Module& mod, const MoveBase* move) {
-    if (!ModuleProperties::IsReversing() && !Lattice::ignoreProperties) {
+    // Updated modules other than the moving one stay put, but their neighbors may check their properties
+    const auto applyUpdates = [&mod, move]() {
+        if (!_holdLegalMoves) for (const auto id : move->UpdatedModules(mod)) {
+            InvalidateLegalMoves(ModuleIdManager::GetModule(id).coords);
+        }
         move->ApplyUpdates(mod);
+    };
+    if (!ModuleProperties::IsReversing() && !Lattice::ignoreProperties) {
+        applyUpdates();
     }
     Lattice::ClearAdjacencies(mod.id);
     Lattice::coordTensor[mod.coords] = FREE_SPACE;
+    if (!_holdLegalMoves) {
+        InvalidateLegalMoves(mod.coords);
+    }
     mod.coords += ModuleProperties::IsReversing() ? -move->MoveOffset() : move->MoveOffset();
     Lattice::coordTensor[mod.coords] = mod.id;
+    if (!_holdLegalMoves) {
+        InvalidateLegalMoves(mod.coords);
+        Lattice::revision++;
+    }
 #if LATTICE_OLD_EDGECHECK
 #if LATTICE_RD_EDGECHECK
     Lattice::RDEdgeCheck(mod);
@@ -792,7 +1191,7 @@ void MoveManager::MoveModule(Module& mod, const MoveBase* move) {
     Lattice::EdgeCheck(mod);
 #endif
     if (ModuleProperties::IsReversing() && !Lattice::ignoreProperties) {
-        move->ApplyUpdates(mod);
+        applyUpdates();
     }
 }
 
@@ -802,6 +1201,58 @@ void MoveManager::UnMoveModule(Module &mod, const MoveBase *move) {
     ModuleProperties::ToggleReverse();
 }
 
+StateDelta MoveManager::MakeDelta(const std::span<const std::pair<Module*, const MoveBase*>> moves) {
+    StateDelta delta;
+    std::vector<int> changedIds;
+    delta.moves.reserve(moves.size());
+    changedIds.reserve(moves.size());
+    for (const auto& [mod, move] : moves) {
+        delta.moves.emplace_back(mod->coords, move);
+        changedIds.push_back(mod->id);
+        if (!Lattice::ignoreProperties) {
+            for (const auto id : move->UpdatedModules(*mod)) {
+                if (std::ranges::find(changedIds, id) == changedIds.end()) {
+                    changedIds.push_back(id);
+                }
+            }
+        }
+    }
+    delta.removed.reserve(changedIds.size());
+    delta.added.reserve(changedIds.size());
+    for (const auto id : changedIds) {
+        const auto& mod = ModuleIdManager::GetModule(id);
+        delta.removed.emplace_back(mod.coords, mod.properties);
+    }
+    // The lattice is left as it was, so cached legal moves don't need invalidating
+    const auto held = _holdLegalMoves;
+    _holdLegalMoves = true;
+    for (const auto& [mod, move] : moves) {
+        MoveModule(*mod, move);
+    }
+    for (const auto id : changedIds) {
+        const auto& mod = ModuleIdManager::GetModule(id);
+        delta.added.emplace_back(mod.coords, mod.properties);
+    }
+    for (const auto& [mod, move] : moves) {
+        UnMoveModule(*mod, move);
+    }
+    _holdLegalMoves = held;
+    return delta;
+}
+
+std::vector<Module*> MoveManager::MakeMoves(const std::span<const ModuleMove> moves) {
+    std::vector<Module*> movedModules;
+    movedModules.reserve(moves.size());
+    // Find every module before moving any of them, moves within a step may share cells
+    for (const auto& [from, move] : moves) {
+        movedModules.push_back(&ModuleIdManager::GetModule(Lattice::coordTensor[from]));
+    }
+    for (int i = 0; i < moves.size(); i++) {
+        MoveModule(*movedModules[i], moves[i].move);
+    }
+    return movedModules;
+}
+
 void MoveManager::GenerateMovesFrom(MoveBase* origMove) {
     auto list = Isometry::GenerateTransforms(origMove);
 #if MOVEMANAGER_VERBOSE > MM_LOG_NONE
@@ -809,11 +1260,8 @@ void MoveManager::GenerateMovesFrom(MoveBase* origMove) {
     int dupesAvoided = 0;
 #endif
     for (const auto move: list) {
-        if (std::none_of(_moves.begin(), _moves.end(), [&move](auto& existingMove) {
-            return *existingMove == *dynamic_cast<MoveBase*>(move);
-        })) {
-            _moves.push_back(dynamic_cast<MoveBase*>(move));
-        } else {
+        if (!RegisterSingleMove(dynamic_cast<MoveBase*>(move))) {
+            _redundantMoves++;
 #if MOVEMANAGER_VERBOSE > MM_LOG_NONE
             dupesAvoided++;
 #endif
@@ -823,20 +1271,155 @@ void MoveManager::GenerateMovesFrom(MoveBase* origMove) {
     DEBUG("Registered " << list.size() - dupesAvoided << '/' << list.size() << " generated moves." << std::endl);
     DEBUG("Duplicate moves avoided: " << dupesAvoided << std::endl);
 #endif
-    // Add move to offset map
-    for (auto move : _moves) {
+}
+
+bool MoveManager::RegisterSingleMove(MoveBase *move) {
+    const auto hash = move->Hash();
+    const auto [first, last] = _movesByHash.equal_range(hash);
+    if (const auto found = std::find_if(first, last, [move](const auto& entry) { return *entry.second == *move; });
+        found != last) {
+        if (std::ranges::find(_folderMoves, found->second) == _folderMoves.end()) {
+            _folderMoves.push_back(found->second);
+        }
+        return false;
+    }
+    _movesByHash.emplace(hash, move);
+    _moves.push_back(move);
+    _folderMoves.push_back(move);
+    return true;
+}
+
+void MoveManager::IndexMovesByOffset() {
+    _cacheLegalMoves = std::none_of(_moves.begin(), _moves.end(), [](const MoveBase* move) {
+        return std::any_of(move->propertyChecks.begin(), move->propertyChecks.end(), [](const MovePropertyCheck& check) {
+            return check.IsStatic();
+        });
+    });
+    ClearLegalMoves();
+    for (const auto& offset : _offsets) {
+        _movesByOffset[offset].clear();
+    }
+    _offsets.clear();
+    for (const auto move : _moves) {
         if (_movesByOffset[move->finalPos].empty()) {
             _offsets.push_back(move->finalPos);
         }
         _movesByOffset[move->finalPos].push_back(move);
     }
+    // Give every cell checked by a move a bit in the neighborhood signature
+    std::map<std::vector<int>, int> cellBits;
+    const auto cellBit = [&cellBits](const std::valarray<int>& cell) {
+        return cellBits.try_emplace(std::vector<int>(std::begin(cell), std::end(cell)), cellBits.size()).first->second;
+    };
+    _neighborhoodChecks.clear();
+    for (const auto& offset : _offsets) {
+        auto& checks = _neighborhoodChecks.emplace_back();
+        for (const auto move : _movesByOffset[offset]) {
+            auto& [checkedMove, bits] = checks.emplace_back(move, std::vector<std::pair<int, bool>>());
+            for (const auto& [cell, hasModule] : move->moves) {
+                bits.emplace_back(cellBit(cell), hasModule);
+            }
+        }
+    }
+    _neighborhoodCells.assign(cellBits.size(), {});
+    for (const auto& [cell, bit] : cellBits) {
+        _neighborhoodCells[bit] = std::valarray<int>(cell.data(), cell.size());
+    }
+    _neighborhoodGeneration = 0;
+    _neighborhoodTable.clear();
+#if MOVEMANAGER_NEIGHBORHOOD_TABLE && !MOVEMANAGER_BOUNDS_CHECKS
+    // Small neighborhoods can be tabulated up front, skipping table misses during search
+    const auto signatureBits = _neighborhoodCells.size() + _offsets.size();
+#if MOVEMANAGER_VERBOSE > MM_LOG_NONE
+    DEBUG("Neighborhood signatures use " << signatureBits << " bits." << std::endl);
+#endif
+    if (signatureBits <= MOVEMANAGER_NEIGHBORHOOD_PRECOMPUTE_BITS) {
+        for (std::uint64_t i = 0; i < std::uint64_t{1} << signatureBits; i++) {
+            NeighborhoodSignature signature = {i};
+            _neighborhoodTable.emplace(signature, NeighborhoodMoves(signature));
+        }
+#if MOVEMANAGER_VERBOSE > MM_LOG_NONE
+        DEBUG("Precomputed moves for " << _neighborhoodTable.size() << " neighborhoods." << std::endl);
+#endif
+    }
+#endif
 }
 
-void MoveManager::RegisterSingleMove(MoveBase *move) {
-    _moves.push_back(move);
+std::vector<MoveBase*> MoveManager::FindLegalMoves(const Module& mod) {
+    std::vector<MoveBase*> legalMoves;
+    for (const auto& group : LookupNeighborhood(mod)) {
+        for (const auto move : group) {
+            if (Lattice::ignoreProperties || move->PropertyCheck(mod)) {
+                legalMoves.push_back(move);
+                break;
+            }
+        }
+    }
+    return legalMoves;
+}
+
+std::vector<std::vector<MoveBase*>> MoveManager::NeighborhoodMoves(const NeighborhoodSignature& signature) {
+    const auto bitSet = [&signature](const int bit) {
+        return (signature[bit / 64] >> (bit % 64) & 1) != 0;
+    };
+    std::vector<std::vector<MoveBase*>> groups;
+    for (int i = 0; i < _neighborhoodChecks.size(); i++) {
+        if (bitSet(_neighborhoodCells.size() + i)) continue;
+        std::vector<MoveBase*> passed;
+        for (const auto& [move, bits] : _neighborhoodChecks[i]) {
+            if (std::all_of(bits.begin(), bits.end(), [&bitSet](const auto& bit) { return bitSet(bit.first) == bit.second; })) {
+                passed.push_back(move);
+                // Moves after one without property checks are never reached
+                if (move->propertyChecks.empty()) break;
+            }
+        }
+        if (!passed.empty()) {
+            groups.push_back(std::move(passed));
+        }
+    }
+    return groups;
+}
+
+const std::vector<std::vector<MoveBase*>>& MoveManager::LookupNeighborhood(const Module& mod) {
+    const auto& tensor = Lattice::coordTensor;
+    if (_neighborhoodGeneration != Lattice::Generation()) {
+        _neighborhoodGeneration = Lattice::Generation();
+        _neighborhoodIndexOffsets.clear();
+        for (const auto& cell : _neighborhoodCells) {
+            _neighborhoodIndexOffsets.push_back(tensor.IndexFromCoords(cell));
+        }
+        for (const auto& offset : _offsets) {
+            _neighborhoodIndexOffsets.push_back(tensor.IndexFromCoords(offset));
+        }
+    }
+    // Build signature, free space checks only look at whether a cell holds a module
+    static NeighborhoodSignature signature;
+    const auto cellCount = _neighborhoodCells.size();
+    signature.assign((cellCount + _offsets.size() + 63) / 64, 0);
+    const auto index = tensor.IndexFromCoords(mod.coords);
+    for (int bit = 0; bit < cellCount; bit++) {
+        if (tensor.GetElementDirect(index + _neighborhoodIndexOffsets[bit]) >= 0) {
+            signature[bit / 64] |= std::uint64_t{1} << (bit % 64);
+        }
+    }
+    for (int bit = cellCount; bit < _neighborhoodIndexOffsets.size(); bit++) {
+        if (const auto id = tensor.GetElementDirect(index + _neighborhoodIndexOffsets[bit]); id == OUT_OF_BOUNDS || id >= 0) {
+            signature[bit / 64] |= std::uint64_t{1} << (bit % 64);
+        }
+    }
+    auto entry = _neighborhoodTable.find(signature);
+    if (entry == _neighborhoodTable.end()) {
+        entry = _neighborhoodTable.emplace(signature, NeighborhoodMoves(signature)).first;
+    }
+    return entry->second;
 }
 
 void MoveManager::RegisterAllMoves(const std::string& movePath) {
+    _folderMoves.clear();
+    if (LoadMoveLibrary(movePath)) {
+        _folderMoves.clear();
+        return;
+    }
     nlohmann::json moveJson;
     for (const auto& moveFile : std::filesystem::recursive_directory_iterator(movePath)) {
         if (!moveFile.is_regular_file()) continue;
@@ -869,14 +1452,83 @@ void MoveManager::RegisterAllMoves(const std::string& movePath) {
             }
         }
     }
+    IndexMovesByOffset();
+#if MOVEMANAGER_VERBOSE > MM_LOG_NONE
+    DEBUG("Registered " << _moves.size() << " moves, eliminated " << _redundantMoves << " redundant moves." << std::endl);
+#endif
+    SaveMoveLibrary(movePath, _folderMoves);
+    _folderMoves.clear();
+}
+
+void MoveManager::InvalidateLegalMoves(const std::valarray<int>& coords) {
+#if MOVEMANAGER_LEGAL_MOVE_CACHE && !MOVEMANAGER_BOUNDS_CHECKS
+    if (_legalMovesValid.empty()) return;
+    const auto& tensor = Lattice::coordTensor;
+    if (_legalMoveRangeGeneration != Lattice::Generation()) {
+        _legalMoveRangeGeneration = Lattice::Generation();
+        _legalMoveRangeOffsets.clear();
+        // Walk every offset in the cube of radius MaxDistance() like an odometer
+        std::valarray<int> offset(-_maxDist, Lattice::Order());
+        while (true) {
+            _legalMoveRangeOffsets.push_back(tensor.IndexFromCoords(offset));
+            int axis = 0;
+            while (axis < offset.size() && offset[axis] == _maxDist) {
+                offset[axis++] = -_maxDist;
+            }
+            if (axis == offset.size()) break;
+            offset[axis]++;
+        }
+    }
+    const auto index = tensor.IndexFromCoords(coords);
+    for (const auto rangeOffset : _legalMoveRangeOffsets) {
+        if (const auto id = tensor.GetElementDirect(index + rangeOffset); id >= 0 && id < _legalMovesValid.size()) {
+            _legalMovesValid[id] = false;
+        }
+    }
+#endif
+}
+
+void MoveManager::ClearLegalMoves() {
+    _legalMoves.clear();
+    _legalMovesValid.clear();
 }
 
 #ifndef MOVEMANAGER_CHECK_BY_OFFSET
 #define MOVEMANAGER_CHECK_BY_OFFSET true
 #endif
 std::vector<MoveBase*> MoveManager::CheckAllMoves(CoordTensor<int>& tensor, Module& mod) {
+    PROFILE_SCOPE(PROFILE_CHECK_ALL_MOVES);
     std::vector<MoveBase*> legalMoves = {};
 #if MOVEMANAGER_CHECK_BY_OFFSET
+#if MOVEMANAGER_NEIGHBORHOOD_TABLE && !MOVEMANAGER_BOUNDS_CHECKS && MOVEMANAGER_VERBOSE != MM_LOG_MOVE_CHECKS
+    if (&tensor == &Lattice::coordTensor) {
+#if MOVEMANAGER_LEGAL_MOVE_CACHE
+        const bool cacheable = _cacheLegalMoves && mod.id < ModuleIdManager::MinStaticID();
+        if (cacheable) {
+            if (_legalMovesValid.size() != ModuleIdManager::MinStaticID()) {
+                _legalMoves.resize(ModuleIdManager::MinStaticID());
+                _legalMovesValid.assign(ModuleIdManager::MinStaticID(), false);
+            }
+            if (_legalMovesValid[mod.id]) {
+#if MOVEMANAGER_VERIFY_LEGAL_MOVE_CACHE
+                if (FindLegalMoves(mod) != _legalMoves[mod.id]) {
+                    throw LegalMoveCacheExcept();
+                }
+#endif
+                return _legalMoves[mod.id];
+            }
+        }
+#endif
+        legalMoves = FindLegalMoves(mod);
+#if MOVEMANAGER_LEGAL_MOVE_CACHE
+        if (cacheable) {
+            _legalMoves[mod.id] = legalMoves;
+            _legalMovesValid[mod.id] = true;
+        }
+#endif
+        return legalMoves;
+    }
+#endif
     for (const auto& moveOffset : _offsets) {
         if (const auto id = Lattice::coordTensor[mod.coords + moveOffset]; id == OUT_OF_BOUNDS || id >= 0) continue;
         for (auto move : _movesByOffset[moveOffset]) {
@@ -952,9 +1604,12 @@ bool ParallelMoveCheck(CoordTensor<int>& freeSpace, const Module& mod, const Mov
     return result;
 }
 
-std::vector<std::set<ModuleData>> MoveManager::MakeAllParallelMoves(std::unordered_set<HashedState>& visited) {
+std::vector<StateDelta> MoveManager::MakeAllParallelMoves(VisitedSet& visited) {
+    if (Lattice::NearEdge()) {
+        throw LatticeEdgeExcept();
+    }
     static std::vector<std::vector<Module*>> modsToMove = GenerateFreeModulePowerSet();
-    static CoordTensor<int> freeSpaceInternal(Lattice::Order(), Lattice::AxisSize(), FREE_SPACE);
+    static CoordTensor<int> freeSpaceInternal = Lattice::coordTensor;
     // Might speed things up
     static std::vector<std::unordered_set<MoveBase*>> failedMoves(ModuleIdManager::MinStaticID(), std::unordered_set<MoveBase*>());
     for (auto fails : failedMoves) {
@@ -973,7 +1628,10 @@ std::vector<std::set<ModuleData>> MoveManager::MakeAllParallelMoves(std::unorder
     for (const auto& mod : ModuleIdManager::FreeModules()) {
         Lattice::coordTensor[mod.coords] = mod.id;
     }
-    std::vector<std::set<ModuleData>> adjStates;
+    // Set up local free space tensor to match lattice, each combination restores the cells it marks afterward
+    freeSpaceInternal = Lattice::coordTensor;
+    const HashedState currentState(Lattice::GetModuleInfo());
+    std::vector<StateDelta> adjStates;
     // Iterate over all combinations of movable modules
     for (const auto& mods : modsToMove) {
         if (mods.empty()) continue;
@@ -1075,8 +1733,6 @@ std::vector<std::set<ModuleData>> MoveManager::MakeAllParallelMoves(std::unorder
                 mod->coords -= move->MoveOffset();
             }
             if (duplicate) continue;
-            // Set up local free space tensor to match lattice
-            freeSpaceInternal.FillFromVector(Lattice::coordTensor.GetArrayInternal());
             // Initial setup
             bool success = true;
             for (int i = 0; i < modCount; i++) {
@@ -1084,27 +1740,37 @@ std::vector<std::set<ModuleData>> MoveManager::MakeAllParallelMoves(std::unorder
                 freeSpaceInternal[mods[i]->coords] = OCCUPIED_NO_ANCHOR;
             }
             // mod[i] checks move[i]
-            for (int i = 0; i < modCount; i++) {
-                auto move = _moves[modMoveIndex[i]];
-                auto mod = mods[i];
+            int movesChecked = 0;
+            for (; movesChecked < modCount; movesChecked++) {
+                auto move = _moves[modMoveIndex[movesChecked]];
+                auto mod = mods[movesChecked];
                 if (!ParallelMoveCheck(freeSpaceInternal, *mod, move)) {
                     success = false;
                     break;
                 }
             }
-            if (success) {
-                for (int i = 0; i < modCount; i++) {
-                    auto move = _moves[modMoveIndex[i]];
-                    auto mod = mods[i];
-                    MoveModule(*mod, move);
+            // Restore marked cells, a failed check doesn't mark anything
+            for (int i = 0; i < movesChecked; i++) {
+                const auto move = _moves[modMoveIndex[i]];
+                const auto& coords = mods[i]->coords;
+                for (const auto& moveCheck : move->moves) {
+                    if (moveCheck.second == false) {
+                        freeSpaceInternal[coords + moveCheck.first] = Lattice::coordTensor[coords + moveCheck.first];
+                    }
                 }
-                adjStates.push_back(Lattice::GetModuleInfo());
-                visited.insert(HashedState(Lattice::GetModuleInfo()));
+                freeSpaceInternal[coords + move->MoveOffset()] = Lattice::coordTensor[coords + move->MoveOffset()];
+            }
+            for (int i = 0; i < modCount; i++) {
+                freeSpaceInternal[mods[i]->coords] = Lattice::coordTensor[mods[i]->coords];
+            }
+            if (success) {
+                std::vector<std::pair<Module*, const MoveBase*>> steps;
+                steps.reserve(modCount);
                 for (int i = 0; i < modCount; i++) {
-                    auto move = _moves[modMoveIndex[i]];
-                    auto mod = mods[i];
-                    UnMoveModule(*mod, move);
+                    steps.emplace_back(mods[i], _moves[modMoveIndex[i]]);
                 }
+                adjStates.push_back(MakeDelta(steps));
+                visited.insert(HashedState(currentState, adjStates.back()));
             }
         }
     }
@@ -1112,6 +1778,7 @@ std::vector<std::set<ModuleData>> MoveManager::MakeAllParallelMoves(std::unorder
 }
 
 std::vector<MoveBase*> MoveManager::CheckAllMovesAndConnectivity(CoordTensor<int>& tensor, Module& mod) {
+    PROFILE_SCOPE(PROFILE_CHECK_ALL_MOVES);
     std::vector<MoveBase*> legalMoves = {};
 #if MOVEMANAGER_CHECK_BY_OFFSET
     for (const auto& moveOffset : _offsets) {
@@ -1200,7 +1867,7 @@ std::vector<std::pair<Module*, MoveBase*>> MoveManager::FindParallelMovesToState
     for (auto id : candidates) {
         mods.push_back(&ModuleIdManager::GetModule(id));
     }
-    static CoordTensor<int> freeSpaceInternal(Lattice::Order(), Lattice::AxisSize(), FREE_SPACE);
+    static CoordTensor<int> freeSpaceInternal = Lattice::coordTensor;
     std::vector<std::pair<Module*, MoveBase*>> parallelMoves;
     // Might speed things up
     static std::vector<std::unordered_set<MoveBase*>> failedMoves(ModuleIdManager::MinStaticID(), std::unordered_set<MoveBase*>());
@@ -1277,7 +1944,7 @@ std::vector<std::pair<Module*, MoveBase*>> MoveManager::FindParallelMovesToState
             continue;
         }
         // Set up local free space tensor to match lattice
-        freeSpaceInternal.FillFromVector(Lattice::coordTensor.GetArrayInternal());
+        freeSpaceInternal = Lattice::coordTensor;
         // Initial setup
         bool success = true;
         for (int i = 0; i < modCount; i++) {
@@ -1320,7 +1987,61 @@ std::vector<std::pair<Module*, MoveBase*>> MoveManager::FindParallelMovesToState
     return parallelMoves;
 }
 
+std::vector<std::pair<Module*, const MoveBase*>> MoveManager::FindInverseMoves(const std::span<const ModuleMove> moves) {
+    std::vector<Module*> movedModules;
+    movedModules.reserve(moves.size());
+    for (const auto& [from, move] : moves) {
+        const std::valarray<int> to = from + move->MoveOffset();
+        movedModules.push_back(&ModuleIdManager::GetModule(Lattice::coordTensor[to]));
+    }
+    std::vector<std::pair<Module*, const MoveBase*>> inverseMoves;
+    inverseMoves.reserve(moves.size());
+    for (size_t i = 0; i < moves.size(); i++) {
+        // Moves made together are undone together, so the other moving modules are out of the way
+        for (const auto mod : movedModules) {
+            if (mod != movedModules[i]) {
+                Lattice::coordTensor[mod->coords] = FREE_SPACE;
+            }
+        }
+        const MoveBase* inverse = nullptr;
+        const std::valarray<int> offset = -moves[i].move->MoveOffset();
+        for (const auto move : _movesByOffset[offset]) {
+            if (move->MoveCheck(Lattice::coordTensor, *movedModules[i])) {
+                inverse = move;
+                break;
+            }
+        }
+        for (const auto mod : movedModules) {
+            Lattice::coordTensor[mod->coords] = mod->id;
+        }
+        if (inverse == nullptr) {
+            return {};
+        }
+        inverseMoves.emplace_back(movedModules[i], inverse);
+    }
+    return inverseMoves;
+}
+
 const int MoveManager::MaxDistance() {
     return _maxDist;
 }
 
+const std::vector<MoveBase*>& MoveManager::Moves() {
+    return _moves;
+}
+
+std::size_t MoveManager::MoveSetHash() {
+    std::vector<std::size_t> hashes;
+    hashes.reserve(_moves.size());
+    for (const auto move : _moves) {
+        auto hash = move->Hash();
+        for (const auto& [animType, offset] : move->animSequence) {
+            boost::hash_combine(hash, animType);
+            boost::hash_combine(hash, boost::hash_range(std::begin(offset), std::end(offset)));
+        }
+        hashes.push_back(hash);
+    }
+    std::ranges::sort(hashes);
+    return boost::hash_range(hashes.begin(), hashes.end());
+}
+
@@ -2,8 +2,11 @@
 #define MODULAR_ROBOTICS_MOVEMANAGER_H
 
 #include <vector>
+#include <span>
 #include <unordered_map>
 #include <valarray>
+#include <cstdint>
+#include <boost/functional/hash.hpp>
 #include <nlohmann/json.hpp>
 #include "../lattice/Lattice.h"
 #include "Isometry.h"
@@ -28,6 +31,53 @@
 #ifndef MOVEMANAGER_BOUNDS_CHECKS
 #define MOVEMANAGER_BOUNDS_CHECKS false
 #endif
+/* Neighborhood Table Configuration
+ * true: CheckAllMoves finds moves whose free space checks pass from a table keyed by the occupancy of every cell a move
+ *       can look at around a module, the table is filled as new neighborhoods are seen (unused with bounds checks on)
+ * false: CheckAllMoves runs every move check
+ */
+#ifndef MOVEMANAGER_NEIGHBORHOOD_TABLE
+#define MOVEMANAGER_NEIGHBORHOOD_TABLE true
+#endif
+/* Legal Move Cache Configuration
+ * true: CheckAllMoves keeps each module's legal moves until a module is moved or updated within MaxDistance() of it
+ *       (only used along with the neighborhood table)
+ * false: CheckAllMoves finds every module's legal moves from scratch
+ */
+#ifndef MOVEMANAGER_LEGAL_MOVE_CACHE
+#define MOVEMANAGER_LEGAL_MOVE_CACHE true
+#endif
+/* Legal Move Cache Verification Configuration
+ * true: Legal moves taken from the cache are compared with a fresh computation, throwing LegalMoveCacheExcept if they
+ *       don't match
+ */
+#ifndef MOVEMANAGER_VERIFY_LEGAL_MOVE_CACHE
+#define MOVEMANAGER_VERIFY_LEGAL_MOVE_CACHE false
+#endif
+/* Neighborhood Table Precompute Configuration
+ * Neighborhoods described by at most this many bits are all added to the table when moves are registered
+ */
+#ifndef MOVEMANAGER_NEIGHBORHOOD_PRECOMPUTE_BITS
+#define MOVEMANAGER_NEIGHBORHOOD_PRECOMPUTE_BITS 16
+#endif
+/* Move Library Cache Configuration
+ * Directory that expanded move libraries are written to and loaded from, a library is reused when the move definitions
+ * and lattice order match the run that wrote it. Set to "" to always generate moves from their definitions.
+ */
+#ifndef MOVEMANAGER_LIBRARY_CACHE
+#if __EMSCRIPTEN__
+#define MOVEMANAGER_LIBRARY_CACHE ""
+#else
+#define MOVEMANAGER_LIBRARY_CACHE "Move Cache/"
+#endif
+#endif
+
+// Thrown when legal moves taken from the cache don't match a fresh computation, see MOVEMANAGER_VERIFY_LEGAL_MOVE_CACHE
+class LegalMoveCacheExcept final : public std::exception {
+public:
+    [[nodiscard]]
+    const char* what() const noexcept override;
+};
 
 namespace Move {
     enum State {
@@ -161,6 +211,7 @@ class MovePropertyCheck : public ITransformable {
 private:
     std::valarray<int> modOffset;
     std::string propertyName;
+    std::string functionName;
     PropertyFunctionType functionType;
     PropertyFunction propertyFunction;
     nlohmann::basic_json<> args;
@@ -170,11 +221,21 @@ private:
     std::vector<int> reflectArgIndices;
     bool invertReflection;
     bool reflectOnNormalRotation;
+    // ID of this check registered with ModuleProperties, -1 until first evaluated or after args are transformed
+    mutable int checkId = -1;
 public:
     MovePropertyCheck(const nlohmann::basic_json<>& propertyCheckDef);
 
     bool DoCheck(const std::valarray<int>& checkFromPosition) const;
 
+    // Static checks don't look at any module, so their result can change without the lattice changing
+    [[nodiscard]]
+    bool IsStatic() const;
+
+    // Get a definition that constructs this check as it is now, including any transformations made to it
+    [[nodiscard]]
+    nlohmann::basic_json<> ToJson() const;
+
     MovePropertyCheck* MakeCopy() const override;
 
     void Rotate(int a, int b) override;
@@ -186,6 +247,7 @@ class MovePropertyUpdate : public ITransformable {
 private:
     std::valarray<int> modOffset;
     std::string propertyName;
+    std::string functionName;
     PropertyFunctionType functionType;
     PropertyFunction propertyFunction;
     nlohmann::basic_json<> args;
@@ -195,11 +257,21 @@ private:
     std::vector<int> reflectArgIndices;
     bool invertReflection;
     bool reflectOnNormalRotation;
+    // ID of this update registered with ModuleProperties, -1 until first applied or after args are transformed
+    mutable int updateId = -1;
 public:
     MovePropertyUpdate(const nlohmann::basic_json<>& propertyUpdateDef);
 
     void DoUpdate(const std::valarray<int>& updateFromPosition) const;
 
+    // Get ID of the module that would be updated, or -1 if the update doesn't target a module
+    [[nodiscard]]
+    int UpdateTarget(const std::valarray<int>& updateFromPosition) const;
+
+    // Get a definition that constructs this update as it is now, including any transformations made to it
+    [[nodiscard]]
+    nlohmann::basic_json<> ToJson() const;
+
     MovePropertyUpdate* MakeCopy() const override;
 
     void Rotate(int a, int b) override;
@@ -219,6 +291,11 @@ protected:
     std::vector<std::pair<int, int>> bounds;
     std::valarray<int> initPos, finalPos;
     std::vector<std::pair<Move::AnimType, std::valarray<int>>> animSequence;
+
+    // Get check cells sorted by offset and property check definitions sorted by text, so that moves generated from
+    // different definitions compare equal whatever order their checks were written in
+    [[nodiscard]]
+    std::pair<std::vector<std::pair<std::vector<int>, bool>>, std::vector<std::string>> CanonicalChecks() const;
 public:
     // Load in move info from a given JSON move definition
     virtual void InitMove(const nlohmann::basic_json<>& moveDef) = 0;
@@ -228,8 +305,14 @@ public:
     virtual bool FreeSpaceCheck(const CoordTensor<int>& tensor, const std::valarray<int>& coords);
     // Check to see if move is possible from a given position assuming some non-static modules would help
     virtual bool FreeSpaceCheckHelpLimit(const CoordTensor<int>& tensor, const std::valarray<int>& coords, const CoordTensor<int>& helpTensor, int help);
+    // Check to see if property checks are satisfied for a given module
+    [[nodiscard]]
+    bool PropertyCheck(const Module& mod) const;
     // Apply updates to a module's properties based on the move
     void ApplyUpdates(const Module& mod) const;
+    // Get IDs of other modules whose properties would be updated by the move
+    [[nodiscard]]
+    std::vector<int> UpdatedModules(const Module& mod) const;
 
     [[nodiscard]]
     MoveBase* MakeCopy() const override = 0;
@@ -244,6 +327,10 @@ public:
     [[nodiscard]]
     const std::vector<std::pair<Move::AnimType, std::valarray<int>>>& AnimSequence() const;
 
+    // Get hash of the move's final offset, check cells and property checks, equal moves always have equal hashes
+    [[nodiscard]]
+    std::size_t Hash() const;
+
     virtual bool operator==(const MoveBase& rhs) const;
 
     friend class MoveManager;
@@ -279,8 +366,66 @@ private:
     static std::vector<MoveBase*> _movesToFree;
     // Vector containing all move offsets
     static std::vector<std::valarray<int>> _offsets;
+    // Map from move hash to registered moves with that hash, used to avoid registering duplicate moves
+    static std::unordered_multimap<std::size_t, MoveBase*> _movesByHash;
+    // Number of generated moves that duplicated an already registered move
+    static int _redundantMoves;
+    // Moves defined by the move folder being registered, including ones equal to moves another folder registered first
+    static std::vector<MoveBase*> _folderMoves;
+
+    // One bit per cell in _neighborhoodCells, set if a module is there, then one bit per offset in _offsets, set if the
+    // destination is occupied or out of bounds
+    using NeighborhoodSignature = std::vector<std::uint64_t>;
+    // Every cell a move can check, relative to the moving module
+    static std::vector<std::valarray<int>> _neighborhoodCells;
+    // Coordinate tensor index offsets of _neighborhoodCells then _offsets, and the lattice generation they were
+    // calculated for
+    static std::vector<int> _neighborhoodIndexOffsets;
+    static std::size_t _neighborhoodGeneration;
+    // For each offset in _offsets, the moves with that offset and the signature bits they need set (true) or clear
+    static std::vector<std::vector<std::pair<MoveBase*, std::vector<std::pair<int, bool>>>>> _neighborhoodChecks;
+    // Map from neighborhood signature to the moves that pass their free space checks there, one list per reachable
+    // offset in _offsets order, each list ending at the first move without property checks
+    static std::unordered_map<NeighborhoodSignature, std::vector<std::vector<MoveBase*>>,
+            boost::hash<NeighborhoodSignature>> _neighborhoodTable;
+
+    // Legal moves last found for each non-static module, indexed by ID
+    static std::vector<std::vector<MoveBase*>> _legalMoves;
+    // Whether each entry of _legalMoves still matches the lattice
+    static std::vector<bool> _legalMovesValid;
+    // Whether legal moves can be cached, false if any move has a static property check
+    static bool _cacheLegalMoves;
+    // Coordinate tensor index offsets of every cell within MaxDistance() of a module, and the lattice generation they
+    // were calculated for
+    static std::vector<int> _legalMoveRangeOffsets;
+    static std::size_t _legalMoveRangeGeneration;
+    // Set while moves are made and reversed without leaving the lattice changed, so cached legal moves stay valid and
+    // the lattice revision is kept
+    static bool _holdLegalMoves;
     // Int representing maximum (Chebyshev) distance a move can cover
     static int _maxDist;
+
+    // Get path of the cached move library for a move folder and lattice order
+    static std::string MoveLibraryPath(const std::string& movePath, int order);
+
+    // Register every move in the cached move library for a move folder, returns false if the library is missing,
+    // outdated or damaged
+    static bool LoadMoveLibrary(const std::string& movePath);
+
+    // Write the moves defined by a move folder to its cached move library
+    static void SaveMoveLibrary(const std::string& movePath, std::span<MoveBase* const> moves);
+
+    // Fill the offset map and neighborhood table from every registered move, call once after all moves are registered
+    static void IndexMovesByOffset();
+
+    // Get the moves that pass their free space checks in a neighborhood, grouped like the neighborhood table
+    static std::vector<std::vector<MoveBase*>> NeighborhoodMoves(const NeighborhoodSignature& signature);
+
+    // Get the neighborhood table entry for a module's neighborhood in the lattice, adding it if it's new
+    static const std::vector<std::vector<MoveBase*>>& LookupNeighborhood(const Module& mod);
+
+    // Get what moves can be made by a module using the neighborhood table, without using cached legal moves
+    static std::vector<MoveBase*> FindLegalMoves(const Module& mod);
 public:
     // Never instantiate MoveManager
     MoveManager() = delete;
@@ -298,18 +443,31 @@ public:
     // Reverse a move
     static void UnMoveModule(Module& mod, const MoveBase* move);
 
+    // Get the change in state caused by making a set of moves, without leaving the lattice changed
+    static StateDelta MakeDelta(std::span<const std::pair<Module*, const MoveBase*>> moves);
+
+    // Make a set of recorded moves, returns the modules that were moved
+    static std::vector<Module*> MakeMoves(std::span<const ModuleMove> moves);
+
     // Generate multiple moves from a single move definition
     static void GenerateMovesFrom(MoveBase* origMove);
 
-    // Register a move without generating additional moves
-    static void RegisterSingleMove(MoveBase* move);
+    // Register a move without generating additional moves, returns false if an equal move was already registered
+    static bool RegisterSingleMove(MoveBase* move);
 
+    // Register every move defined in a move folder, then build the offset map
     static void RegisterAllMoves(const std::string& movePath = "Moves/");
 
+    // Mark cached legal moves as outdated for every module within MaxDistance() of a changed lattice cell
+    static void InvalidateLegalMoves(const std::valarray<int>& coords);
+
+    // Mark every cached legal move list as outdated
+    static void ClearLegalMoves();
+
     // Get what moves can be made by a module
     static std::vector<MoveBase*> CheckAllMoves(CoordTensor<int>& tensor, Module& mod);
 
-    static std::vector<std::set<ModuleData>> MakeAllParallelMoves(std::unordered_set<HashedState>& visited);
+    static std::vector<StateDelta> MakeAllParallelMoves(VisitedSet& visited);
 
     static std::vector<MoveBase*> CheckAllMovesAndConnectivity(CoordTensor<int>& tensor, Module& mod);
 
@@ -319,9 +477,19 @@ public:
     // Get a vector of pairs of modules to move and moves to make in order to reach an adjacent state
     static std::vector<std::pair<Module*, MoveBase*>> FindParallelMovesToState(const std::set<ModuleData>& modData);
 
+    // Get the moves that undo a set of recorded moves, the lattice must be in the state the recorded moves lead to,
+    // returns an empty vector if any of them can't be undone
+    static std::vector<std::pair<Module*, const MoveBase*>> FindInverseMoves(std::span<const ModuleMove> moves);
+
     // Get maximum Chebyshev distance a move can cover
     static const int MaxDistance();
 
+    // Get every registered move
+    static const std::vector<MoveBase*>& Moves();
+
+    // Hash of every registered move and its animation, independent of the order moves were registered in
+    static std::size_t MoveSetHash();
+
     friend class MoveOffsetHeuristicCache;
 
     friend class MoveOffsetPropertyHeuristicCache;
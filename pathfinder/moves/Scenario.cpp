@@ -2,7 +2,8 @@
 #include <iostream>
 #include <fstream>
 #include <queue>
-#include <boost/format.hpp>
+#include <charconv>
+#include <filesystem>
 #include "../modules/ModuleManager.h"
 #include "MoveManager.h"
 #include "../coordtensor/CoordTensor.h"
@@ -41,73 +42,401 @@ std::string Scenario::TryGetScenType(const std::string &initialFile) {
     return "CUBE";
 }
 
+namespace Scenario {
+    constexpr char SCENB_MAGIC[4] = {'S', 'C', 'N', 'B'};
+
+    constexpr std::uint8_t SCENB_VERSION = 1;
+
+    // Move record tags used by .scenb files
+    enum ScenbRecord : std::uint8_t {
+        ANIM = 0,
+        ANIM_CHECKPOINT = 1,
+        END_STEP = 2
+    };
+
+    struct PaletteEntry {
+        int color;
+        int red;
+        int green;
+        int blue;
+    };
+
+    struct ModuleEntry {
+        // Color for colored modules, otherwise 1 for static modules and 0 for non-static modules
+        int colorOrStatic;
+        int x, y, z;
+    };
+
+    // Shared interface for text and binary scenario output, both are buffered and only flushed when the buffer fills
+    class IScenWriter {
+    protected:
+        static constexpr std::size_t BUFFER_SIZE = 1 << 16;
+
+        std::ostream& os;
+
+        std::string buffer;
+
+        void FlushIfFull() {
+            if (buffer.size() >= BUFFER_SIZE) {
+                Flush();
+            }
+        }
+    public:
+        explicit IScenWriter(std::ostream& os) : os(os) {
+            buffer.reserve(BUFFER_SIZE + 256);
+        }
+
+        virtual void Header(const std::string& name, const std::string& desc, const std::string& type) = 0;
+
+        virtual void Palette(const std::vector<PaletteEntry>& palette) = 0;
+
+        virtual void Modules(const std::vector<ModuleEntry>& modules) = 0;
+
+        virtual void Anim(bool checkpoint, int id, int type, int x, int y, int z) = 0;
+
+        virtual void EndStep() = 0;
+
+        void Flush() {
+            os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+
+        virtual ~IScenWriter() = default;
+    };
+
+    class TextScenWriter final : public IScenWriter {
+    private:
+        std::size_t idLen = 1;
+
+        void PutInt(const int value) {
+            char digits[12];
+            const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            buffer.append(digits, result.ptr);
+        }
+
+        void PutId(const int id) {
+            char digits[12];
+            const auto result = std::to_chars(digits, digits + sizeof(digits), id);
+            if (const std::size_t len = result.ptr - digits; len < idLen) {
+                buffer.append(idLen - len, '0');
+            }
+            buffer.append(digits, result.ptr);
+        }
+    public:
+        using IScenWriter::IScenWriter;
+
+        void Header(const std::string& name, const std::string& desc, const std::string& type) override {
+            buffer.append(name).append("\n").append(desc).append("\n").append(type).append("\n\n");
+        }
+
+        void Palette(const std::vector<PaletteEntry>& palette) override {
+            for (const auto& [color, red, green, blue] : palette) {
+                PutInt(color);
+                buffer.append(", ");
+                PutInt(red);
+                buffer.append(", ");
+                PutInt(green);
+                buffer.append(", ");
+                PutInt(blue);
+                buffer.append(", 90\n");
+            }
+            buffer.append("\n");
+            FlushIfFull();
+        }
+
+        void Modules(const std::vector<ModuleEntry>& modules) override {
+            idLen = std::to_string(modules.size()).size();
+            for (int id = 0; id < modules.size(); id++) {
+                const auto& [colorOrStatic, x, y, z] = modules[id];
+                PutId(id);
+                buffer.append(", ");
+                PutInt(colorOrStatic);
+                buffer.append(", ");
+                PutInt(x);
+                buffer.append(", ");
+                PutInt(y);
+                buffer.append(", ");
+                PutInt(z);
+                buffer.append("\n");
+                FlushIfFull();
+            }
+            buffer.append("\n");
+        }
+
+        void Anim(const bool checkpoint, const int id, const int type, const int x, const int y, const int z) override {
+            buffer.push_back(checkpoint ? '*' : ' ');
+            PutId(id);
+            buffer.append(", ");
+            PutInt(type);
+            buffer.append(", ");
+            PutInt(x);
+            buffer.append(", ");
+            PutInt(y);
+            buffer.append(", ");
+            PutInt(z);
+            buffer.append("\n");
+            FlushIfFull();
+        }
+
+        void EndStep() override {
+            buffer.append("\n");
+        }
+    };
+
+    /* .scenb layout, all integers little-endian:
+     * Header:      "SCNB", u8 version, then name, description and module type as (u32 length, bytes)
+     * Palette:     u32 count, then (i32 color, u8 red, u8 green, u8 blue) per entry
+     * Modules:     u32 count, then (i32 color or static flag, i32 x, i32 y, i32 z) per module, indexed by ID
+     * Moves:       records until end of file, each starting with a u8 tag:
+     *              ANIM / ANIM_CHECKPOINT: u32 module ID, i16 animation type, i8 x, i8 y, i8 z
+     *              END_STEP: no payload, marks the end of a group of simultaneous animations
+     */
+    class BinaryScenWriter final : public IScenWriter {
+    private:
+        template<typename T>
+        void Put(const T value) {
+            auto bits = static_cast<std::make_unsigned_t<T>>(value);
+            for (std::size_t i = 0; i < sizeof(T); i++) {
+                buffer.push_back(static_cast<char>(bits & 0xFF));
+                bits >>= 8;
+            }
+        }
+
+        void PutString(const std::string& str) {
+            Put<std::uint32_t>(str.size());
+            buffer.append(str);
+        }
+    public:
+        using IScenWriter::IScenWriter;
+
+        void Header(const std::string& name, const std::string& desc, const std::string& type) override {
+            buffer.append(SCENB_MAGIC, sizeof(SCENB_MAGIC));
+            Put<std::uint8_t>(SCENB_VERSION);
+            PutString(name);
+            PutString(desc);
+            PutString(type);
+        }
+
+        void Palette(const std::vector<PaletteEntry>& palette) override {
+            Put<std::uint32_t>(palette.size());
+            for (const auto& [color, red, green, blue] : palette) {
+                Put<std::int32_t>(color);
+                Put<std::uint8_t>(red);
+                Put<std::uint8_t>(green);
+                Put<std::uint8_t>(blue);
+            }
+            FlushIfFull();
+        }
+
+        void Modules(const std::vector<ModuleEntry>& modules) override {
+            Put<std::uint32_t>(modules.size());
+            for (const auto& [colorOrStatic, x, y, z] : modules) {
+                Put<std::int32_t>(colorOrStatic);
+                Put<std::int32_t>(x);
+                Put<std::int32_t>(y);
+                Put<std::int32_t>(z);
+                FlushIfFull();
+            }
+        }
+
+        void Anim(const bool checkpoint, const int id, const int type, const int x, const int y, const int z) override {
+            Put<std::uint8_t>(checkpoint ? ANIM_CHECKPOINT : ANIM);
+            Put<std::uint32_t>(id);
+            Put<std::int16_t>(type);
+            Put<std::int8_t>(x);
+            Put<std::int8_t>(y);
+            Put<std::int8_t>(z);
+            FlushIfFull();
+        }
+
+        void EndStep() override {
+            Put<std::uint8_t>(END_STEP);
+        }
+    };
+
+    class BinaryScenReader {
+    private:
+        std::istream& is;
+
+        template<typename T>
+        T Get() {
+            std::make_unsigned_t<T> bits = 0;
+            for (std::size_t i = 0; i < sizeof(T); i++) {
+                const auto byte = is.get();
+                if (byte == std::char_traits<char>::eof()) {
+                    throw std::ios_base::failure("Unexpected end of .scenb file");
+                }
+                bits |= static_cast<std::make_unsigned_t<T>>(static_cast<std::uint8_t>(byte)) << (8 * i);
+            }
+            return static_cast<T>(bits);
+        }
+
+        std::string GetString() {
+            std::string str(Get<std::uint32_t>(), '\0');
+            if (!is.read(str.data(), static_cast<std::streamsize>(str.size()))) {
+                throw std::ios_base::failure("Unexpected end of .scenb file");
+            }
+            return str;
+        }
+    public:
+        explicit BinaryScenReader(std::istream& is) : is(is) {}
+
+        // Replay the contents of a .scenb file into another writer
+        void CopyTo(IScenWriter& writer) {
+            char magic[sizeof(SCENB_MAGIC)];
+            if (!is.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), SCENB_MAGIC) || Get<std::uint8_t>() != SCENB_VERSION) {
+                throw std::ios_base::failure("Not a supported .scenb file");
+            }
+            auto name = GetString();
+            auto desc = GetString();
+            auto type = GetString();
+            writer.Header(name, desc, type);
+            std::vector<PaletteEntry> palette(Get<std::uint32_t>());
+            for (auto& entry : palette) {
+                entry.color = Get<std::int32_t>();
+                entry.red = Get<std::uint8_t>();
+                entry.green = Get<std::uint8_t>();
+                entry.blue = Get<std::uint8_t>();
+            }
+            writer.Palette(palette);
+            std::vector<ModuleEntry> modules(Get<std::uint32_t>());
+            for (auto& entry : modules) {
+                entry.colorOrStatic = Get<std::int32_t>();
+                entry.x = Get<std::int32_t>();
+                entry.y = Get<std::int32_t>();
+                entry.z = Get<std::int32_t>();
+            }
+            writer.Modules(modules);
+            for (auto tag = is.get(); tag != std::char_traits<char>::eof(); tag = is.get()) {
+                if (tag == END_STEP) {
+                    writer.EndStep();
+                    continue;
+                }
+                if (tag != ANIM && tag != ANIM_CHECKPOINT) {
+                    throw std::ios_base::failure("Unknown record tag in .scenb file");
+                }
+                const auto id = static_cast<int>(Get<std::uint32_t>());
+                const int animType = Get<std::int16_t>();
+                const int x = Get<std::int8_t>();
+                const int y = Get<std::int8_t>();
+                const int z = Get<std::int8_t>();
+                writer.Anim(tag == ANIM_CHECKPOINT, id, animType, x, y, z);
+            }
+            writer.Flush();
+        }
+    };
+
+    void Export(const std::vector<const Configuration*>& path, const ScenInfo& scenInfo, IScenWriter& writer);
+}
+
 void Scenario::ExportToScenFile(const std::vector<const Configuration*>& path, const ScenInfo& scenInfo) {
+    const bool binary = std::filesystem::path(scenInfo.exportFile).extension() == ".scenb";
     std::ofstream file;
-    file.open(scenInfo.exportFile);
+    file.open(scenInfo.exportFile, binary ? std::ios::out | std::ios::binary : std::ios::out);
     if (!file.is_open()) {
         std::cerr << "Unable to open file " << scenInfo.exportFile << std::endl;
         throw std::ios_base::failure("Unable to open file " + scenInfo.exportFile + "\n");
     }
-    ExportToScen(path, scenInfo, file);
+    if (binary) {
+        ExportToScenb(path, scenInfo, file);
+    } else {
+        ExportToScen(path, scenInfo, file);
+    }
     file.close();
 }
 
 void Scenario::ExportToScen(const std::vector<const Configuration*>& path, const ScenInfo& scenInfo, std::ostream& os) {
+    TextScenWriter writer(os);
+    Export(path, scenInfo, writer);
+}
+
+void Scenario::ExportToScenb(const std::vector<const Configuration*>& path, const ScenInfo& scenInfo, std::ostream& os) {
+    BinaryScenWriter writer(os);
+    Export(path, scenInfo, writer);
+}
+
+void Scenario::ConvertScenbToScen(const std::string& scenbFile, const std::string& scenFile) {
+    std::ifstream in(scenbFile, std::ios::in | std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Unable to open file " << scenbFile << std::endl;
+        throw std::ios_base::failure("Unable to open file " + scenbFile + "\n");
+    }
+    std::ofstream out(scenFile);
+    if (!out.is_open()) {
+        std::cerr << "Unable to open file " << scenFile << std::endl;
+        throw std::ios_base::failure("Unable to open file " + scenFile + "\n");
+    }
+    TextScenWriter writer(out);
+    BinaryScenReader(in).CopyTo(writer);
+}
+
+void Scenario::Export(const std::vector<const Configuration*>& path, const ScenInfo& scenInfo, IScenWriter& writer) {
     if (path.empty()) {
         std::cerr << "Tried to export empty path, no good!" << std::endl;
         return;
     }
-    os << scenInfo.scenName << std::endl << scenInfo.scenDesc << std::endl;
 #if LATTICE_OLD_EDGECHECK
 #if LATTICE_RD_EDGECHECK
-    os << "RHOMBIC_DODECAHEDRON\n\n";
+    writer.Header(scenInfo.scenName, scenInfo.scenDesc, "RHOMBIC_DODECAHEDRON");
 #else
-    os << "CUBE\n\n";
+    writer.Header(scenInfo.scenName, scenInfo.scenDesc, "CUBE");
 #endif
 #else
-    os << scenInfo.scenType << std::endl << std::endl;
+    writer.Header(scenInfo.scenName, scenInfo.scenDesc, scenInfo.scenType);
 #endif
+    std::vector<PaletteEntry> palette;
     if (Lattice::ignoreProperties) {
-        os << "0, 255, 255, 255, 90\n";
-        os << "1, 255, 255, 255, 90\n\n";
+        palette.push_back({0, 255, 255, 255});
+        palette.push_back({1, 255, 255, 255});
     } else {
         std::cout << "\tBuilding color palette...   ";
         for (auto color: ModuleProperties::CallFunction<const std::unordered_set<int>&>("Palette")) {
             Colors::ColorsRGB rgb(color);
-            os << color << ", " << rgb.red << ", " << rgb.green << ", " << rgb.blue << ", 90\n";
+            palette.push_back({color, rgb.red, rgb.green, rgb.blue});
         }
-        os << "\n";
         std::cout << "Done." << std::endl;
     }
-    std::cout << "\tSetting up formatting...   ";
-    auto idLen = std::to_string(ModuleIdManager::Modules().size()).size();
-    boost::format padding("%s%%0%dd, %s");
-    boost::format modDef((padding % "%s" % idLen % "%d, %d, %d, %d").str());
-    std::cout << "Done." << std::endl << "\tResetting lattice to initial state...   ";
+    writer.Palette(palette);
+    std::cout << "\tResetting lattice to initial state...   ";
     Lattice::UpdateFromModuleInfo(path[0]->GetModData());
     std::cout << "Done." << std::endl << "\tExporting initial state...   ";
-    for (size_t id = 0; id < ModuleIdManager::Modules().size(); id++) {
-        auto& mod = ModuleIdManager::Modules()[id];
+    std::vector<ModuleEntry> modules;
+    modules.reserve(ModuleIdManager::Modules().size());
+    for (const auto& mod : ModuleIdManager::Modules()) {
         auto coords = mod.coords - LatticeSetup::preInitData.fullOffset;
         if (Lattice::ignoreProperties) {
-            modDef % "" % id % (mod.moduleStatic ? 1 : 0) % coords[0] % coords[1] % (coords.size() > 2
-                    ? coords[2]
-                    : 0);
+            modules.push_back({mod.moduleStatic ? 1 : 0, coords[0], coords[1], coords.size() > 2 ? coords[2] : 0});
         } else {
-            modDef % "" % id % (mod.properties.Find(COLOR_PROP_NAME))->CallFunction<int>("GetColorInt") % coords[0] %
-                    coords[1] % (coords.size() > 2 ? coords[2] : 0);
+            modules.push_back({(mod.properties.Find(COLOR_PROP_NAME))->CallFunction<int>("GetColorInt"),
+                    coords[0], coords[1], coords.size() > 2 ? coords[2] : 0});
         }
-        os << modDef.str() << std::endl;
     }
-    os << std::endl;
+    writer.Modules(modules);
     std::cout << "Done." << std::endl << "\tExporting moves...   ";
 #if CONFIG_PARALLEL_MOVES
     std::vector<std::queue<std::pair<Move::AnimType, std::valarray<int>>>> parallelAnimQueues(ModuleIdManager::MinStaticID());
 #endif
     for (size_t i = 1; i < path.size(); i++) {
         bool checkpoint = true;
+        // Every step of a search path has its moves recorded, only paths put together elsewhere (like LocateAndFree's)
+        // have steps that need to be searched for
+        const bool recorded = path[i]->GetParent() == path[i - 1] && !path[i]->GetMoves().empty();
 #if CONFIG_PARALLEL_MOVES
-        auto parallelMoves = MoveManager::FindParallelMovesToState(path[i]->GetModData());
+        std::vector<std::pair<Module*, const MoveBase*>> parallelMoves;
+        if (recorded) {
+            const auto& moves = path[i]->GetMoves();
+            const auto movedModules = MoveManager::MakeMoves(moves);
+            for (size_t j = 0; j < moves.size(); j++) {
+                parallelMoves.emplace_back(movedModules[j], moves[j].move);
+            }
+        } else {
+            for (auto [mod, move] : MoveManager::FindParallelMovesToState(path[i]->GetModData())) {
+                parallelMoves.emplace_back(mod, move);
+            }
+            for (auto [mod, move] : parallelMoves) {
+                MoveManager::MoveModule(*mod, move);
+            }
+        }
         // Enqueue move animations
         int animsToExport = 0;
         for (auto [mod, move] : parallelMoves) {
@@ -121,32 +450,37 @@ void Scenario::ExportToScen(const std::vector<const Configuration*>& path, const
             for (int id = 0; id < ModuleIdManager::MinStaticID(); id++) {
                 if (parallelAnimQueues[id].empty()) continue;
                 auto [type, offset] = parallelAnimQueues[id].front();
-                modDef % (checkpoint ? '*' : ' ') % id % type % offset[0] % offset[1] % offset[2];
-                os << modDef.str() << std::endl;
+                writer.Anim(checkpoint, id, type, offset[0], offset[1], offset[2]);
                 checkpoint = false;
                 parallelAnimQueues[id].pop();
                 animsToExport--;
             }
-            os << std::endl;
-        }
-        // Make moves
-        for (auto [mod, move] : parallelMoves) {
-            MoveManager::MoveModule(*mod, move);
+            writer.EndStep();
         }
 #else
-        auto [movingModule, move] = MoveManager::FindMoveToState(path[i]->GetModData());
-        if (move == nullptr) {
-            std::cout << "Failed to generate scenario file, no move to next state found.\n";
-            return;
+        const Module* modToMove;
+        const MoveBase* move;
+        if (recorded) {
+            move = path[i]->GetMoves().front().move;
+            modToMove = MoveManager::MakeMoves(path[i]->GetMoves()).front();
+        } else {
+            auto [movingModule, foundMove] = MoveManager::FindMoveToState(path[i]->GetModData());
+            if (foundMove == nullptr) {
+                writer.Flush();
+                std::cout << "Failed to generate scenario file, no move to next state found.\n";
+                return;
+            }
+            MoveManager::MoveModule(*movingModule, foundMove);
+            modToMove = movingModule;
+            move = foundMove;
         }
-        auto modToMove = movingModule;
         for (const auto& [type, offset]: move->AnimSequence()) {
-            modDef % (checkpoint ? '*' : ' ') % modToMove->id % type % offset[0] % offset[1] % offset[2];
-            os << modDef.str() << std::endl << std::endl;
+            writer.Anim(checkpoint, modToMove->id, type, offset[0], offset[1], offset[2]);
+            writer.EndStep();
             checkpoint = false;
         }
-        MoveManager::MoveModule(*modToMove, move);
 #endif
     }
+    writer.Flush();
     std::cout << "Done." << std::endl;
 }
@@ -20,9 +20,15 @@ namespace Scenario {
 
     std::string TryGetScenType(const std::string& initialFile);
 
+    // Export a path to a scenario file, files ending in .scenb are written in the binary format
     void ExportToScenFile(const std::vector<const Configuration*>& path, const ScenInfo& scenInfo);
 
     void ExportToScen(const std::vector<const Configuration*>& path, const ScenInfo& scenInfo, std::ostream& os);
+
+    void ExportToScenb(const std::vector<const Configuration*>& path, const ScenInfo& scenInfo, std::ostream& os);
+
+    // Convert a binary .scenb file to the text .scen format read by the visualizers
+    void ConvertScenbToScen(const std::string& scenbFile, const std::string& scenFile);
 }
 
 #endif
\ No newline at end of file
@@ -7,6 +7,18 @@ PropertyInitializer ColorProperty::initializer(COLOR_PROP_NAME, &PropertyInitial
 
 std::unordered_set<int> ColorProperty::allColors;
 
+#if CONFIG_STATIC_PROPERTIES
+// When built into the Pathfinder, register functions directly so ColorPropertyLib doesn't need to be loaded
+namespace {
+    const bool builtinFunctionsRegistered = [] {
+        ModuleProperties::RegisterBuiltinFunction(COLOR_PROP_NAME, "Palette", &Palette);
+        ModuleProperties::RegisterBuiltinFunction(COLOR_PROP_NAME, "GetColorInt", &GetColorInt);
+        ModuleProperties::RegisterBuiltinFunction(COLOR_PROP_NAME, "IsColor", &IsColor);
+        return true;
+    }();
+}
+#endif
+
 bool ColorProperty::CompareProperty(const IModuleProperty& right) {
     return color == dynamic_cast<const ColorProperty&>(right).color;
 }
@@ -0,0 +1,77 @@
+"""Move library cache check for Pathfinder.
+
+Runs Pathfinder twice on one scenario with an empty move library cache, so the first run parses the move folder and
+writes its library while the second run registers moves from that library. Exits with a non-zero status if the two
+runs end up with different move sets, or if the second run didn't use the library.
+
+Everything after -- is passed to Pathfinder:
+    python move_cache_check.py --pathfinder ./Pathfinder --cache "Move Cache" -- -I initial.json -F final.json -m Moves
+"""
+import argparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+
+def run(command):
+    """Run a command and return its output, raising if it fails."""
+    result = subprocess.run(command, capture_output=True, text=True, errors="replace")
+    if result.returncode != 0:
+        sys.stdout.write(result.stdout + result.stderr)
+        raise RuntimeError(f"{command[0]} exited with status {result.returncode}")
+    return result.stdout
+
+
+def move_set(output):
+    """Get (move count, move set hash) reported by a Pathfinder run."""
+    match = re.search(r"Moves loaded, (\d+) moves with set hash (\d+)\.", output)
+    if match is None:
+        raise RuntimeError("Pathfinder output did not report the loaded move set")
+    return int(match.group(1)), int(match.group(2))
+
+
+def libraries(cache):
+    """Get (inode, modification time) of every move library in the cache, keyed by file name."""
+    if not os.path.isdir(cache):
+        return {}
+    stats = {}
+    for name in os.listdir(cache):
+        if name.endswith(".movelib"):
+            stat = os.stat(os.path.join(cache, name))
+            stats[name] = (stat.st_ino, stat.st_mtime_ns)
+    return stats
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--pathfinder", required=True, help="Pathfinder executable")
+    parser.add_argument("--cache", default="Move Cache", help="Move library cache directory used by Pathfinder")
+    parser.add_argument("arguments", nargs=argparse.REMAINDER, help="Arguments passed to Pathfinder, after --")
+    args = parser.parse_args()
+    arguments = args.arguments[1:] if args.arguments[:1] == ["--"] else args.arguments
+
+    shutil.rmtree(args.cache, ignore_errors=True)
+    parsed = move_set(run([args.pathfinder] + arguments))
+    written = libraries(args.cache)
+    if not written:
+        print(f"First run didn't write a move library to {args.cache}")
+        return 1
+    cached = move_set(run([args.pathfinder] + arguments))
+    failures = []
+    if libraries(args.cache) != written:
+        failures.append("second run rewrote the move library instead of loading it")
+    if cached != parsed:
+        failures.append(f"parsed moves ({parsed[0]} moves, hash {parsed[1]}) differ from cached moves "
+                        f"({cached[0]} moves, hash {cached[1]})")
+    for failure in failures:
+        print(f"Move cache mismatch: {failure}")
+    if failures:
+        return 1
+    print(f"Parsed and cached move sets match ({parsed[0]} moves, hash {parsed[1]})")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
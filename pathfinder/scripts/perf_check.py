@@ -0,0 +1,151 @@
+"""Performance regression check for Pathfinder.
+
+Runs Pathfinder on one scenario and compares expansions, generated states, final depth and time against a baseline
+file. Times are divided by the time Pathfinder takes to run its calibration workload (--calibrate) so that baselines
+recorded on one machine can be roughly compared on another. Exits with a non-zero status on a regression in counts or
+depth, time regressions are only reported unless --check-times is given, since calibration doesn't track every search
+workload closely enough across machines.
+
+Pass --update to record a new baseline instead of checking, everything after -- is passed to Pathfinder:
+    python perf_check.py --pathfinder ./Pathfinder --baseline Baselines/2DSolo.json -- -I initial.json -F final.json
+
+Through CMake every baseline can be re-recorded with:
+    cmake --build <build dir> --target rebaseline_perf
+"""
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+# Exit status reported to CTest when there is no baseline to check against, the test is then marked as skipped
+SKIP_STATUS = 77
+
+
+def run(command):
+    """Run a command and return (wall time in ms, output), raising if it fails."""
+    start = time.perf_counter()
+    result = subprocess.run(command, capture_output=True, text=True, errors="replace")
+    wall_ms = (time.perf_counter() - start) * 1000
+    if result.returncode != 0:
+        sys.stdout.write(result.stdout + result.stderr)
+        raise RuntimeError(f"{command[0]} exited with status {result.returncode}")
+    return wall_ms, result.stdout
+
+
+def last_int(pattern, text):
+    matches = re.findall(pattern, text)
+    if not matches:
+        raise RuntimeError(f"Pathfinder output did not contain \"{pattern}\"")
+    return int(matches[-1])
+
+
+def calibrate(pathfinder):
+    _, output = run([pathfinder, "--calibrate"])
+    return last_int(r"Calibration completed in (\d+) us", output)
+
+
+def measure(pathfinder, arguments, repeat):
+    """Run a search several times, counts come from the first run and times are the fastest of all runs."""
+    results = None
+    for _ in range(repeat):
+        wall_ms, output = run([pathfinder] + arguments)
+        run_results = {
+            "expansions": last_int(r"States Processed: (\d+)", output),
+            "generated": last_int(r"States Discovered: (\d+)", output),
+            "depth": last_int(r"Final Depth: (\d+)", output),
+            "search_ms": last_int(r"Search completed in (\d+) ms", output),
+            "wall_ms": round(wall_ms)
+        }
+        if results is None:
+            results = run_results
+            continue
+        for key in ("expansions", "generated", "depth"):
+            if run_results[key] != results[key]:
+                print(f"Warning: {key} changed between runs ({results[key]} -> {run_results[key]})")
+        for key in ("search_ms", "wall_ms"):
+            results[key] = min(results[key], run_results[key])
+    return results
+
+
+def check(baseline, results, calibration_us, args):
+    """Compare results to a baseline, returns a list of regressions. Time regressions are included with --check-times,
+    otherwise they are printed as warnings."""
+    regressions = []
+    if results["depth"] != baseline["depth"]:
+        regressions.append(f"final depth {results['depth']} differs from baseline {baseline['depth']}")
+    for key in ("expansions", "generated"):
+        limit = baseline[key] * (1 + args.count_tolerance)
+        if results[key] > limit:
+            regressions.append(f"{key} {results[key]} exceeds baseline {baseline[key]} (limit {limit:.0f})")
+        elif results[key] < baseline[key]:
+            print(f"Note: {key} improved from {baseline[key]} to {results[key]}, consider re-baselining")
+    for key in ("search_ms", "wall_ms"):
+        # Baseline time in calibration units, scaled to this machine
+        expected = baseline[key] / baseline["calibration_us"] * calibration_us
+        limit = expected * (1 + args.time_tolerance) + args.time_slack
+        print(f"{key}: {results[key]} ms, expected {expected:.0f} ms on this machine (limit {limit:.0f} ms)")
+        if results[key] <= limit:
+            continue
+        if args.check_times:
+            regressions.append(f"{key} {results[key]} ms exceeds limit {limit:.0f} ms")
+        else:
+            print(f"Warning: {key} {results[key]} ms exceeds limit {limit:.0f} ms, not checked without --check-times")
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Check Pathfinder performance against a recorded baseline.")
+    parser.add_argument("--pathfinder", default="./Pathfinder", help="Pathfinder executable")
+    parser.add_argument("--baseline", required=True, help="Baseline file to check against or record")
+    parser.add_argument("--update", action="store_true", help="Record a new baseline instead of checking")
+    parser.add_argument("--require-baseline", action="store_true",
+                        help="Fail instead of skipping when there is no baseline to check against")
+    parser.add_argument("--repeat", type=int, default=3, help="Runs per measurement, the fastest time is used")
+    parser.add_argument("--count-tolerance", type=float, default=0.02,
+                        help="Allowed relative increase in expansions and generated states")
+    parser.add_argument("--check-times", action="store_true",
+                        help="Fail on time regressions instead of only reporting them")
+    parser.add_argument("--time-tolerance", type=float, default=0.5, help="Allowed relative increase in time")
+    parser.add_argument("--time-slack", type=float, default=50,
+                        help="Allowed absolute increase in time in ms, keeps short runs from failing on noise")
+    parser.add_argument("arguments", nargs=argparse.REMAINDER, help="Arguments passed to Pathfinder after --")
+    args = parser.parse_args()
+    arguments = args.arguments[1:] if args.arguments[:1] == ["--"] else args.arguments
+
+    calibration_us = calibrate(args.pathfinder)
+    results = measure(args.pathfinder, arguments, args.repeat)
+    # Calibrate again afterwards and keep the faster one, so a busy moment on the machine doesn't skew the ratio
+    calibration_us = min(calibration_us, calibrate(args.pathfinder))
+    print(f"Calibration: {calibration_us} us")
+    print(f"Results: {json.dumps(results)}")
+
+    if args.update:
+        baseline = {"calibration_us": calibration_us, **results,
+                    "arguments": [argument.replace(os.sep, "/") for argument in arguments]}
+        os.makedirs(os.path.dirname(os.path.abspath(args.baseline)), exist_ok=True)
+        with open(args.baseline, "w") as baseline_file:
+            json.dump(baseline, baseline_file, indent=4)
+            baseline_file.write("\n")
+        print(f"Baseline written to {args.baseline}")
+        return 0
+
+    if not os.path.exists(args.baseline):
+        print(f"No baseline at {args.baseline}, record one with --update or the rebaseline_perf target")
+        return 1 if args.require_baseline else SKIP_STATUS
+    with open(args.baseline) as baseline_file:
+        baseline = json.load(baseline_file)
+    regressions = check(baseline, results, calibration_us, args)
+    for regression in regressions:
+        print(f"Regression: {regression}")
+    if regressions:
+        print("If this change is intended, re-record baselines with the rebaseline_perf target")
+        return 1
+    print("No regressions.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
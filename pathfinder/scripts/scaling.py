@@ -0,0 +1,189 @@
+"""Scaling benchmark driver for Pathfinder.
+
+Generates seeded, connected random initial states for every combination of the given parameters, lets Pathfinder
+generate a final state from each one with a seeded random walk (-g/-S), then runs every search method and heuristic on
+it with a timeout. Results are written to a CSV file with one row per run.
+
+Run from a build directory containing Pathfinder, "Module Properties" and Test-Resources, for example:
+    python scaling.py --dimensions 2 3 --modules 4 6 8 --target-moves 4 8 --seeds 3 --output scaling.csv
+"""
+import argparse
+import csv
+import itertools
+import json
+import os
+import random
+import re
+import subprocess
+import sys
+import time
+
+# Adjacency offsets used when growing connected configurations
+CUBE_OFFSETS = {
+    2: [(1, 0), (-1, 0), (0, 1), (0, -1)],
+    3: [(1, 0, 0), (-1, 0, 0), (0, 1, 0), (0, -1, 0), (0, 0, 1), (0, 0, -1)],
+}
+RD_OFFSETS = [(x, y, z) for x, y, z in itertools.product((-1, 0, 1), repeat=3) if abs(x) + abs(y) + abs(z) == 2]
+
+# Move set used for each adjacency type unless overridden
+DEFAULT_MOVES = {"cube": "Moves_Pivot", "rd": "Moves_Rhombic"}
+
+PALETTE = [[255, 0, 0], [0, 255, 0], [0, 0, 255], [255, 255, 0]]
+
+CSV_FIELDS = ["dimensions", "adjacency", "modules", "target_moves", "properties", "seed", "method", "heuristic",
+              "status", "time_ms", "expansions", "generated", "depth", "peak_tracked_bytes", "peak_rss_kb"]
+
+
+def generate_initial(dimensions, adjacency, modules, properties, seed):
+    """Grow a connected configuration one module at a time from a seeded random frontier."""
+    rng = random.Random(seed)
+    offsets = RD_OFFSETS if adjacency == "rd" else CUBE_OFFSETS[dimensions]
+    origin = tuple([0] * dimensions)
+    occupied = [origin]
+    occupied_set = {origin}
+    while len(occupied) < modules:
+        base = rng.choice(occupied)
+        offset = rng.choice(offsets)
+        candidate = tuple(b + o for b, o in zip(base, offset))
+        if candidate in occupied_set:
+            continue
+        occupied.append(candidate)
+        occupied_set.add(candidate)
+    # Pathfinder expects the configuration to start at the origin
+    minimums = [min(axis) for axis in zip(*occupied)]
+    occupied = [tuple(c - m for c, m in zip(position, minimums)) for position in occupied]
+    scenario = {
+        "name": f"Scaling {dimensions}D {adjacency} {modules}",
+        "description": f"Generated by scaling.py with seed {seed}.",
+        "order": dimensions,
+        "modules": []
+    }
+    for position in occupied:
+        module = {"position": list(position), "static": False}
+        if properties:
+            module["properties"] = {"colorProperty": {"color": rng.choice(PALETTE)}}
+        scenario["modules"].append(module)
+    return scenario
+
+
+def run_pathfinder(command, timeout, log_path):
+    """Run Pathfinder, returns (return code or None on timeout, peak RSS in KiB or None)."""
+    with open(log_path, "w") as log:
+        process = subprocess.Popen(command, stdout=log, stderr=subprocess.STDOUT)
+        if not hasattr(os, "wait4"):
+            try:
+                return process.wait(timeout), None
+            except subprocess.TimeoutExpired:
+                process.kill()
+                process.wait()
+                return None, None
+        deadline = time.monotonic() + timeout
+        while True:
+            pid, status, usage = os.wait4(process.pid, os.WNOHANG)
+            if pid != 0:
+                process.returncode = os.waitstatus_to_exitcode(status)
+                # ru_maxrss is in bytes on macOS and KiB elsewhere
+                rss = usage.ru_maxrss // 1024 if sys.platform == "darwin" else usage.ru_maxrss
+                return process.returncode, rss
+            if time.monotonic() > deadline:
+                process.kill()
+                os.wait4(process.pid, 0)
+                return None, None
+            time.sleep(0.02)
+
+
+def last_int(pattern, text):
+    matches = re.findall(pattern, text)
+    return int(matches[-1]) if matches else ""
+
+
+def parse_results(log_path, analysis_path):
+    with open(log_path, errors="replace") as log:
+        output = log.read()
+    results = {
+        "time_ms": last_int(r"Search completed in (\d+) ms", output),
+        "expansions": last_int(r"States Processed: (\d+)", output),
+        "generated": last_int(r"States Discovered: (\d+)", output),
+        "depth": last_int(r"(?:A\*|BFS|BDBFS|Bi-Directional A\*) Final Depth: (\d+)", output),
+        "peak_tracked_bytes": ""
+    }
+    if os.path.exists(analysis_path):
+        with open(analysis_path) as analysis_file:
+            try:
+                results["peak_tracked_bytes"] = json.load(analysis_file).get("Memory", {}).get("PeakTotalBytes", "")
+            except json.JSONDecodeError:
+                pass
+    results["status"] = "ok" if results["time_ms"] != "" else "failed"
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure how Pathfinder scales on generated scenarios.")
+    parser.add_argument("--pathfinder", default="./Pathfinder", help="Pathfinder executable")
+    parser.add_argument("--resources", default="Test-Resources", help="Folder containing move sets")
+    parser.add_argument("--moves-folder", help="Move set to use instead of the default for each adjacency type")
+    parser.add_argument("--work-dir", default="Scaling", help="Folder for generated scenarios and logs")
+    parser.add_argument("--output", default="scaling.csv", help="CSV file to write results to")
+    parser.add_argument("--dimensions", type=int, nargs="+", default=[2, 3], choices=[2, 3])
+    parser.add_argument("--adjacency", nargs="+", default=["cube", "rd"], choices=["cube", "rd"],
+                        help="Rhombic dodecahedron (rd) cases are only generated in 3D")
+    parser.add_argument("--modules", type=int, nargs="+", default=[4, 6, 8])
+    parser.add_argument("--target-moves", type=int, nargs="+", default=[4, 8])
+    parser.add_argument("--properties", nargs="+", default=["without", "with"], choices=["without", "with"])
+    parser.add_argument("--seeds", type=int, default=3, help="Scenarios generated per parameter combination")
+    parser.add_argument("--base-seed", type=int, default=1)
+    parser.add_argument("--methods", nargs="+", default=["A*", "BDA*", "BFS", "BDBFS"])
+    parser.add_argument("--heuristics", nargs="+", default=["MRSH-1", "Manhattan", "Symmetric Difference"],
+                        help="Heuristics for A* and BDA*, MRSH-1 is Pathfinder's default")
+    parser.add_argument("--timeout", type=float, default=60, help="Seconds before a run is stopped")
+    args = parser.parse_args()
+
+    os.makedirs(args.work_dir, exist_ok=True)
+    cases = itertools.product(args.dimensions, args.adjacency, args.modules, args.target_moves, args.properties,
+                              range(args.base_seed, args.base_seed + args.seeds))
+    with open(args.output, "w", newline="") as csv_file:
+        writer = csv.DictWriter(csv_file, fieldnames=CSV_FIELDS)
+        writer.writeheader()
+        for dimensions, adjacency, modules, target_moves, properties, seed in cases:
+            if adjacency == "rd" and dimensions != 3:
+                continue
+            with_properties = properties == "with"
+            case_name = f"{dimensions}D_{adjacency}_{modules}m_{target_moves}k_{properties}_s{seed}"
+            initial_path = os.path.join(args.work_dir, case_name + "_initial.json")
+            with open(initial_path, "w") as initial_file:
+                json.dump(generate_initial(dimensions, adjacency, modules, with_properties, seed), initial_file)
+            moves = os.path.join(args.resources, args.moves_folder or DEFAULT_MOVES[adjacency])
+            for method in args.methods:
+                heuristics = args.heuristics if method in ("A*", "BDA*") else [""]
+                for heuristic in heuristics:
+                    run_name = f"{case_name}_{method.replace('*', 'star')}_{heuristic.replace(' ', '')}"
+                    log_path = os.path.join(args.work_dir, run_name + ".log")
+                    analysis_path = os.path.join(args.work_dir, run_name + "_analysis.json")
+                    if os.path.exists(analysis_path):
+                        os.remove(analysis_path)
+                    command = [args.pathfinder, "-I", initial_path, "-m", moves, "-s", method,
+                               "-g", str(target_moves), "-S", str(seed), "-r", "1000",
+                               "-e", os.path.join(args.work_dir, run_name + ".scen"), "-a", analysis_path]
+                    if heuristic and heuristic != "MRSH-1":
+                        command += ["-h", heuristic]
+                    if adjacency == "rd":
+                        command += ["-c", "RD"]
+                    if not with_properties:
+                        command.append("-i")
+                    return_code, peak_rss = run_pathfinder(command, args.timeout, log_path)
+                    row = {"dimensions": dimensions, "adjacency": adjacency, "modules": modules,
+                           "target_moves": target_moves, "properties": properties, "seed": seed, "method": method,
+                           "heuristic": heuristic, "peak_rss_kb": "" if peak_rss is None else peak_rss}
+                    row.update(parse_results(log_path, analysis_path))
+                    if return_code is None:
+                        row["status"] = "timeout"
+                    elif return_code != 0:
+                        row["status"] = f"failed ({return_code})"
+                    writer.writerow(row)
+                    csv_file.flush()
+                    print(f"{run_name}: {row['status']} {row['time_ms']} ms, {row['expansions']} expansions, "
+                          f"depth {row['depth']}")
+
+
+if __name__ == "__main__":
+    main()
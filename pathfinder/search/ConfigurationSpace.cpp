@@ -1,13 +1,19 @@
 #include <random>
+#include <algorithm>
 #include <boost/functional/hash.hpp>
 #include <unordered_set>
+#include <iterator>
 #include <queue>
 #include <set>
 #include <utility>
+#include "../lattice/LatticeSetup.h"
 #include "../moves/MoveManager.h"
 #include "ConfigurationSpace.h"
 #include "HeuristicCache.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
 #include "SearchAnalysis.h"
+#include "Zobrist.h"
 
 const char* SearchExcept::what() const noexcept {
     return "Search exhausted without finding a path!";
@@ -17,17 +23,153 @@ const char *HeuristicExcept::what() const noexcept {
     return "Heuristic exhibited non-consistent behavior!";
 }
 
+const char* HashExcept::what() const noexcept {
+    return "Incrementally updated state hash doesn't match full recompute!";
+}
+
+const char* PathExcept::what() const noexcept {
+    return "No move found to undo a step from the final side of the search!";
+}
+
 
 HashedState::HashedState(const std::set<ModuleData>& modData, const int depth) {
-    seed = boost::hash_range(modData.begin(), modData.end());
+    seed = PROFILE_EXPR(PROFILE_HASHING, Zobrist::StateKey(modData));
     moduleData = modData;
     foundAt = nullptr;
     this->depth = depth;
+    TrackModuleData(static_cast<std::int64_t>(moduleData.size()));
+}
+
+HashedState::HashedState(const HashedState& parent, const StateDelta& stateDelta, const int depth) : seed(parent.GetSeed()),
+        foundAt(nullptr), depth(depth), parentState(&parent), delta(&stateDelta) {
+    PROFILE_SCOPE(PROFILE_HASHING);
+    // Seed is a XOR of module keys, so it can be updated without looking at unchanged modules
+    for (const auto& data : stateDelta.removed) {
+        seed ^= Zobrist::ModuleKey(data);
+    }
+    for (const auto& data : stateDelta.added) {
+        seed ^= Zobrist::ModuleKey(data);
+    }
+}
+
+HashedState::HashedState(const HashedState& other) : seed(other.GetSeed()), moduleData(other.GetState()), foundAt(other.FoundAt()),
+        depth(other.depth), parentState(other.parentState), delta(other.delta), released(other.released),
+        releasedDelta(other.releasedDelta) {
+    TrackModuleData(static_cast<std::int64_t>(moduleData.size()));
+    if (!released) {
+        Materialize();
+    }
+}
+
+HashedState::~HashedState() {
+    TrackModuleData(-static_cast<std::int64_t>(moduleData.size()));
+}
+
+std::set<ModuleData> HashedState::BuildState() const {
+    if (parentState == nullptr) {
+        return moduleData;
+    }
+    auto state = parentState->GetState();
+    for (const auto& data : delta->removed) {
+        state.erase(data);
+    }
+    for (const auto& data : delta->added) {
+        state.insert(data);
+    }
+    return state;
 }
 
-HashedState::HashedState(const HashedState& other) : seed(other.GetSeed()), moduleData(other.GetState()), foundAt(other.FoundAt()), depth(other.depth) {}
+void HashedState::Materialize() {
+    if (parentState == nullptr) {
+        return;
+    }
+    TrackModuleData(-static_cast<std::int64_t>(moduleData.size()));
+    moduleData = BuildState();
+    TrackModuleData(static_cast<std::int64_t>(moduleData.size()));
+    parentState = nullptr;
+    delta = nullptr;
+    released = false;
+    releasedDelta.reset();
+    VerifySeed();
+}
+
+void HashedState::Release(const HashedState& parent) {
+    // Module data is compared by position and properties, so anything that moved or changed is part of the delta
+    const auto missingFrom = [](const std::set<ModuleData>& state) {
+        return [&state](const ModuleData& data) {
+            const auto it = state.find(data);
+            return it == state.end() || !(*it == data);
+        };
+    };
+    const auto& parentData = parent.GetState();
+    // Moves are kept by the configuration, only the module data is needed here
+    auto ownedDelta = std::make_shared<StateDelta>();
+    std::ranges::copy_if(parentData, std::back_inserter(ownedDelta->removed), missingFrom(moduleData));
+    std::ranges::copy_if(moduleData, std::back_inserter(ownedDelta->added), missingFrom(parentData));
+    TrackModuleData(-static_cast<std::int64_t>(moduleData.size()));
+    std::set<ModuleData>().swap(moduleData);
+    releasedDelta = std::move(ownedDelta);
+    parentState = &parent;
+    delta = releasedDelta.get();
+    released = true;
+}
 
-size_t HashedState::GetSeed() const {
+void HashedState::Restore(const std::set<ModuleData>& modData) {
+    TrackModuleData(static_cast<std::int64_t>(modData.size()) - static_cast<std::int64_t>(moduleData.size()));
+    moduleData = modData;
+    parentState = nullptr;
+    delta = nullptr;
+    released = false;
+    releasedDelta.reset();
+    VerifySeed();
+}
+
+void HashedState::TrackModuleData(const std::int64_t modules) {
+#if !CONFIG_TRACK_MODULE_DATA
+    if (modules > 0) {
+        MemoryTracker::Allocate(MEM_MODULE_DATA, modules * ModuleData::EstimatedBytes(), modules);
+    } else if (modules < 0) {
+        MemoryTracker::Deallocate(MEM_MODULE_DATA, -modules * ModuleData::EstimatedBytes(), -modules);
+    }
+#endif
+}
+
+void HashedState::VerifySeed() const {
+#if CONFIG_VERIFY_HASHES
+    if (seed != Zobrist::StateKey(moduleData)) {
+        throw HashExcept();
+    }
+#endif
+}
+
+bool HashedState::IsMaterialized() const {
+    return !released && parentState == nullptr;
+}
+
+const StateDelta* HashedState::GetDelta() const {
+    return delta;
+}
+
+bool HashedState::MatchesDelta(const HashedState& parent, const StateDelta& stateDelta) const {
+    const auto& parentData = parent.GetState();
+    if (moduleData.size() != parentData.size()) {
+        return false;
+    }
+    auto contains = [this](const ModuleData& data) {
+        const auto it = moduleData.find(data);
+        return it != moduleData.end() && *it == data;
+    };
+    if (!std::ranges::all_of(stateDelta.added, contains)) {
+        return false;
+    }
+    return std::ranges::all_of(parentData, [&stateDelta, &contains](const ModuleData& data) {
+        return contains(data) || std::ranges::any_of(stateDelta.removed, [&data](const ModuleData& removed) {
+            return removed == data;
+        });
+    });
+}
+
+std::uint64_t HashedState::GetSeed() const {
     return seed;
 }
 
@@ -52,43 +194,94 @@ int HashedState::GetDepth() const {
 }
 
 bool HashedState::operator==(const HashedState& other) const {
-    return seed == other.GetSeed() && moduleData == other.GetState();
+    if (seed != other.GetSeed()) {
+        return false;
+    }
+    // Matching seeds are only a strong hint, released states are compared through the delta they kept
+    if (parentState != nullptr && other.parentState != nullptr) {
+        return BuildState() == other.BuildState();
+    }
+    if (parentState != nullptr) {
+        return other.MatchesDelta(*parentState, *delta);
+    }
+    if (other.parentState != nullptr) {
+        return MatchesDelta(*other.parentState, *other.delta);
+    }
+    return moduleData == other.GetState();
 }
 
 bool HashedState::operator!=(const HashedState& other) const {
     return seed != other.GetSeed();
 }
 
+// Containers for configurations waiting to be expanded, memory is attributed to the open set subsystem
+template<typename T>
+using OpenVector = std::vector<T, TrackingAllocator<T, MEM_OPEN_SET>>;
+
+template<typename T>
+using OpenQueue = std::queue<T, std::deque<T, TrackingAllocator<T, MEM_OPEN_SET>>>;
+
 size_t std::hash<HashedState>::operator()(const HashedState& state) const noexcept {
-    return state.GetSeed();
+    return static_cast<size_t>(state.GetSeed());
+}
+
+Configuration::Configuration(const std::set<ModuleData>& modData) : hash(modData) {
+    MemoryTracker::Allocate(MEM_CONFIGURATIONS, MemoryUsage());
+}
+
+Configuration::Configuration(const HashedState& state) : hash(state) {
+    if (state.GetDelta() != nullptr) {
+        moves = state.GetDelta()->moves;
+    }
+    MemoryTracker::Allocate(MEM_CONFIGURATIONS, MemoryUsage());
+}
+
+Configuration::Configuration(const Configuration& other) : parent(other.parent), next(other.next), hash(other.hash),
+    cost(other.cost), estimate(other.estimate), moves(other.moves), depth(other.depth) {
+    MemoryTracker::Allocate(MEM_CONFIGURATIONS, MemoryUsage());
 }
 
-Configuration::Configuration(const std::set<ModuleData>& modData) : hash(modData) {}
+const Configuration* Configuration::latticeConfiguration = nullptr;
+std::size_t Configuration::latticeRevision = 0;
+LatticeSwitchStats Configuration::switchStats;
 
 Configuration::~Configuration() {
+    if (latticeConfiguration == this) {
+        latticeConfiguration = nullptr;
+    }
+    MemoryTracker::Deallocate(MEM_CONFIGURATIONS, MemoryUsage());
     for (auto i = next.rbegin(); i != next.rend(); ++i) {
         delete *i;
     }
 }
 
-std::vector<std::set<ModuleData>> Configuration::MakeAllMoves() const {
-    std::vector<std::set<ModuleData>> result;
-    Lattice::UpdateFromModuleInfo(GetModData());
+std::size_t Configuration::MemoryUsage() const {
+    return sizeof(Configuration) + moves.capacity() * sizeof(ModuleMove) + moves.size() * Lattice::Order() * sizeof(int);
+}
+
+std::vector<StateDelta> Configuration::MakeAllMoves() const {
+    std::vector<StateDelta> result;
+    LoadIntoLattice();
+    if (Lattice::NearEdge()) {
+        throw LatticeEdgeExcept();
+    }
     std::vector<Module*> movableModules = Lattice::MovableModules();
     for (const auto module: movableModules) {
         auto legalMoves = MoveManager::CheckAllMoves(Lattice::coordTensor, *module);
         for (const auto move : legalMoves) {
-            MoveManager::MoveModule(*module, move);
-            result.emplace_back(Lattice::GetModuleInfo());
-            MoveManager::UnMoveModule(*module, move);
+            const std::pair<Module*, const MoveBase*> step = {module, move};
+            result.emplace_back(MoveManager::MakeDelta({&step, 1}));
         }
     }
     return result;
 }
 
-std::vector<std::set<ModuleData>> Configuration::MakeAllMovesForAllVertices() const {
-    std::vector<std::set<ModuleData>> result;
-    Lattice::UpdateFromModuleInfo(GetModData());
+std::vector<StateDelta> Configuration::MakeAllMovesForAllVertices() const {
+    std::vector<StateDelta> result;
+    LoadIntoLattice();
+    if (Lattice::NearEdge()) {
+        throw LatticeEdgeExcept();
+    }
     std::vector<Module*> movableModules;
     for (int id = 0; id < ModuleIdManager::MinStaticID(); id++) {
         movableModules.push_back(&ModuleIdManager::GetModule(id));
@@ -97,17 +290,19 @@ std::vector<std::set<ModuleData>> Configuration::MakeAllMovesForAllVertices() co
         auto legalMoves = MoveManager::CheckAllMoves(Lattice::coordTensor, *module);
         for (const auto move: legalMoves) {
             MoveManager::MoveModule(*module, move);
-            if (Lattice::CheckConnected()) {
-                result.emplace_back(Lattice::GetModuleInfo());
-            }
+            const bool connected = Lattice::CheckConnected();
             MoveManager::UnMoveModule(*module, move);
+            if (connected) {
+                const std::pair<Module*, const MoveBase*> step = {module, move};
+                result.emplace_back(MoveManager::MakeDelta({&step, 1}));
+            }
         }
     }
     return result;
 }
 
-Configuration* Configuration::AddEdge(const std::set<ModuleData>& modData) {
-    next.push_back(new Configuration(modData));
+Configuration* Configuration::AddEdge(const HashedState& state) {
+    next.push_back(new Configuration(state));
     return next.back();
 }
 
@@ -127,6 +322,114 @@ const std::set<ModuleData>& Configuration::GetModData() const {
     return hash.GetState();
 }
 
+const std::vector<ModuleMove>& Configuration::GetMoves() const {
+    return moves;
+}
+
+void Configuration::Materialize() {
+    if (hash.IsMaterialized()) {
+        LoadIntoLattice();
+        return;
+    }
+    if (!SwitchLatticeByMoves()) {
+        std::vector<const Configuration*> steps;
+        const Configuration* ancestor = this;
+        while (!ancestor->hash.IsMaterialized()) {
+            steps.push_back(ancestor);
+            ancestor = ancestor->parent;
+        }
+        auto cellUpdates = 2 * Lattice::UpdateFromModuleInfo(ancestor->GetModData());
+        for (auto step = steps.rbegin(); step != steps.rend(); ++step) {
+            MoveManager::MakeMoves((*step)->moves);
+            cellUpdates += 2 * (*step)->moves.size();
+        }
+        switchStats.rebuilds++;
+        switchStats.rebuildCellUpdates += cellUpdates;
+        MarkInLattice();
+    }
+    hash.Restore(Lattice::GetModuleInfo());
+}
+
+bool Configuration::SwitchLatticeByMoves() const {
+    PROFILE_SCOPE(PROFILE_SWITCH_LATTICE);
+    if (latticeConfiguration == nullptr || latticeRevision != Lattice::Revision()) {
+        return false;
+    }
+    // Configurations to step back through, starting from the one in the lattice
+    std::vector<const Configuration*> undo;
+    for (auto config = latticeConfiguration; config != nullptr && undo.size() <= CONFIG_LATTICE_SWITCH_DISTANCE; config = config->parent) {
+        undo.push_back(config);
+    }
+    // Configurations to step forward through, starting from this one
+    std::vector<const Configuration*> redo;
+    for (const Configuration* config = this; config != nullptr && redo.size() <= CONFIG_LATTICE_SWITCH_DISTANCE; config = config->parent) {
+        if (const auto ancestor = std::ranges::find(undo, config); ancestor != undo.end()) {
+            undo.erase(ancestor, undo.end());
+            if (undo.size() + redo.size() > CONFIG_LATTICE_SWITCH_DISTANCE) {
+                return false;
+            }
+            if (undo.empty() && redo.empty()) {
+                return true;
+            }
+            // Only the root of a search tree should have no moves, anything else can't be replayed
+            const auto noMoves = [](const Configuration* step) { return step->moves.empty(); };
+            if (std::ranges::any_of(undo, noMoves) || std::ranges::any_of(redo, noMoves)) {
+                return false;
+            }
+            std::uint64_t cellUpdates = 0;
+            for (const auto step : undo) {
+                for (auto it = step->moves.rbegin(); it != step->moves.rend(); ++it) {
+                    auto& mod = ModuleIdManager::GetModule(Lattice::coordTensor[it->from + it->move->MoveOffset()]);
+                    MoveManager::UnMoveModule(mod, it->move);
+                }
+                cellUpdates += 2 * step->moves.size();
+            }
+            for (auto step = redo.rbegin(); step != redo.rend(); ++step) {
+                MoveManager::MakeMoves((*step)->moves);
+                cellUpdates += 2 * (*step)->moves.size();
+            }
+            switchStats.moveSwitches++;
+            switchStats.moveCellUpdates += cellUpdates;
+            MarkInLattice();
+#if CONFIG_VERIFY_HASHES
+            if (hash.IsMaterialized() && Zobrist::StateKey(Lattice::GetModuleInfo()) != hash.GetSeed()) {
+                throw HashExcept();
+            }
+#endif
+            return true;
+        }
+        redo.push_back(config);
+    }
+    return false;
+}
+
+void Configuration::MarkInLattice() const {
+    latticeConfiguration = this;
+    latticeRevision = Lattice::Revision();
+}
+
+void Configuration::LoadIntoLattice() const {
+    if (SwitchLatticeByMoves()) {
+        return;
+    }
+    PROFILE_SCOPE(PROFILE_SWITCH_LATTICE);
+    switchStats.rebuilds++;
+    switchStats.rebuildCellUpdates += 2 * Lattice::UpdateFromModuleInfo(GetModData());
+    MarkInLattice();
+}
+
+const LatticeSwitchStats& Configuration::SwitchStats() {
+    return switchStats;
+}
+
+void Configuration::ResetSwitchStats() {
+    switchStats = {};
+}
+
+void Configuration::Release() {
+    hash.Release(parent->hash);
+}
+
 void Configuration::SetParent(Configuration* configuration) {
     parent = configuration;
 }
@@ -140,12 +443,16 @@ BDConfiguration::BDConfiguration(const std::set<ModuleData> &modData, Origin ori
     hash.SetFounder(this);
 }
 
+BDConfiguration::BDConfiguration(const HashedState& state, Origin origin) : Configuration(state), origin(origin) {
+    hash.SetFounder(this);
+}
+
 Origin BDConfiguration::GetOrigin() const {
     return origin;
 }
 
-BDConfiguration *BDConfiguration::AddEdge(const std::set<ModuleData> &modData) {
-    next.push_back(new BDConfiguration(modData, origin));
+BDConfiguration *BDConfiguration::AddEdge(const HashedState& state) {
+    next.push_back(new BDConfiguration(state, origin));
     return static_cast<BDConfiguration*>(next.back()); // NOLINT We can use static here it's fine
 }
 
@@ -193,8 +500,9 @@ auto pathfinderUpdate = R"(
 
 int ConfigurationSpace::depth = -1;
 
+bool ConfigurationSpace::lazyNodes = false;
+
 std::vector<const Configuration*> ConfigurationSpace::BFS(Configuration* start, const Configuration* final) {
-#if CONFIG_OUTPUT_JSON
     SearchAnalysis::EnterGraph("BFSDepthOverTime");
     SearchAnalysis::LabelGraph("BFS Depth over Time");
     SearchAnalysis::LabelAxes("Time (μs)", "Depth");
@@ -208,23 +516,36 @@ std::vector<const Configuration*> ConfigurationSpace::BFS(Configuration* start,
     SearchAnalysis::LabelAxes("Time (μs)", "States discovered");
     SearchAnalysis::SetInterpolationOrder(1);
     SearchAnalysis::StartClock();
-#endif
     int dupesAvoided = 0;
     int statesProcessed = 0;
 #if __EMSCRIPTEN__
     int estimatedFinalDepth = static_cast<int>(start->CacheMoveOffsetPropertyDistance(final));
 #endif
-    std::queue<Configuration*> q;
-    std::unordered_set<HashedState> visited;
+    OpenQueue<Configuration*> q;
+    VisitedSet visited;
+    // Record a point on every graph of this search, the analysis clock should be paused
+    auto recordSample = [&]() {
+        SearchAnalysis::EnterGraph("BFSDepthOverTime");
+        SearchAnalysis::InsertTimePoint(depth);
+        SearchAnalysis::EnterGraph("BFSStatesVisitedOverTime");
+        SearchAnalysis::InsertTimePoint(statesProcessed);
+        SearchAnalysis::EnterGraph("BFSStatesDiscoveredOverTime");
+        SearchAnalysis::InsertTimePoint(visited.size());
+        MemoryTracker::RecordSample();
+    };
     q.push(start);
     visited.insert(start->GetHash());
     while (!q.empty()) {
+        MemoryTracker::CheckBudget();
+        if (SearchAnalysis::SampleDue()) {
+            SearchAnalysis::PauseClock();
+            recordSample();
+            SearchAnalysis::ResumeClock();
+        }
         Configuration* current = q.front();
-        Lattice::UpdateFromModuleInfo(q.front()->GetModData());
+        current->Materialize();
 #if CONFIG_VERBOSE > CS_LOG_NONE
-#if CONFIG_OUTPUT_JSON
         SearchAnalysis::PauseClock();
-#endif
         if (q.front()->depth != depth) {
             depth++;
 #if CONFIG_VERBOSE > CS_LOG_FINAL_DEPTH
@@ -242,26 +563,15 @@ std::vector<const Configuration*> ConfigurationSpace::BFS(Configuration* start,
             << "States Processed: " << statesProcessed << std::endl
             << Lattice::ToString() << std::endl;
 #endif
-#if CONFIG_OUTPUT_JSON
-            SearchAnalysis::EnterGraph("BFSDepthOverTime");
-            SearchAnalysis::InsertTimePoint(depth);
-            SearchAnalysis::EnterGraph("BFSStatesVisitedOverTime");
-            SearchAnalysis::InsertTimePoint(statesProcessed);
-            SearchAnalysis::EnterGraph("BFSStatesDiscoveredOverTime");
-            SearchAnalysis::InsertTimePoint(visited.size());
-#endif
+            recordSample();
 #endif
         }
-#if CONFIG_OUTPUT_JSON
         SearchAnalysis::ResumeClock();
-#endif
 #endif
         q.pop();
         if (current->GetHash() == final->GetHash()) {
 #if CONFIG_VERBOSE >= CS_LOG_FINAL_DEPTH
-#if CONFIG_OUTPUT_JSON
             SearchAnalysis::PauseClock();
-#endif
 #if __EMSCRIPTEN__
             std::cout << "BFS Final Depth: " << depth << std::endl;
 #else
@@ -271,14 +581,7 @@ std::vector<const Configuration*> ConfigurationSpace::BFS(Configuration* start,
             << "States Processed: " << statesProcessed << std::endl
             << Lattice::ToString() << std::endl;
 #endif
-#if CONFIG_OUTPUT_JSON
-            SearchAnalysis::EnterGraph("BFSDepthOverTime");
-            SearchAnalysis::InsertTimePoint(depth);
-            SearchAnalysis::EnterGraph("BFSStatesVisitedOverTime");
-            SearchAnalysis::InsertTimePoint(statesProcessed);
-            SearchAnalysis::EnterGraph("BFSStatesDiscoveredOverTime");
-            SearchAnalysis::InsertTimePoint(visited.size());
-#endif
+            recordSample();
 #endif
             return FindPath(start, current);
         }
@@ -288,16 +591,20 @@ std::vector<const Configuration*> ConfigurationSpace::BFS(Configuration* start,
         auto adjList = MoveManager::MakeAllParallelMoves(visited);
 #endif
         statesProcessed++;
-        for (const auto& moduleInfo : adjList) {
+        for (const auto& delta : adjList) {
+            HashedState hashedState(current->GetHash(), delta);
 #if !CONFIG_PARALLEL_MOVES
-            if (visited.find(HashedState(moduleInfo)) == visited.end()) {
+            if (!PROFILE_EXPR(PROFILE_VISITED_PROBE, visited.contains(hashedState))) {
 #endif
-                auto nextConfiguration = current->AddEdge(moduleInfo);
+                auto nextConfiguration = current->AddEdge(hashedState);
                 nextConfiguration->SetParent(current);
                 q.push(nextConfiguration);
                 nextConfiguration->depth = current->depth + 1;
+                if (lazyNodes) {
+                    nextConfiguration->Release();
+                }
 #if !CONFIG_PARALLEL_MOVES
-                visited.insert(HashedState(moduleInfo));
+                PROFILE_EXPR(PROFILE_VISITED_PROBE, visited.insert(nextConfiguration->GetHash()));
             } else {
                 dupesAvoided++;
             }
@@ -313,8 +620,36 @@ std::vector<const Configuration*> ConfigurationSpace::BFS(Configuration* start,
     throw SearchExcept();
 }
 
+// Add a successor to a configuration with the moves that reach it recorded
+static Configuration* AddRecordedEdge(Configuration* configuration, const HashedState& state) {
+    const auto next = configuration->AddEdge(state);
+    next->SetParent(configuration);
+    next->depth = configuration->depth + 1;
+    return next;
+}
+
+// Undo the moves made to reach a configuration, the lattice has to be in that configuration's state
+static Configuration* AddInverseEdge(Configuration* configuration, const std::span<const ModuleMove> moves) {
+    const auto inverseMoves = MoveManager::FindInverseMoves(moves);
+    if (inverseMoves.empty()) {
+        throw PathExcept();
+    }
+    return AddRecordedEdge(configuration, HashedState(configuration->GetHash(), MoveManager::MakeDelta(inverseMoves)));
+}
+
+// Build the path of a bi-directional search, startSide is a configuration found from the start with the same state as
+// endSide, which was found from the final configuration. Each step from endSide back to the final configuration is
+// undone under startSide so every step of the path has its moves recorded.
+static std::vector<const Configuration*> JoinBDPath(const BDConfiguration* start, const BDConfiguration* final,
+                                                    Configuration* startSide, const Configuration* endSide) {
+    for (auto current = endSide; current->GetHash() != final->GetHash(); current = current->GetParent()) {
+        current->LoadIntoLattice();
+        startSide = AddInverseEdge(startSide, current->GetMoves());
+    }
+    return ConfigurationSpace::FindPath(start, startSide);
+}
+
 std::vector<const Configuration*> ConfigurationSpace::BiDirectionalBFS(BDConfiguration* start, BDConfiguration* final) {
-#if CONFIG_OUTPUT_JSON
     SearchAnalysis::EnterGraph("BDBFSDepthOverTime");
     SearchAnalysis::LabelGraph("BFS Depth over Time (Bi-Directional)");
     SearchAnalysis::LabelAxes("Time (μs)", "Depth");
@@ -336,7 +671,6 @@ std::vector<const Configuration*> ConfigurationSpace::BiDirectionalBFS(BDConfigu
     SearchAnalysis::LabelAxes("Time (μs)", "States discovered");
     SearchAnalysis::SetInterpolationOrder(1);
     SearchAnalysis::StartClock();
-#endif
     int dupesAvoided = 0;
     int statesProcessed = 0;
     int depthFromStart = 0;
@@ -345,20 +679,38 @@ std::vector<const Configuration*> ConfigurationSpace::BiDirectionalBFS(BDConfigu
     int estimatedFinalDepth = static_cast<int>(std::max(start->CacheMoveOffsetPropertyDistance(final),
                                                         final->CacheMoveOffsetPropertyDistance(start)));
 #endif
-    std::queue<BDConfiguration*> q;
-    std::unordered_set<HashedState> visited;
+    OpenQueue<BDConfiguration*> q;
+    VisitedSet visited;
+    // Record a point on every graph of this search, the analysis clock should be paused
+    auto recordSample = [&]() {
+        SearchAnalysis::EnterGraph("BDBFSDepthOverTime");
+        SearchAnalysis::InsertTimePoint(depthFromStart + depthFromFinal);
+        SearchAnalysis::EnterGraph("BDBFSStartDepthOverTime");
+        SearchAnalysis::InsertTimePoint(depthFromStart);
+        SearchAnalysis::EnterGraph("BDBFSFinalDepthOverTime");
+        SearchAnalysis::InsertTimePoint(depthFromFinal);
+        SearchAnalysis::EnterGraph("BDBFSStatesVisitedOverTime");
+        SearchAnalysis::InsertTimePoint(statesProcessed);
+        SearchAnalysis::EnterGraph("BDBFSStatesDiscoveredOverTime");
+        SearchAnalysis::InsertTimePoint(visited.size());
+        MemoryTracker::RecordSample();
+    };
     q.push(start);
     final->depth = 1;
     q.push(final);
     visited.insert(start->GetHash());
     visited.insert(final->GetHash());
     while (!q.empty()) {
+        MemoryTracker::CheckBudget();
+        if (SearchAnalysis::SampleDue()) {
+            SearchAnalysis::PauseClock();
+            recordSample();
+            SearchAnalysis::ResumeClock();
+        }
         BDConfiguration* current = q.front();
-        Lattice::UpdateFromModuleInfo(q.front()->GetModData());
+        current->LoadIntoLattice();
 #if CONFIG_VERBOSE > CS_LOG_NONE
-#if CONFIG_OUTPUT_JSON
         SearchAnalysis::PauseClock();
-#endif
         if ((q.front()->GetOrigin() == START && q.front()->depth != depthFromStart) ||
             (q.front()->GetOrigin() == END && q.front()->depth != depthFromFinal)) {
             if (q.front()->GetOrigin() == START) {
@@ -385,31 +737,16 @@ std::vector<const Configuration*> ConfigurationSpace::BiDirectionalBFS(BDConfigu
             << "States Processed: " << statesProcessed << std::endl
             << Lattice::ToString() << std::endl;
 #endif
-#if CONFIG_OUTPUT_JSON
-            SearchAnalysis::EnterGraph("BDBFSDepthOverTime");
-            SearchAnalysis::InsertTimePoint(depthFromStart + depthFromFinal);
-            SearchAnalysis::EnterGraph("BDBFSStartDepthOverTime");
-            SearchAnalysis::InsertTimePoint(depthFromStart);
-            SearchAnalysis::EnterGraph("BDBFSFinalDepthOverTime");
-            SearchAnalysis::InsertTimePoint(depthFromFinal);
-            SearchAnalysis::EnterGraph("BDBFSStatesVisitedOverTime");
-            SearchAnalysis::InsertTimePoint(statesProcessed);
-            SearchAnalysis::EnterGraph("BDBFSStatesDiscoveredOverTime");
-            SearchAnalysis::InsertTimePoint(visited.size());
-#endif
+            recordSample();
 #endif
         }
-#if CONFIG_OUTPUT_JSON
         SearchAnalysis::ResumeClock();
-#endif
 #endif
         q.pop();
         if ((current->GetOrigin() == START && current->GetHash() == final->GetHash()) ||
             (current->GetOrigin() == END && current->GetHash() == start->GetHash())) {
 #if CONFIG_VERBOSE >= CS_LOG_FINAL_DEPTH
-#if CONFIG_OUTPUT_JSON
             SearchAnalysis::PauseClock();
-#endif
 #if __EMSCRIPTEN__
             std::cout << "BDBFS Final Depth: " << depthFromStart + depthFromFinal << std::endl;
 #else
@@ -421,23 +758,12 @@ std::vector<const Configuration*> ConfigurationSpace::BiDirectionalBFS(BDConfigu
             << "States Processed: " << statesProcessed << std::endl
             << Lattice::ToString() << std::endl;
 #endif
-#if CONFIG_OUTPUT_JSON
-            SearchAnalysis::EnterGraph("BDBFSDepthOverTime");
-            SearchAnalysis::InsertTimePoint(depthFromStart + depthFromFinal);
-            SearchAnalysis::EnterGraph("BDBFSStartDepthOverTime");
-            SearchAnalysis::InsertTimePoint(depthFromStart);
-            SearchAnalysis::EnterGraph("BDBFSFinalDepthOverTime");
-            SearchAnalysis::InsertTimePoint(depthFromFinal);
-            SearchAnalysis::EnterGraph("BDBFSStatesVisitedOverTime");
-            SearchAnalysis::InsertTimePoint(statesProcessed);
-            SearchAnalysis::EnterGraph("BDBFSStatesDiscoveredOverTime");
-            SearchAnalysis::InsertTimePoint(visited.size());
-#endif
+            recordSample();
 #endif
             if (current->GetOrigin() == START) {
                 return FindPath(start, current);
             }
-            return FindPath(final, current, false);
+            return JoinBDPath(start, final, start, current);
         }
 #if !CONFIG_PARALLEL_MOVES
         auto adjList = current->MakeAllMoves();
@@ -445,17 +771,19 @@ std::vector<const Configuration*> ConfigurationSpace::BiDirectionalBFS(BDConfigu
         auto adjList = MoveManager::MakeAllParallelMoves(visited);
 #endif
         statesProcessed++;
-        for (const auto& moduleInfo : adjList) {
+        for (const auto& delta : adjList) {
+            HashedState hashedState(current->GetHash(), delta);
 #if !CONFIG_PARALLEL_MOVES
-            if (visited.find(HashedState(moduleInfo)) == visited.end()) {
+            const auto found = PROFILE_EXPR(PROFILE_VISITED_PROBE, visited.find(hashedState));
+            if (found == visited.end()) {
 #endif
-                auto nextConfiguration = current->AddEdge(moduleInfo);
+                auto nextConfiguration = current->AddEdge(hashedState);
                 nextConfiguration->SetParent(current);
                 q.push(nextConfiguration);
                 nextConfiguration->depth = current->depth + 1;
 #if !CONFIG_PARALLEL_MOVES
-                visited.insert(nextConfiguration->GetHash());
-            } else if (static_cast<const BDConfiguration *>(visited.find(HashedState(moduleInfo))->FoundAt())-> // NOLINT Trust me, it will be BDConfiguration
+                PROFILE_EXPR(PROFILE_VISITED_PROBE, visited.insert(nextConfiguration->GetHash()));
+            } else if (static_cast<const BDConfiguration *>(found->FoundAt())-> // NOLINT Trust me, it will be BDConfiguration
                        GetOrigin() != current->GetOrigin()) {
                 if ((q.front()->GetOrigin() == START && q.front()->depth != depthFromStart) ||
                     (q.front()->GetOrigin() == END && q.front()->depth != depthFromFinal)) {
@@ -466,9 +794,7 @@ std::vector<const Configuration*> ConfigurationSpace::BiDirectionalBFS(BDConfigu
                     }
                 }
 #if CONFIG_VERBOSE >= CS_LOG_FINAL_DEPTH
-#if CONFIG_OUTPUT_JSON
                 SearchAnalysis::PauseClock();
-#endif
 #if __EMSCRIPTEN__
                 std::cout << "BDBFS Final Depth: " << depthFromStart + depthFromFinal << std::endl;
 #else
@@ -480,29 +806,15 @@ std::vector<const Configuration*> ConfigurationSpace::BiDirectionalBFS(BDConfigu
                 << "States Processed: " << statesProcessed << std::endl
                 << Lattice::ToString() << std::endl;
 #endif
-#if CONFIG_OUTPUT_JSON
-                SearchAnalysis::EnterGraph("BDBFSDepthOverTime");
-                SearchAnalysis::InsertTimePoint(depthFromStart + depthFromFinal);
-                SearchAnalysis::EnterGraph("BDBFSStartDepthOverTime");
-                SearchAnalysis::InsertTimePoint(depthFromStart);
-                SearchAnalysis::EnterGraph("BDBFSFinalDepthOverTime");
-                SearchAnalysis::InsertTimePoint(depthFromFinal);
-                SearchAnalysis::EnterGraph("BDBFSStatesVisitedOverTime");
-                SearchAnalysis::InsertTimePoint(statesProcessed);
-                SearchAnalysis::EnterGraph("BDBFSStatesDiscoveredOverTime");
-                SearchAnalysis::InsertTimePoint(visited.size());
-#endif
+                recordSample();
 #endif
-                std::vector<const Configuration*> path, pathRemainder;
                 if (current->GetOrigin() == START) {
-                    path = FindPath(start, current);
-                    pathRemainder = FindPath(final, visited.find(HashedState(moduleInfo))->FoundAt(), false);
-                } else {
-                    path = FindPath(start, visited.find(HashedState(moduleInfo))->FoundAt());
-                    pathRemainder = FindPath(final, current, false);
+                    return JoinBDPath(start, final, AddRecordedEdge(current, hashedState), found->FoundAt());
                 }
-                path.insert(path.end(), pathRemainder.begin(), pathRemainder.end());
-                return path;
+                // The configuration found from the start is only ever changed by adding successors to it
+                const auto startSide = const_cast<Configuration*>(found->FoundAt()); // NOLINT
+                startSide->LoadIntoLattice();
+                return JoinBDPath(start, final, AddInverseEdge(startSide, delta.moves), current);
             } else {
                 dupesAvoided++;
             }
@@ -526,16 +838,18 @@ void Configuration::SetCost(const int cost) {
     this->cost = cost;
 }
 
-template <typename Heuristic>
-auto Configuration::CompareConfiguration(const Configuration* final, Heuristic heuristic) {
-    return [final, heuristic](Configuration* c1, Configuration* c2) {
-#if CONFIG_PARALLEL_MOVES
-        const float cost1 = c1->GetCost() + (c1->*heuristic)(final) / ModuleIdManager::MinStaticID();
-        const float cost2 = c2->GetCost() + (c2->*heuristic)(final) / ModuleIdManager::MinStaticID();
-#else
-        const float cost1 = c1->GetCost() + (c1->*heuristic)(final);
-        const float cost2 = c2->GetCost() + (c2->*heuristic)(final);
-#endif
+float Configuration::GetEstimate() const {
+    return estimate;
+}
+
+void Configuration::SetEstimate(const float estimate) {
+    this->estimate = estimate;
+}
+
+auto Configuration::CompareConfiguration() {
+    return [](const Configuration* c1, const Configuration* c2) {
+        const float cost1 = c1->GetCost() + c1->GetEstimate();
+        const float cost2 = c2->GetCost() + c2->GetEstimate();
         return (cost1 == cost2) ? c1->GetCost() > c2->GetCost() : cost1 > cost2;
     };
 }
@@ -632,7 +946,13 @@ float Configuration::TrueChebyshevDistance(const Configuration *final) const {
 
 float Configuration::CacheChebyshevDistance(const Configuration *final) const {
     constexpr int MAX_MOVE_DISTANCE = 2;
+    // Caches are indexed by lattice position, so they are rebuilt whenever the lattice is resized
+    static std::size_t generation = Lattice::Generation();
     static ChebyshevHeuristicCache cache(final->GetModData());
+    if (generation != Lattice::Generation()) {
+        generation = Lattice::Generation();
+        cache = ChebyshevHeuristicCache(final->GetModData());
+    }
     float h = 0;
     for (const auto& modData : hash.GetState()) {
         h += cache[modData.Coords()];
@@ -641,7 +961,12 @@ float Configuration::CacheChebyshevDistance(const Configuration *final) const {
 }
 
 float Configuration::CacheMoveOffsetDistance(const Configuration *final) const {
+    static std::size_t generation = Lattice::Generation();
     static MoveOffsetHeuristicCache cache(final->GetModData());
+    if (generation != Lattice::Generation()) {
+        generation = Lattice::Generation();
+        cache = MoveOffsetHeuristicCache(final->GetModData());
+    }
     float h = 0;
     for (const auto& modData : hash.GetState()) {
         h += cache[modData.Coords()];
@@ -650,7 +975,12 @@ float Configuration::CacheMoveOffsetDistance(const Configuration *final) const {
 }
 
 float Configuration::CacheMoveOffsetPropertyDistance(const Configuration *final) const {
+    static std::size_t generation = Lattice::Generation();
     static MoveOffsetPropertyHeuristicCache cache(final->GetModData());
+    if (generation != Lattice::Generation()) {
+        generation = Lattice::Generation();
+        cache = MoveOffsetPropertyHeuristicCache(final->GetModData());
+    }
     float h = 0;
     for (const auto& modData : hash.GetState()) {
         h += cache(modData.Coords(), modData.Properties().AsInt());
@@ -676,14 +1006,24 @@ MoveOffsetPropertyHeuristicCache BDPropertyCacheHelper(const BDConfiguration* in
 
 float BDConfiguration::BDCacheMoveOffsetDistance(const Configuration* final) const {
     if (static_cast<const BDConfiguration*>(final)->GetOrigin() == START) { // NOLINT
+        static std::size_t generation = Lattice::Generation();
         static MoveOffsetHeuristicCache cache(BDCacheHelper(this, final));
+        if (generation != Lattice::Generation()) {
+            generation = Lattice::Generation();
+            cache = MoveOffsetHeuristicCache(BDCacheHelper(this, final));
+        }
         float h = 0;
         for (const auto& modData : hash.GetState()) {
             h += cache[modData.Coords()];
         }
         return h;
     }
+    static std::size_t generation = Lattice::Generation();
     static MoveOffsetHeuristicCache cache(final->GetModData());
+    if (generation != Lattice::Generation()) {
+        generation = Lattice::Generation();
+        cache = MoveOffsetHeuristicCache(final->GetModData());
+    }
     float h = 0;
     for (const auto& modData : hash.GetState()) {
         h += cache[modData.Coords()];
@@ -693,14 +1033,24 @@ float BDConfiguration::BDCacheMoveOffsetDistance(const Configuration* final) con
 
 float BDConfiguration::BDCacheMoveOffsetPropertyDistance(const Configuration* final) const {
     if (static_cast<const BDConfiguration*>(final)->GetOrigin() == START) { // NOLINT
+        static std::size_t generation = Lattice::Generation();
         static MoveOffsetPropertyHeuristicCache cache(BDPropertyCacheHelper(this, final));
+        if (generation != Lattice::Generation()) {
+            generation = Lattice::Generation();
+            cache = MoveOffsetPropertyHeuristicCache(BDPropertyCacheHelper(this, final));
+        }
         float h = 0;
         for (const auto& modData : hash.GetState()) {
             h += cache(modData.Coords(), modData.Properties().AsInt());
         }
         return h;
     }
+    static std::size_t generation = Lattice::Generation();
     static MoveOffsetPropertyHeuristicCache cache(final->GetModData());
+    if (generation != Lattice::Generation()) {
+        generation = Lattice::Generation();
+        cache = MoveOffsetPropertyHeuristicCache(final->GetModData());
+    }
     float h = 0;
     for (const auto& modData : hash.GetState()) {
         h += cache(modData.Coords(), modData.Properties().AsInt());
@@ -709,7 +1059,6 @@ float BDConfiguration::BDCacheMoveOffsetPropertyDistance(const Configuration* fi
 }
 
 std::vector<const Configuration*> ConfigurationSpace::AStar(Configuration* start, const Configuration* final, const std::string& heuristic) {
-#if CONFIG_OUTPUT_JSON
     SearchAnalysis::EnterGraph("AStarDepthOverTime_" + heuristic);
     SearchAnalysis::LabelGraph("A* Depth over Time (" + heuristic + ")");
     SearchAnalysis::LabelAxes("Time (μs)", "Depth");
@@ -731,7 +1080,6 @@ std::vector<const Configuration*> ConfigurationSpace::AStar(Configuration* start
     SearchAnalysis::LabelAxes("Time (μs)", "States discovered");
     SearchAnalysis::SetInterpolationOrder(1);
     SearchAnalysis::StartClock();
-#endif
     int dupesAvoided = 0;
     int statesProcessed = 0;
     int estimatedFinalDepth = 0;
@@ -754,21 +1102,39 @@ std::vector<const Configuration*> ConfigurationSpace::AStar(Configuration* start
     } else {
         hFunc = &Configuration::CacheMoveOffsetPropertyDistance;
     }
-    auto compare = Configuration::CompareConfiguration(final, hFunc);
+    auto compare = Configuration::CompareConfiguration();
     using CompareType = decltype(compare);
-    std::priority_queue<Configuration*, std::vector<Configuration*>, CompareType> pq(compare);
-    std::unordered_set<HashedState> visited;
+    std::priority_queue<Configuration*, OpenVector<Configuration*>, CompareType> pq(compare);
+    VisitedSet visited;
+    // Record a point on every graph of this search, the analysis clock should be paused
+    auto recordSample = [&]() {
+        SearchAnalysis::EnterGraph("AStarDepthOverTime_" + heuristic);
+        SearchAnalysis::InsertTimePoint(depth);
+        SearchAnalysis::EnterGraph("AStarEstimatedDepthOverTime_" + heuristic);
+        SearchAnalysis::InsertTimePoint(estimatedFinalDepth);
+        SearchAnalysis::EnterGraph("AStarEstimatedProgressOverTime_" + heuristic);
+        SearchAnalysis::InsertTimePoint(static_cast<float>(depth) / static_cast<float>(estimatedFinalDepth) * 100);
+        SearchAnalysis::EnterGraph("AStarStatesVisitedOverTime_" + heuristic);
+        SearchAnalysis::InsertTimePoint(statesProcessed);
+        SearchAnalysis::EnterGraph("AStarStatesDiscoveredOverTime_" + heuristic);
+        SearchAnalysis::InsertTimePoint(visited.size());
+        MemoryTracker::RecordSample();
+    };
     start->SetCost(0);
     pq.push(start);
     visited.insert(start->GetHash());
 
     while (!pq.empty()) {
-        Configuration* current = pq.top();
-        Lattice::UpdateFromModuleInfo(current->GetModData());
+        MemoryTracker::CheckBudget();
+        if (SearchAnalysis::SampleDue()) {
+            SearchAnalysis::PauseClock();
+            recordSample();
+            SearchAnalysis::ResumeClock();
+        }
+        Configuration* current = PROFILE_EXPR(PROFILE_HEAP, pq.top());
+        current->Materialize();
 #if CONFIG_VERBOSE > CS_LOG_NONE
-#if CONFIG_OUTPUT_JSON
         SearchAnalysis::PauseClock();
-#endif
 #if CONFIG_CONSISTENT_HEURISTIC_VALIDATOR
 #if CONFIG_PARALLEL_MOVES
         estimatedFinalDepth = current->depth + static_cast<int>((current->*hFunc)(final)) / ModuleIdManager::MinStaticID();
@@ -803,30 +1169,15 @@ std::vector<const Configuration*> ConfigurationSpace::AStar(Configuration* start
                     << "States Processed: " << statesProcessed << std::endl
                     << Lattice::ToString() << std::endl;
 #endif
-#if CONFIG_OUTPUT_JSON
-            SearchAnalysis::EnterGraph("AStarDepthOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(depth);
-            SearchAnalysis::EnterGraph("AStarEstimatedDepthOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(estimatedFinalDepth);
-            SearchAnalysis::EnterGraph("AStarEstimatedProgressOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(static_cast<float>(depth) / static_cast<float>(estimatedFinalDepth) * 100);
-            SearchAnalysis::EnterGraph("AStarStatesVisitedOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(statesProcessed);
-            SearchAnalysis::EnterGraph("AStarStatesDiscoveredOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(visited.size());
-#endif
+            recordSample();
 #endif
         }
-#if CONFIG_OUTPUT_JSON
         SearchAnalysis::ResumeClock();
 #endif
-#endif
-        pq.pop();
+        PROFILE_EXPR(PROFILE_HEAP, pq.pop());
         if (current->GetHash() == final->GetHash()) {
 #if CONFIG_VERBOSE >= CS_LOG_FINAL_DEPTH
-#if CONFIG_OUTPUT_JSON
             SearchAnalysis::PauseClock();
-#endif
 #if CONFIG_PARALLEL_MOVES
             estimatedFinalDepth = current->depth + static_cast<int>((current->*hFunc)(final)) / ModuleIdManager::MinStaticID();
 #else
@@ -842,18 +1193,7 @@ std::vector<const Configuration*> ConfigurationSpace::AStar(Configuration* start
                     << "States Processed: " << statesProcessed << std::endl
                     << Lattice::ToString() << std::endl;
 #endif
-#if CONFIG_OUTPUT_JSON
-            SearchAnalysis::EnterGraph("AStarDepthOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(depth);
-            SearchAnalysis::EnterGraph("AStarEstimatedDepthOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(estimatedFinalDepth);
-            SearchAnalysis::EnterGraph("AStarEstimatedProgressOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(static_cast<float>(depth) / static_cast<float>(estimatedFinalDepth) * 100);
-            SearchAnalysis::EnterGraph("AStarStatesVisitedOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(statesProcessed);
-            SearchAnalysis::EnterGraph("AStarStatesDiscoveredOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(visited.size());
-#endif
+            recordSample();
 #endif
             return FindPath(start, current);
         }
@@ -863,21 +1203,31 @@ std::vector<const Configuration*> ConfigurationSpace::AStar(Configuration* start
         auto adjList = MoveManager::MakeAllParallelMoves(visited);
 #endif
         statesProcessed++;
-        for (const auto& moduleInfo : adjList) {
+        for (const auto& delta : adjList) {
+            HashedState hashedState(current->GetHash(), delta, current->depth + 1);
 #if !CONFIG_PARALLEL_MOVES
-            if (HashedState hashedState(moduleInfo, current->depth + 1); visited.find(hashedState) == visited.end()
-                || hashedState.GetDepth() < visited.find(hashedState)->GetDepth()) {
+            const auto found = PROFILE_EXPR(PROFILE_VISITED_PROBE, visited.find(hashedState));
+            if (found == visited.end() || hashedState.GetDepth() < found->GetDepth()) {
 #endif
-                auto nextConfiguration = current->AddEdge(moduleInfo);
+                auto nextConfiguration = current->AddEdge(hashedState);
                 nextConfiguration->SetParent(current);
                 nextConfiguration->SetCost(current->GetCost() + 1);
-                pq.push(nextConfiguration);
+#if CONFIG_PARALLEL_MOVES
+                nextConfiguration->SetEstimate(PROFILE_EXPR(PROFILE_HEURISTIC, (nextConfiguration->*hFunc)(final)) / ModuleIdManager::MinStaticID());
+#else
+                nextConfiguration->SetEstimate(PROFILE_EXPR(PROFILE_HEURISTIC, (nextConfiguration->*hFunc)(final)));
+#endif
+                PROFILE_EXPR(PROFILE_HEAP, pq.push(nextConfiguration));
                 nextConfiguration->depth = current->depth + 1;
+                if (lazyNodes) {
+                    nextConfiguration->Release();
+                }
 #if !CONFIG_PARALLEL_MOVES
-                if (visited.contains(hashedState)) {
-                    visited.erase(hashedState);
+                PROFILE_SCOPE(PROFILE_VISITED_PROBE);
+                if (found != visited.end()) {
+                    visited.erase(found);
                 }
-                visited.insert(hashedState);
+                visited.insert(nextConfiguration->GetHash());
             } else {
                 dupesAvoided++;
             }
@@ -894,7 +1244,6 @@ std::vector<const Configuration*> ConfigurationSpace::AStar(Configuration* start
 }
 
 std::vector<const Configuration*> ConfigurationSpace::BDAStar(BDConfiguration* start, BDConfiguration* final, const std::string& heuristic) {
-#if CONFIG_OUTPUT_JSON
     SearchAnalysis::EnterGraph("AStarDepthOverTime_" + heuristic);
     SearchAnalysis::LabelGraph("A* Depth over Time (" + heuristic + ")");
     SearchAnalysis::LabelAxes("Time (μs)", "Depth");
@@ -916,7 +1265,6 @@ std::vector<const Configuration*> ConfigurationSpace::BDAStar(BDConfiguration* s
     SearchAnalysis::LabelAxes("Time (μs)", "States discovered");
     SearchAnalysis::SetInterpolationOrder(1);
     SearchAnalysis::StartClock();
-#endif
     int dupesAvoided = 0;
     int statesProcessed = 0;
     int estimatedFinalDepthFromStart = 0;
@@ -945,8 +1293,23 @@ std::vector<const Configuration*> ConfigurationSpace::BDAStar(BDConfiguration* s
     }
     auto compare = BDConfiguration::CompareBDConfiguration(start, final, hFunc);
     using CompareType = decltype(compare);
-    std::priority_queue<BDConfiguration*, std::vector<BDConfiguration*>, CompareType> pq(compare);
-    std::unordered_set<HashedState> visited;
+    std::priority_queue<BDConfiguration*, OpenVector<BDConfiguration*>, CompareType> pq(compare);
+    VisitedSet visited;
+    // Record a point on every graph of this search, the analysis clock should be paused
+    auto recordSample = [&]() {
+        const int currentDepth = depthFromStart + depthFromFinal;
+        SearchAnalysis::EnterGraph("AStarDepthOverTime_" + heuristic);
+        SearchAnalysis::InsertTimePoint(currentDepth);
+        SearchAnalysis::EnterGraph("AStarEstimatedDepthOverTime_" + heuristic);
+        SearchAnalysis::InsertTimePoint(estimatedFinalDepthFromStart);
+        SearchAnalysis::EnterGraph("AStarEstimatedProgressOverTime_" + heuristic);
+        SearchAnalysis::InsertTimePoint(static_cast<float>(currentDepth) / static_cast<float>(estimatedFinalDepthFromStart) * 100);
+        SearchAnalysis::EnterGraph("AStarStatesVisitedOverTime_" + heuristic);
+        SearchAnalysis::InsertTimePoint(statesProcessed);
+        SearchAnalysis::EnterGraph("AStarStatesDiscoveredOverTime_" + heuristic);
+        SearchAnalysis::InsertTimePoint(visited.size());
+        MemoryTracker::RecordSample();
+    };
     start->SetCost(0);
     final->SetCost(0);
     pq.push(start);
@@ -955,12 +1318,16 @@ std::vector<const Configuration*> ConfigurationSpace::BDAStar(BDConfiguration* s
     visited.insert(final->GetHash());
 
     while (!pq.empty()) {
-        BDConfiguration* current = pq.top();
-        Lattice::UpdateFromModuleInfo(current->GetModData());
+        MemoryTracker::CheckBudget();
+        if (SearchAnalysis::SampleDue()) {
+            SearchAnalysis::PauseClock();
+            recordSample();
+            SearchAnalysis::ResumeClock();
+        }
+        BDConfiguration* current = PROFILE_EXPR(PROFILE_HEAP, pq.top());
+        current->LoadIntoLattice();
 #if CONFIG_VERBOSE > CS_LOG_NONE
-#if CONFIG_OUTPUT_JSON
         SearchAnalysis::PauseClock();
-#endif
 #if CONFIG_CONSISTENT_HEURISTIC_VALIDATOR
         if (current->GetOrigin() == START) {
 #if CONFIG_PARALLEL_MOVES
@@ -1028,31 +1395,16 @@ std::vector<const Configuration*> ConfigurationSpace::BDAStar(BDConfiguration* s
                     << "States Processed: " << statesProcessed << std::endl
                     << Lattice::ToString() << std::endl;
 #endif
-#if CONFIG_OUTPUT_JSON
-            SearchAnalysis::EnterGraph("AStarDepthOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(depth);
-            SearchAnalysis::EnterGraph("AStarEstimatedDepthOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(estimatedFinalDepth);
-            SearchAnalysis::EnterGraph("AStarEstimatedProgressOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(static_cast<float>(depth) / static_cast<float>(estimatedFinalDepth) * 100);
-            SearchAnalysis::EnterGraph("AStarStatesVisitedOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(statesProcessed);
-            SearchAnalysis::EnterGraph("AStarStatesDiscoveredOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(visited.size());
-#endif
+            recordSample();
 #endif
         }
-#if CONFIG_OUTPUT_JSON
         SearchAnalysis::ResumeClock();
 #endif
-#endif
-        pq.pop();
+        PROFILE_EXPR(PROFILE_HEAP, pq.pop());
         if ((current->GetOrigin() == START && current->GetHash() == final->GetHash()) ||
             (current->GetOrigin() == END && current->GetHash() == start->GetHash())) {
 #if CONFIG_VERBOSE >= CS_LOG_FINAL_DEPTH
-#if CONFIG_OUTPUT_JSON
             SearchAnalysis::PauseClock();
-#endif
             if (current->GetOrigin() == START) {
 #if CONFIG_PARALLEL_MOVES
                 estimatedFinalDepthFromStart = current->depth + static_cast<int>((current->*hFunc)(final)) / ModuleIdManager::MinStaticID();
@@ -1083,23 +1435,12 @@ std::vector<const Configuration*> ConfigurationSpace::BDAStar(BDConfiguration* s
                     << "States Processed: " << statesProcessed << std::endl
                     << Lattice::ToString() << std::endl;
 #endif
-#if CONFIG_OUTPUT_JSON
-            SearchAnalysis::EnterGraph("AStarDepthOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(depth);
-            SearchAnalysis::EnterGraph("AStarEstimatedDepthOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(estimatedFinalDepth);
-            SearchAnalysis::EnterGraph("AStarEstimatedProgressOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(static_cast<float>(depth) / static_cast<float>(estimatedFinalDepth) * 100);
-            SearchAnalysis::EnterGraph("AStarStatesVisitedOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(statesProcessed);
-            SearchAnalysis::EnterGraph("AStarStatesDiscoveredOverTime_" + heuristic);
-            SearchAnalysis::InsertTimePoint(visited.size());
-#endif
+            recordSample();
 #endif
             if (current->GetOrigin() == START) {
                 return FindPath(start, current);
             }
-            return FindPath(final, current, false);
+            return JoinBDPath(start, final, start, current);
         }
 #if !CONFIG_PARALLEL_MOVES
         auto adjList = current->MakeAllMoves();
@@ -1107,18 +1448,20 @@ std::vector<const Configuration*> ConfigurationSpace::BDAStar(BDConfiguration* s
         auto adjList = MoveManager::MakeAllParallelMoves(visited);
 #endif
         statesProcessed++;
-        for (const auto& moduleInfo : adjList) {
+        for (const auto& delta : adjList) {
+            HashedState hashedState(current->GetHash(), delta);
 #if !CONFIG_PARALLEL_MOVES
-            if (visited.find(HashedState(moduleInfo)) == visited.end()) {
+            const auto found = PROFILE_EXPR(PROFILE_VISITED_PROBE, visited.find(hashedState));
+            if (found == visited.end()) {
 #endif
-                auto nextConfiguration = current->AddEdge(moduleInfo);
+                auto nextConfiguration = current->AddEdge(hashedState);
                 nextConfiguration->SetParent(current);
                 nextConfiguration->SetCost(current->GetCost() + 1);
-                pq.push(nextConfiguration);
+                PROFILE_EXPR(PROFILE_HEAP, pq.push(nextConfiguration));
                 nextConfiguration->depth = current->depth + 1;
 #if !CONFIG_PARALLEL_MOVES
-                visited.insert(nextConfiguration->GetHash());
-            } else if (static_cast<const BDConfiguration *>(visited.find(HashedState(moduleInfo))->FoundAt())-> // NOLINT Trust me, it will be BDConfiguration
+                PROFILE_EXPR(PROFILE_VISITED_PROBE, visited.insert(nextConfiguration->GetHash()));
+            } else if (static_cast<const BDConfiguration *>(found->FoundAt())-> // NOLINT Trust me, it will be BDConfiguration
                     GetOrigin() != current->GetOrigin()) {
                 if ((current->GetOrigin() == START && current->depth != depthFromStart) ||
                     (current->GetOrigin() == END && current->depth != depthFromFinal)) {
@@ -1129,9 +1472,7 @@ std::vector<const Configuration*> ConfigurationSpace::BDAStar(BDConfiguration* s
                     }
                 }
 #if CONFIG_VERBOSE >= CS_LOG_FINAL_DEPTH
-#if CONFIG_OUTPUT_JSON
                 SearchAnalysis::PauseClock();
-#endif
                 if (current->GetOrigin() == START) {
 #if CONFIG_PARALLEL_MOVES
                     estimatedFinalDepthFromStart = current->depth + static_cast<int>((current->*hFunc)(final)) / ModuleIdManager::MinStaticID();
@@ -1162,38 +1503,24 @@ std::vector<const Configuration*> ConfigurationSpace::BDAStar(BDConfiguration* s
                         << "States Processed: " << statesProcessed << std::endl
                         << Lattice::ToString() << std::endl;
 #endif
-#if CONFIG_OUTPUT_JSON
-                SearchAnalysis::EnterGraph("AStarDepthOverTime_" + heuristic);
-                SearchAnalysis::InsertTimePoint(depth);
-                SearchAnalysis::EnterGraph("AStarEstimatedDepthOverTime_" + heuristic);
-                SearchAnalysis::InsertTimePoint(estimatedFinalDepth);
-                SearchAnalysis::EnterGraph("AStarEstimatedProgressOverTime_" + heuristic);
-                SearchAnalysis::InsertTimePoint(static_cast<float>(depth) / static_cast<float>(estimatedFinalDepth) * 100);
-                SearchAnalysis::EnterGraph("AStarStatesVisitedOverTime_" + heuristic);
-                SearchAnalysis::InsertTimePoint(statesProcessed);
-                SearchAnalysis::EnterGraph("AStarStatesDiscoveredOverTime_" + heuristic);
-                SearchAnalysis::InsertTimePoint(visited.size());
+                recordSample();
 #endif
-#endif
-                std::vector<const Configuration*> path, pathRemainder;
                 if (current->GetOrigin() == START) {
-                    path = FindPath(start, current);
-                    pathRemainder = FindPath(final, visited.find(HashedState(moduleInfo))->FoundAt(), false);
-                } else {
-                    path = FindPath(start, visited.find(HashedState(moduleInfo))->FoundAt());
-                    pathRemainder = FindPath(final, current, false);
+                    return JoinBDPath(start, final, AddRecordedEdge(current, hashedState), found->FoundAt());
                 }
-                path.insert(path.end(), pathRemainder.begin(), pathRemainder.end());
-                return path;
-            } else if (HashedState hashedState(moduleInfo, current->depth + 1); hashedState.GetDepth() < visited.find(hashedState)->GetDepth()) {
-                auto nextConfiguration = current->AddEdge(moduleInfo);
+                // The configuration found from the start is only ever changed by adding successors to it
+                const auto startSide = const_cast<Configuration*>(found->FoundAt()); // NOLINT
+                startSide->LoadIntoLattice();
+                return JoinBDPath(start, final, AddInverseEdge(startSide, delta.moves), current);
+            } else if (current->depth + 1 < found->GetDepth()) {
+                auto nextConfiguration = current->AddEdge(hashedState);
                 nextConfiguration->SetParent(current);
                 nextConfiguration->SetCost(current->GetCost() + 1);
-                pq.push(nextConfiguration);
+                PROFILE_EXPR(PROFILE_HEAP, pq.push(nextConfiguration));
                 nextConfiguration->depth = current->depth + 1;
                 hashedState.SetFounder(nextConfiguration);
                 hashedState.SetDepth(nextConfiguration->depth);
-                visited.insert(hashedState);
+                PROFILE_EXPR(PROFILE_VISITED_PROBE, visited.insert(hashedState));
             } else {
                 dupesAvoided++;
             }
@@ -1224,9 +1551,16 @@ std::vector<const Configuration*> ConfigurationSpace::FindPath(const Configurati
 }
 
 Configuration ConfigurationSpace::GenerateRandomFinal(const int targetMoves) {
-    std::unordered_set<HashedState> visited;
+    return GenerateRandomFinal(targetMoves, std::random_device{}());
+}
+
+Configuration ConfigurationSpace::GenerateRandomFinal(const int targetMoves, const std::uint_fast32_t seed) {
+    std::mt19937 rng(seed);
+    VisitedSet visited;
     const std::set<ModuleData> initialState = Lattice::GetModuleInfo();
     std::set<ModuleData> nextState;
+    // Don't let the walk return to where it started
+    visited.insert(HashedState(initialState));
 
     for (int i = 0; i < targetMoves; i++) {
         // Get current configuration
@@ -1238,17 +1572,20 @@ Configuration ConfigurationSpace::GenerateRandomFinal(const int targetMoves) {
         auto adjList = current.MakeAllMoves();
 #endif
         // Shuffle the adjacent configurations
-        std::shuffle(adjList.begin(), adjList.end(), std::mt19937{std::random_device{}()});
+        std::shuffle(adjList.begin(), adjList.end(), rng);
         // Search through shuffled configurations until an unvisited one is found
         nextState = {};
 #if CONFIG_PARALLEL_MOVES
         if (!adjList.empty()) {
-            nextState = adjList.front();
+            HashedState state(current.GetHash(), adjList.front());
+            state.Materialize();
+            nextState = state.GetState();
         }
 #else
-        for (const auto& state: adjList) {
-            if (visited.find(HashedState(state)) == visited.end()) {
-                nextState = state;
+        for (const auto& delta: adjList) {
+            if (HashedState state(current.GetHash(), delta); visited.find(state) == visited.end()) {
+                state.Materialize();
+                nextState = state.GetState();
                 break;
             }
         }
@@ -1268,4 +1605,53 @@ Configuration ConfigurationSpace::GenerateRandomFinal(const int targetMoves) {
     // Reset lattice to original state and return
     Lattice::UpdateFromModuleInfo(initialState);
     return Configuration(nextState);
-}
\ No newline at end of file
+}
+
+SearchResult ConfigurationSpace::Search(std::set<ModuleData> startData, std::set<ModuleData> endData,
+                                        const std::string& method, const std::string& heuristic) {
+    SearchResult result;
+    while (true) {
+        // Drop the trees of an aborted attempt before resetting, so that nothing it recorded carries over
+        result.start.reset();
+        result.bidirectionalStart.reset();
+        result.end.reset();
+        result.bidirectionalEnd.reset();
+        SearchAnalysis::ClearData();
+        Profiler::Reset();
+        Configuration::ResetSwitchStats();
+        MemoryTracker::ResetPeaks();
+        const auto timeBegin = std::chrono::high_resolution_clock::now();
+        result.start = std::make_unique<Configuration>(startData);
+        result.bidirectionalStart = std::make_unique<BDConfiguration>(startData, START);
+        result.end = std::make_unique<Configuration>(endData);
+        result.bidirectionalEnd = std::make_unique<BDConfiguration>(endData, END);
+        try {
+            if (method.empty() || method == "A*" || method == "a*") {
+                result.path = AStar(result.start.get(), result.end.get(), heuristic);
+            } else if (method == "BDA*" || method == "bda*") {
+                result.path = BDAStar(result.bidirectionalStart.get(), result.bidirectionalEnd.get(), heuristic);
+            } else if (method == "BDBFS" || method == "bdbfs") {
+                result.path = BiDirectionalBFS(result.bidirectionalStart.get(), result.bidirectionalEnd.get());
+            } else if (method == "BFS" || method == "bfs") {
+                result.path = BFS(result.start.get(), result.end.get());
+            }
+            const auto timeEnd = std::chrono::high_resolution_clock::now();
+            result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(timeEnd - timeBegin);
+            return result;
+        } catch (LatticeEdgeExcept& latticeEdgeExcept) {
+            const int shift = LatticeSetup::GrowLattice(2 * LatticeSetup::preInitData.reach + MoveManager::MaxDistance());
+            std::cout << latticeEdgeExcept.what() << " Growing lattice reach to " << LatticeSetup::preInitData.reach
+                      << " and restarting search..." << std::endl;
+            const auto shiftStates = [shift](std::set<ModuleData>& modData) {
+                std::set<ModuleData> shifted;
+                for (const auto& data : modData) {
+                    shifted.emplace(data.Coords() + shift, data.Properties());
+                }
+                modData = std::move(shifted);
+            };
+            shiftStates(startData);
+            shiftStates(endData);
+            result.restarts++;
+        }
+    }
+}
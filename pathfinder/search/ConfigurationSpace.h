@@ -1,8 +1,15 @@
 #ifndef MODULAR_ROBOTICS_CONFIGURATIONSPACE_H
 #define MODULAR_ROBOTICS_CONFIGURATIONSPACE_H
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_set>
 #include <vector>
 #include "../lattice/Lattice.h"
+#include "MemoryTracker.h"
 
 // Verbosity Constants (Don't change these)
 #define CS_LOG_NONE 0
@@ -30,14 +37,26 @@
 #define CONFIG_CONSISTENT_HEURISTIC_VALIDATOR true
 #endif
 /* JSON Output Configuration
- * In order to output JSON successfully logging must be enabled for every depth
+ * When enabled, search analysis is recorded by default without needing to pass -r or -t at runtime.
+ * Points are sampled at a fixed interval, with extra points whenever depth changes if logging is enabled for every depth
  */
 #ifndef CONFIG_OUTPUT_JSON
 #define CONFIG_OUTPUT_JSON false
 #endif
-#if (CONFIG_VERBOSE != CS_LOG_EVERY_DEPTH || !CONFIG_CONSISTENT_HEURISTIC_VALIDATOR) && CONFIG_OUTPUT_JSON
-#warning "JSON output disabled due to insufficient logging!"
-#define CONFIG_OUTPUT_JSON false
+/* Hash Verification Configuration
+ * Enabling this will cause an exception to be thrown if the incrementally updated hash of a state doesn't match the
+ * hash computed from its full module data. Set by the VERIFY_HASHES CMake option.
+ */
+#ifndef CONFIG_VERIFY_HASHES
+#define CONFIG_VERIFY_HASHES false
+#endif
+
+/* Lattice Switch Configuration
+ * When the lattice moves between configurations at most this many search tree edges apart, it is updated by undoing
+ * and replaying the moves between them instead of being rebuilt from module data. Set to 0 to always rebuild.
+ */
+#ifndef CONFIG_LATTICE_SWITCH_DISTANCE
+#define CONFIG_LATTICE_SWITCH_DISTANCE 32
 #endif
 
 class SearchExcept final : std::exception {
@@ -52,24 +71,100 @@ class HeuristicExcept final : public std::exception {
     const char* what() const noexcept override;
 };
 
+class HashExcept final : public std::exception {
+public:
+    [[nodiscard]]
+    const char* what() const noexcept override;
+};
+
+class PathExcept final : public std::exception {
+public:
+    [[nodiscard]]
+    const char* what() const noexcept override;
+};
+
 class Configuration;
 
+class MoveBase;
+
+// A move made by a single module, identified by position since module IDs aren't kept between lattice updates
+struct ModuleMove {
+    // Coordinates of the module before moving
+    std::valarray<int> from;
+    const MoveBase* move;
+};
+
+// Describes the difference between a configuration and one of its successors
+struct StateDelta {
+    // Move made by each moving module
+    std::vector<ModuleMove> moves;
+    // Module data present in the parent state but not in the successor
+    std::vector<ModuleData> removed;
+    // Module data present in the successor but not in the parent state
+    std::vector<ModuleData> added;
+};
+
 // For comparing the state of a lattice and a configuration
 class HashedState {
 private:
-    size_t seed;
+    // Zobrist hash of module data
+    std::uint64_t seed;
     std::set<ModuleData> moduleData;
     const Configuration* foundAt;
     int depth;
+    // Parent state and delta, only set while the state has not been materialized
+    const HashedState* parentState = nullptr;
+    const StateDelta* delta = nullptr;
+    // Set when module data has been dropped, released states keep their own copy of the delta from their parent so
+    // they can still be compared exactly
+    bool released = false;
+    std::shared_ptr<const StateDelta> releasedDelta;
+
+    [[nodiscard]]
+    bool MatchesDelta(const HashedState& parent, const StateDelta& stateDelta) const;
+
+    // Get module data, building it from the parent state and delta if the state hasn't been materialized
+    [[nodiscard]]
+    std::set<ModuleData> BuildState() const;
+
+    // Check seed against a full recompute, only does anything when CONFIG_VERIFY_HASHES is enabled
+    void VerifySeed() const;
+
+    // Charge (or refund, for a negative count) the estimated size of module data to the memory tracker, does nothing
+    // when CONFIG_TRACK_MODULE_DATA already tracks every module data object
+    static void TrackModuleData(std::int64_t modules);
 public:
     HashedState() = delete;
 
     explicit HashedState(const std::set<ModuleData>& modData, int depth = 0);
 
+    // Construct a successor state without copying module data, parent and delta must outlive it until materialized
+    HashedState(const HashedState& parent, const StateDelta& stateDelta, int depth = 0);
+
+    // Copies are materialized unless the original was released
     HashedState(const HashedState& other);
 
+    HashedState& operator=(const HashedState& other) = delete;
+
+    ~HashedState();
+
+    // Build the full module data for a state constructed from a delta
+    void Materialize();
+
+    // Drop module data, keeping the seed and the difference from the parent state, which must stay materialized
+    void Release(const HashedState& parent);
+
+    // Replace the module data of a released state
+    void Restore(const std::set<ModuleData>& modData);
+
     [[nodiscard]]
-    size_t GetSeed() const;
+    bool IsMaterialized() const;
+
+    [[nodiscard]]
+    const StateDelta* GetDelta() const;
+
+    [[nodiscard]]
+    std::uint64_t GetSeed() const;
 
     [[nodiscard]]
     const std::set<ModuleData>& GetState() const;
@@ -94,6 +189,20 @@ struct std::hash<HashedState> {
     size_t operator()(const HashedState& state) const noexcept;
 };
 
+// Set of visited states, memory is attributed to the visited set subsystem
+using VisitedSet = std::unordered_set<HashedState, std::hash<HashedState>, std::equal_to<HashedState>,
+    TrackingAllocator<HashedState, MEM_VISITED>>;
+
+// Counts of how the lattice was moved between configurations, and how many lattice cells each way wrote to
+struct LatticeSwitchStats {
+    // Switches made by undoing and replaying moves
+    std::uint64_t moveSwitches = 0;
+    std::uint64_t moveCellUpdates = 0;
+    // Switches made by rebuilding from module data
+    std::uint64_t rebuilds = 0;
+    std::uint64_t rebuildCellUpdates = 0;
+};
+
 // For tracking the state of a lattice
 class Configuration {
 protected:
@@ -101,20 +210,44 @@ protected:
     std::vector<Configuration*> next;
     HashedState hash;
     int cost;
+    // Cached heuristic value, lets queued configurations be ordered without their module data
+    float estimate = 0;
+    // Moves made to reach this configuration from its parent
+    std::vector<ModuleMove> moves;
+
+    // Configuration the lattice was last switched to, and the lattice revision at that point
+    static const Configuration* latticeConfiguration;
+    static std::size_t latticeRevision;
+    static LatticeSwitchStats switchStats;
+
+    // Estimated memory owned by this configuration, module data is charged by the state it's held in
+    [[nodiscard]]
+    std::size_t MemoryUsage() const;
+
+    // Move the lattice to this configuration through the search tree from the configuration it was last switched to,
+    // returns false and leaves the lattice unchanged if they're too far apart
+    bool SwitchLatticeByMoves() const;
+
+    // Record that the lattice now holds this configuration
+    void MarkInLattice() const;
 public:
     int depth = 0;
 
     explicit Configuration(const std::set<ModuleData>& modData);
 
+    explicit Configuration(const HashedState& state);
+
+    Configuration(const Configuration& other);
+
     virtual ~Configuration();
 
     [[nodiscard]]
-    std::vector<std::set<ModuleData>> MakeAllMoves() const;
+    std::vector<StateDelta> MakeAllMoves() const;
 
     [[nodiscard]]
-    std::vector<std::set<ModuleData>> MakeAllMovesForAllVertices() const;
+    std::vector<StateDelta> MakeAllMovesForAllVertices() const;
 
-    virtual Configuration* AddEdge(const std::set<ModuleData>& modData);
+    virtual Configuration* AddEdge(const HashedState& state);
 
     [[nodiscard]]
     Configuration* GetParent() const;
@@ -128,6 +261,26 @@ public:
     [[nodiscard]]
     const std::set<ModuleData>& GetModData() const;
 
+    [[nodiscard]]
+    const std::vector<ModuleMove>& GetMoves() const;
+
+    // Put this configuration in the lattice, rebuilding module data by replaying moves from the nearest materialized
+    // ancestor if it was released
+    void Materialize();
+
+    // Put this configuration in the lattice, by undoing and replaying moves through the lowest common ancestor with the
+    // configuration the lattice was last switched to when it's within CONFIG_LATTICE_SWITCH_DISTANCE edges, otherwise
+    // by rebuilding from module data
+    void LoadIntoLattice() const;
+
+    [[nodiscard]]
+    static const LatticeSwitchStats& SwitchStats();
+
+    static void ResetSwitchStats();
+
+    // Drop module data until the configuration is materialized again
+    void Release();
+
     void SetParent(Configuration* configuration);
 
     friend std::ostream& operator<<(std::ostream& out, const Configuration& config);
@@ -136,8 +289,12 @@ public:
 
     void SetCost(int cost);
 
-    template <typename Heuristic>
-    static auto CompareConfiguration(const Configuration* final, Heuristic heuristic);
+    [[nodiscard]]
+    float GetEstimate() const;
+
+    void SetEstimate(float estimate);
+
+    static auto CompareConfiguration();
 
     struct ValarrayComparator {
         bool operator()(const std::valarray<int>& lhs, const std::valarray<int>& rhs) const;
@@ -169,9 +326,11 @@ private:
 public:
     explicit BDConfiguration(const std::set<ModuleData>& modData, Origin origin);
 
+    explicit BDConfiguration(const HashedState& state, Origin origin);
+
     Origin GetOrigin() const;
 
-    BDConfiguration* AddEdge(const std::set<ModuleData>& modData) override;
+    BDConfiguration* AddEdge(const HashedState& state) override;
 
     template <typename Heuristic>
     static auto CompareBDConfiguration(const BDConfiguration* start, const BDConfiguration* final, Heuristic heuristic);
@@ -181,9 +340,25 @@ public:
     float BDCacheMoveOffsetPropertyDistance(const Configuration* final) const;
 };
 
+// Search trees and path from ConfigurationSpace::Search, the path points into the trees so they are kept alongside it
+struct SearchResult {
+    std::unique_ptr<Configuration> start;
+    std::unique_ptr<BDConfiguration> bidirectionalStart;
+    std::unique_ptr<Configuration> end;
+    std::unique_ptr<BDConfiguration> bidirectionalEnd;
+    std::vector<const Configuration*> path;
+    // Number of times the search was started over on a larger lattice
+    int restarts = 0;
+    // Time taken by the attempt that finished
+    std::chrono::milliseconds duration {0};
+};
+
 namespace ConfigurationSpace {
     extern int depth;
 
+    // When set, BFS and A* only keep module data for configurations that have been expanded
+    extern bool lazyNodes;
+
     std::vector<const Configuration*> BFS(Configuration* start, const Configuration* final);
 
     std::vector<const Configuration*> BiDirectionalBFS(BDConfiguration* start, BDConfiguration* final);
@@ -195,6 +370,15 @@ namespace ConfigurationSpace {
     std::vector<const Configuration*> FindPath(const Configuration* start, const Configuration* final, bool shouldReverse = true);
 
     Configuration GenerateRandomFinal(int targetMoves = 8);
+
+    // Same initial state and seed always generate the same final state
+    Configuration GenerateRandomFinal(int targetMoves, std::uint_fast32_t seed);
+
+    // Search with "A*", "BDA*", "BDBFS" or "BFS" (empty means A*). The lattice starts out only slightly larger than the
+    // configurations, if a module gets too close to the edge the lattice is grown and the search is started over.
+    // Search analysis, profiling, lattice switch stats and memory peaks are reset for every attempt.
+    SearchResult Search(std::set<ModuleData> startData, std::set<ModuleData> endData, const std::string& method,
+                        const std::string& heuristic);
 }
 
 #endif //MODULAR_ROBOTICS_CONFIGURATIONSPACE_H
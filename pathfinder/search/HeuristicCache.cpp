@@ -3,10 +3,39 @@
 #include <execution>
 #include "../lattice/Lattice.h"
 #include "../moves/MoveManager.h"
+#include "MemoryTracker.h"
 
 constexpr float INVALID_WEIGHT = 999;
 
-IHeuristicCache::IHeuristicCache(): weightCache(Lattice::Order(), Lattice::AxisSize(), INVALID_WEIGHT) {}
+IHeuristicCache::IHeuristicCache(): weightCache(Lattice::AxisSizes(), INVALID_WEIGHT) {
+    TrackMemory();
+}
+
+IHeuristicCache::IHeuristicCache(const IHeuristicCache& other) : weightCache(other.weightCache) {
+    TrackMemory();
+}
+
+IHeuristicCache& IHeuristicCache::operator=(const IHeuristicCache& other) {
+    weightCache = other.weightCache;
+    TrackMemory();
+    return *this;
+}
+
+IHeuristicCache::~IHeuristicCache() {
+    MemoryTracker::Deallocate(MEM_HEURISTIC_CACHE, trackedElementBytes);
+    MemoryTracker::Deallocate(MEM_COORD_TABLES, trackedCoordsBytes);
+}
+
+void IHeuristicCache::TrackMemory() {
+    if (trackedElementBytes != 0) {
+        MemoryTracker::Deallocate(MEM_HEURISTIC_CACHE, trackedElementBytes);
+        MemoryTracker::Deallocate(MEM_COORD_TABLES, trackedCoordsBytes);
+    }
+    trackedElementBytes = weightCache.ElementMemoryUsage();
+    trackedCoordsBytes = weightCache.CoordsMemoryUsage();
+    MemoryTracker::Allocate(MEM_HEURISTIC_CACHE, trackedElementBytes);
+    MemoryTracker::Allocate(MEM_COORD_TABLES, trackedCoordsBytes);
+}
 
 float IHeuristicCache::operator[](const std::valarray<int>& coords) const {
     return weightCache[coords];
@@ -50,7 +79,7 @@ ChebyshevHeuristicCache::ChebyshevHeuristicCache(const std::set<ModuleData>& des
     }
     LOG_NOWASM("Weight Cache:");
     for (int i = 0; i < weightCache.GetArrayInternal().size(); i++) {
-        if (i % Lattice::AxisSize() == 0) LOG_NOWASM(std::endl);
+        if (i % Lattice::AxisSize(0) == 0) LOG_NOWASM(std::endl);
         if (weightCache.GetArrayInternal()[i] < 10) {
             LOG_NOWASM(weightCache.GetArrayInternal()[i]);
         } else if (weightCache.GetArrayInternal()[i] == INVALID_WEIGHT) {
@@ -100,7 +129,7 @@ void ChebyshevEnqueueAdjacentInternal(std::queue<SearchCoord>& coordQueue, const
 }
 
 void EnqueueAdjacentInternal(std::queue<SearchCoord>& coordQueue, const SearchCoord& coordInfo) {
-    static const int maxIdx = static_cast<int>(Lattice::coordTensor.GetArrayInternal().size()) - 1;
+    const int maxIdx = static_cast<int>(Lattice::coordTensor.GetArrayInternal().size()) - 1;
     const int coordIdx = Lattice::coordTensor.IndexFromCoords(coordInfo.coords);
     for (const int idx : Lattice::adjIndices) {
         if (coordIdx + idx < 0 || coordIdx + idx > maxIdx ||
@@ -113,9 +142,9 @@ CoordTensor<int> BuildInternalDistanceCache() {
     if (ModuleIdManager::StaticModules().empty()) {
         // No static modules to use in distance cache
         LOG_NOWASM("No static modules available for distance cache!" << std::endl);
-        return { Lattice::Order(), Lattice::AxisSize(), 0 };
+        return { Lattice::AxisSizes(), 0 };
     }
-    CoordTensor<int> cache(Lattice::Order(), Lattice::AxisSize(), INVALID_WEIGHT);
+    CoordTensor<int> cache(Lattice::AxisSizes(), INVALID_WEIGHT);
     for (const auto& staticModule : ModuleIdManager::StaticModules()) {
         std::queue<SearchCoord> coordQueue;
         coordQueue.push({staticModule.coords, 0});
@@ -151,7 +180,7 @@ CoordTensor<int> BuildInternalDistanceCache() {
     // Print distance tensor
     LOG_NOWASM("Distance Cache:");
     for (int i = 0; i < cache.GetArrayInternal().size(); i++) {
-        if (i % Lattice::AxisSize() == 0) LOG_NOWASM(std::endl);
+        if (i % Lattice::AxisSize(0) == 0) LOG_NOWASM(std::endl);
         if (cache.GetArrayInternal()[i] < 10) {
             LOG_NOWASM(cache.GetArrayInternal()[i]);
         } else if (cache.GetArrayInternal()[i] == INVALID_WEIGHT) {
@@ -171,13 +200,30 @@ CoordTensor<int> BuildInternalDistanceCache() {
     return cache;
 }
 
+const CoordTensor<int>& InternalDistanceCache() {
+    // Static modules move whenever the lattice is resized, so the cache is rebuilt for each lattice generation
+    static std::size_t generation = 0;
+    static CoordTensor<int> cache(1, 1, 0);
+    if (generation != Lattice::Generation()) {
+        if (generation != 0) {
+            MemoryTracker::Deallocate(MEM_HEURISTIC_CACHE, cache.ElementMemoryUsage());
+            MemoryTracker::Deallocate(MEM_COORD_TABLES, cache.CoordsMemoryUsage());
+        }
+        generation = Lattice::Generation();
+        cache = BuildInternalDistanceCache();
+        MemoryTracker::Allocate(MEM_HEURISTIC_CACHE, cache.ElementMemoryUsage());
+        MemoryTracker::Allocate(MEM_COORD_TABLES, cache.CoordsMemoryUsage());
+    }
+    return cache;
+}
+
 #if CONFIG_HEURISTIC_CACHE_HELP_LIMITATIONS
 int MoveOffsetHeuristicCache::currentHelp = 0;
 #endif
 
 void MoveOffsetHeuristicCache::MoveOffsetEnqueueAdjacent(std::queue<SearchCoord>& coordQueue, const SearchCoord& coordInfo) {
 #if CONFIG_HEURISTIC_CACHE_DIST_LIMITATIONS
-    static CoordTensor<int> internalDistanceCache = BuildInternalDistanceCache();
+    const CoordTensor<int>& internalDistanceCache = InternalDistanceCache();
 #endif
     std::vector<std::valarray<int>> adjCoords;
     adjCoords.push_back(coordInfo.coords);
@@ -230,7 +276,7 @@ MoveOffsetHeuristicCache::MoveOffsetHeuristicCache(const std::set<ModuleData>& d
     }
     // Find out which non-static modules can interact
     for (const auto& desiredModuleData : desiredState) {
-        CoordTensor<bool> internalVisitTensor(Lattice::Order(), Lattice::AxisSize(), false);
+        CoordTensor<bool> internalVisitTensor(Lattice::AxisSizes(), false);
         std::queue<SearchCoord> coordQueue;
         coordQueue.push({desiredModuleData.Coords()});
         while (!coordQueue.empty()) {
@@ -284,10 +330,11 @@ MoveOffsetHeuristicCache::MoveOffsetHeuristicCache(const std::set<ModuleData>& d
     for (const auto& mod : ModuleIdManager::FreeModules()) {
         Lattice::coordTensor[mod.coords] = mod.id;
     }
+    MoveManager::ClearLegalMoves();
     // Print weight tensor
     LOG_NOWASM("Weight Cache:");
     for (int i = 0; i < weightCache.GetArrayInternal().size(); i++) {
-        if (i % Lattice::AxisSize() == 0) LOG_NOWASM(std::endl);
+        if (i % Lattice::AxisSize(0) == 0) LOG_NOWASM(std::endl);
         if (weightCache.GetArrayInternal()[i] < 10) {
             LOG_NOWASM(weightCache.GetArrayInternal()[i]);
         } else if (weightCache.GetArrayInternal()[i] == INVALID_WEIGHT) {
@@ -312,7 +359,7 @@ int MoveOffsetPropertyHeuristicCache::currentHelp = 0;
 
 void MoveOffsetPropertyHeuristicCache::MoveOffsetPropertyEnqueueAdjacent(std::queue<SearchCoordProp>& coordPropQueue, const SearchCoordProp& coordPropInfo) {
 #if CONFIG_HEURISTIC_CACHE_DIST_LIMITATIONS
-    static CoordTensor<int> internalDistanceCache = BuildInternalDistanceCache();
+    const CoordTensor<int>& internalDistanceCache = InternalDistanceCache();
 #endif
     std::vector<std::valarray<int>> adjCoords;
     adjCoords.push_back(coordPropInfo.coords);
@@ -355,12 +402,11 @@ MoveOffsetPropertyHeuristicCache::MoveOffsetPropertyHeuristicCache(const std::se
             propIndex++;
         }
     }
-    // Resize weight cache to account for property axis (increase order by 1 and adjust axis size only if necessary)
-    if (propIndex > Lattice::AxisSize()) {
-        weightCache = CoordTensor<float>(Lattice::Order() + 1, propIndex, INVALID_WEIGHT);
-    } else {
-        weightCache = CoordTensor<float>(Lattice::Order() + 1, Lattice::AxisSize(), INVALID_WEIGHT);
-    }
+    // Resize weight cache to account for property axis (increase order by 1, the new axis has one entry per property)
+    std::valarray<int> axisSizes(propIndex, Lattice::Order() + 1);
+    axisSizes[std::slice(0, Lattice::Order(), 1)] = Lattice::AxisSizes();
+    weightCache = CoordTensor<float>(axisSizes, INVALID_WEIGHT);
+    TrackMemory();
     // Temporarily remove non-static modules from lattice
     for (const auto& mod : ModuleIdManager::FreeModules()) {
         Lattice::coordTensor[mod.coords] = FREE_SPACE;
@@ -376,7 +422,7 @@ MoveOffsetPropertyHeuristicCache::MoveOffsetPropertyHeuristicCache(const std::se
     }
     // Find out which non-static modules can interact
     for (const auto& desiredModuleData : desiredState) {
-        CoordTensor<bool> internalVisitTensor(Lattice::Order(), Lattice::AxisSize(), false);
+        CoordTensor<bool> internalVisitTensor(Lattice::AxisSizes(), false);
         std::queue<SearchCoordProp> coordQueue;
         coordQueue.push({desiredModuleData.Coords()});
         while (!coordQueue.empty()) {
@@ -441,7 +487,7 @@ MoveOffsetPropertyHeuristicCache::MoveOffsetPropertyHeuristicCache(const std::se
             }
         }
         if (!reachable && Lattice::coordTensor.GetArrayInternal()[i] <= FREE_SPACE) {
-            Lattice::coordTensor[Lattice::coordTensor.CoordsFromIndex(i)] = OUT_OF_BOUNDS;
+            Lattice::coordTensor.GetElementDirect(i) = OUT_OF_BOUNDS;
         }
     }
 #endif
@@ -449,11 +495,12 @@ MoveOffsetPropertyHeuristicCache::MoveOffsetPropertyHeuristicCache(const std::se
     for (const auto& mod : ModuleIdManager::FreeModules()) {
         Lattice::coordTensor[mod.coords] = mod.id;
     }
+    MoveManager::ClearLegalMoves();
     // Print weight tensor
     auto maxIndex = propIndex * Lattice::coordTensor.GetArrayInternal().size();
     LOG_NOWASM("Weight Cache:");
     for (int i = 0; i < maxIndex; i++) {
-        if (i % Lattice::AxisSize() == 0) LOG_NOWASM(std::endl);
+        if (i % Lattice::AxisSize(0) == 0) LOG_NOWASM(std::endl);
         if (weightCache.GetArrayInternal()[i] < 10) {
             LOG_NOWASM(weightCache.GetArrayInternal()[i]);
         } else if (weightCache.GetArrayInternal()[i] == INVALID_WEIGHT) {
@@ -38,14 +38,25 @@ struct SearchCoord {
 };
 
 class IHeuristicCache {
+private:
+    // Memory currently reported to the memory tracker for weightCache
+    std::size_t trackedElementBytes = 0;
+    std::size_t trackedCoordsBytes = 0;
 protected:
     CoordTensor<float> weightCache;
+
+    // Report memory used by weightCache, must be called again whenever weightCache is replaced
+    void TrackMemory();
 public:
     IHeuristicCache();
 
+    IHeuristicCache(const IHeuristicCache& other);
+
+    IHeuristicCache& operator=(const IHeuristicCache& other);
+
     virtual float operator[](const std::valarray<int>& coords) const;
 
-    virtual ~IHeuristicCache() = default;
+    virtual ~IHeuristicCache();
 };
 
 class ChebyshevHeuristicCache final : public IHeuristicCache {
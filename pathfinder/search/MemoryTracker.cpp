@@ -0,0 +1,137 @@
+#include <iomanip>
+#include "MemoryTracker.h"
+#include "SearchAnalysis.h"
+
+const char* MemoryBudgetExcept::what() const noexcept {
+    return "Search stopped after exceeding memory budget!";
+}
+
+std::array<MemoryTracker::Usage, MEM_SUBSYSTEM_COUNT> MemoryTracker::usage = {};
+
+std::int64_t MemoryTracker::totalBytes = 0;
+
+std::int64_t MemoryTracker::peakTotalBytes = 0;
+
+std::int64_t MemoryTracker::budget = 0;
+
+void MemoryTracker::Allocate(const MemorySubsystem subsystem, const std::size_t bytes, const std::int64_t objects) {
+    auto& [current, count, peak, peakCount] = usage[subsystem];
+    current += static_cast<std::int64_t>(bytes);
+    count += objects;
+    peak = std::max(peak, current);
+    peakCount = std::max(peakCount, count);
+    totalBytes += static_cast<std::int64_t>(bytes);
+    peakTotalBytes = std::max(peakTotalBytes, totalBytes);
+}
+
+void MemoryTracker::Deallocate(const MemorySubsystem subsystem, const std::size_t bytes, const std::int64_t objects) {
+    usage[subsystem].bytes -= static_cast<std::int64_t>(bytes);
+    usage[subsystem].objects -= objects;
+    totalBytes -= static_cast<std::int64_t>(bytes);
+}
+
+void MemoryTracker::SetBudget(const std::size_t bytes) {
+    budget = static_cast<std::int64_t>(bytes);
+}
+
+std::size_t MemoryTracker::Budget() {
+    return budget;
+}
+
+void MemoryTracker::CheckBudget() {
+    if (budget > 0 && totalBytes > budget) {
+        throw MemoryBudgetExcept();
+    }
+}
+
+const MemoryTracker::Usage& MemoryTracker::GetUsage(const MemorySubsystem subsystem) {
+    return usage[subsystem];
+}
+
+std::int64_t MemoryTracker::TotalBytes() {
+    return totalBytes;
+}
+
+std::int64_t MemoryTracker::PeakTotalBytes() {
+    return peakTotalBytes;
+}
+
+void MemoryTracker::ResetPeaks() {
+    for (auto& [bytes, objects, peakBytes, peakObjects] : usage) {
+        peakBytes = bytes;
+        peakObjects = objects;
+    }
+    peakTotalBytes = totalBytes;
+}
+
+const char* MemoryTracker::SubsystemName(const MemorySubsystem subsystem) {
+    switch (subsystem) {
+        case MEM_CONFIGURATIONS:
+            return "Configurations";
+        case MEM_MODULE_DATA:
+            return "ModuleData";
+        case MEM_VISITED:
+            return "VisitedSet";
+        case MEM_OPEN_SET:
+            return "OpenSet";
+        case MEM_HEURISTIC_CACHE:
+            return "HeuristicCache";
+        case MEM_COORD_TENSORS:
+            return "CoordTensors";
+        case MEM_COORD_TABLES:
+            return "CoordTables";
+        default:
+            return "Unknown";
+    }
+}
+
+void MemoryTracker::RecordSample() {
+    if (!SearchAnalysis::Enabled()) {
+        return;
+    }
+    for (int i = 0; i < MEM_SUBSYSTEM_COUNT; i++) {
+        const std::string name = SubsystemName(static_cast<MemorySubsystem>(i));
+        SearchAnalysis::EnterGraph("MemoryOverTime_" + name);
+        SearchAnalysis::LabelGraph(name + " Memory over Time");
+        SearchAnalysis::LabelAxes("Time (μs)", "Bytes");
+        SearchAnalysis::InsertTimePoint(usage[i].bytes);
+    }
+}
+
+void MemoryTracker::Print(std::ostream& out) {
+    constexpr double mib = 1024.0 * 1024.0;
+    out << "Tracked Memory:" << std::endl
+        << std::left << std::setw(18) << "Subsystem" << std::right << std::setw(14) << "Current (MiB)"
+        << std::setw(14) << "Peak (MiB)" << std::setw(14) << "Objects" << std::setw(14) << "Peak Objects" << std::endl;
+    out << std::fixed << std::setprecision(2);
+    for (int i = 0; i < MEM_SUBSYSTEM_COUNT; i++) {
+        const auto& [bytes, objects, peakBytes, peakObjects] = usage[i];
+        out << std::left << std::setw(18) << SubsystemName(static_cast<MemorySubsystem>(i)) << std::right
+            << std::setw(14) << static_cast<double>(bytes) / mib
+            << std::setw(14) << static_cast<double>(peakBytes) / mib
+            << std::setw(14) << objects
+            << std::setw(14) << peakObjects << std::endl;
+    }
+    out << std::left << std::setw(18) << "Total" << std::right
+        << std::setw(14) << static_cast<double>(totalBytes) / mib
+        << std::setw(14) << static_cast<double>(peakTotalBytes) / mib << std::endl;
+    out.unsetf(std::ios_base::floatfield);
+    out << std::setprecision(6);
+}
+
+nlohmann::json MemoryTracker::ToJson() {
+    nlohmann::json memory = nlohmann::json::object();
+    for (int i = 0; i < MEM_SUBSYSTEM_COUNT; i++) {
+        const auto& [bytes, objects, peakBytes, peakObjects] = usage[i];
+        memory[SubsystemName(static_cast<MemorySubsystem>(i))] = {
+            {"Bytes", bytes},
+            {"Objects", objects},
+            {"PeakBytes", peakBytes},
+            {"PeakObjects", peakObjects}
+        };
+    }
+    memory["TotalBytes"] = totalBytes;
+    memory["PeakTotalBytes"] = peakTotalBytes;
+    memory["BudgetBytes"] = budget;
+    return memory;
+}
@@ -0,0 +1,119 @@
+#ifndef MEMORYTRACKER_H
+#define MEMORYTRACKER_H
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <nlohmann/json.hpp>
+
+// Subsystems that memory usage is tracked for
+enum MemorySubsystem {
+    MEM_CONFIGURATIONS = 0,
+    MEM_MODULE_DATA,
+    MEM_VISITED,
+    MEM_OPEN_SET,
+    MEM_HEURISTIC_CACHE,
+    MEM_COORD_TENSORS,
+    MEM_COORD_TABLES,
+    MEM_SUBSYSTEM_COUNT
+};
+
+class MemoryBudgetExcept final : public std::exception {
+public:
+    [[nodiscard]]
+    const char* what() const noexcept override;
+};
+
+// Keeps track of bytes and object counts for each subsystem, figures are only as accurate as what is reported to it
+class MemoryTracker {
+public:
+    struct Usage {
+        std::int64_t bytes = 0;
+        std::int64_t objects = 0;
+        std::int64_t peakBytes = 0;
+        std::int64_t peakObjects = 0;
+    };
+private:
+    static std::array<Usage, MEM_SUBSYSTEM_COUNT> usage;
+    static std::int64_t totalBytes;
+    static std::int64_t peakTotalBytes;
+    // Budget in bytes, 0 for no budget
+    static std::int64_t budget;
+public:
+    MemoryTracker() = delete;
+    MemoryTracker(const MemoryTracker&) = delete;
+
+    static void Allocate(MemorySubsystem subsystem, std::size_t bytes, std::int64_t objects = 1);
+
+    static void Deallocate(MemorySubsystem subsystem, std::size_t bytes, std::int64_t objects = 1);
+
+    // Set a limit on total tracked memory, 0 removes the limit
+    static void SetBudget(std::size_t bytes);
+
+    [[nodiscard]]
+    static std::size_t Budget();
+
+    // Throw MemoryBudgetExcept if tracked memory is over budget
+    static void CheckBudget();
+
+    [[nodiscard]]
+    static const Usage& GetUsage(MemorySubsystem subsystem);
+
+    [[nodiscard]]
+    static std::int64_t TotalBytes();
+
+    [[nodiscard]]
+    static std::int64_t PeakTotalBytes();
+
+    // Lower every peak to current usage
+    static void ResetPeaks();
+
+    // Get name of a subsystem as it appears in output
+    [[nodiscard]]
+    static const char* SubsystemName(MemorySubsystem subsystem);
+
+    // Add current usage of every subsystem to search analysis graphs
+    static void RecordSample();
+
+    // Print current and peak usage of every subsystem
+    static void Print(std::ostream& out);
+
+    // Get current and peak usage in the format used by analysis files
+    [[nodiscard]]
+    static nlohmann::json ToJson();
+};
+
+// Allocator for containers whose memory should be attributed to a subsystem
+template<typename T, MemorySubsystem Subsystem>
+class TrackingAllocator {
+public:
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = TrackingAllocator<U, Subsystem>;
+    };
+
+    TrackingAllocator() = default;
+
+    template<typename U>
+    TrackingAllocator(const TrackingAllocator<U, Subsystem>&) noexcept {}
+
+    // Objects are counted per live allocation, so a node based container counts one object per element
+    T* allocate(const std::size_t n) {
+        MemoryTracker::Allocate(Subsystem, n * sizeof(T));
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, const std::size_t n) noexcept {
+        MemoryTracker::Deallocate(Subsystem, n * sizeof(T));
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const TrackingAllocator<U, Subsystem>&) const noexcept {
+        return true;
+    }
+};
+
+#endif //MEMORYTRACKER_H
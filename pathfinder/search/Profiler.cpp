@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+#include "Profiler.h"
+
+bool Profiler::enabled = false;
+
+namespace {
+    std::mutex registryMutex;
+
+    // Stats of threads that have exited
+    Profiler::Stats retired = {};
+
+    struct ThreadStats;
+
+    std::vector<ThreadStats*>& Registry() {
+        static std::vector<ThreadStats*> registry;
+        return registry;
+    }
+
+    // Each thread accumulates into its own stats, only collecting them needs the lock
+    struct ThreadStats {
+        Profiler::Stats stats = {};
+
+        ThreadStats() {
+            std::lock_guard lock(registryMutex);
+            Registry().push_back(this);
+        }
+
+        ~ThreadStats() {
+            std::lock_guard lock(registryMutex);
+            for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+                retired[i].ns += stats[i].ns;
+                retired[i].calls += stats[i].calls;
+            }
+            std::erase(Registry(), this);
+        }
+    };
+
+    thread_local ThreadStats threadStats;
+}
+
+void Profiler::Record(const ProfilerPhase phase, const std::uint64_t ns) {
+    auto& stats = threadStats.stats[phase];
+    stats.ns += ns;
+    stats.calls++;
+}
+
+void Profiler::Enable(const bool enable) {
+    enabled = enable;
+}
+
+bool Profiler::Enabled() {
+    return enabled;
+}
+
+const char* Profiler::PhaseName(const ProfilerPhase phase) {
+    switch (phase) {
+        case PROFILE_UPDATE_FROM_MODULE_INFO:
+            return "UpdateFromModuleInfo";
+        case PROFILE_BUILD_MOVABLE_MODULES:
+            return "BuildMovableModules";
+        case PROFILE_CHECK_ALL_MOVES:
+            return "CheckAllMoves";
+        case PROFILE_GET_MODULE_INFO:
+            return "GetModuleInfo";
+        case PROFILE_HASHING:
+            return "Hashing";
+        case PROFILE_VISITED_PROBE:
+            return "VisitedProbe";
+        case PROFILE_HEURISTIC:
+            return "Heuristic";
+        case PROFILE_HEAP:
+            return "HeapOps";
+        case PROFILE_SWITCH_LATTICE:
+            return "SwitchLattice";
+        default:
+            return "Unknown";
+    }
+}
+
+Profiler::Stats Profiler::Collect() {
+    std::lock_guard lock(registryMutex);
+    Stats total = retired;
+    for (const auto thread : Registry()) {
+        for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+            total[i].ns += thread->stats[i].ns;
+            total[i].calls += thread->stats[i].calls;
+        }
+    }
+    return total;
+}
+
+void Profiler::Reset() {
+    std::lock_guard lock(registryMutex);
+    retired = {};
+    for (const auto thread : Registry()) {
+        thread->stats = {};
+    }
+}
+
+void Profiler::Print(std::ostream& out) {
+    const auto stats = Collect();
+    out << "Profile (inclusive):" << std::endl
+        << std::left << std::setw(24) << "Phase" << std::right << std::setw(14) << "Time (ms)"
+        << std::setw(14) << "Calls" << std::setw(14) << "ns/call" << std::endl;
+    for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        const auto& [ns, calls] = stats[i];
+        out << std::left << std::setw(24) << PhaseName(static_cast<ProfilerPhase>(i)) << std::right
+            << std::setw(14) << std::fixed << std::setprecision(3) << static_cast<double>(ns) / 1e6
+            << std::setw(14) << calls
+            << std::setw(14) << std::setprecision(1) << (calls == 0 ? 0.0 : static_cast<double>(ns) / calls) << std::endl;
+    }
+    out.unsetf(std::ios_base::floatfield);
+    out << std::setprecision(6);
+}
+
+nlohmann::json Profiler::ToJson() {
+    const auto stats = Collect();
+    nlohmann::json profile = nlohmann::json::object();
+    for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        const auto& [ns, calls] = stats[i];
+        profile[PhaseName(static_cast<ProfilerPhase>(i))] = {
+            {"TimeNs", ns},
+            {"Calls", calls},
+            {"NsPerCall", calls == 0 ? 0.0 : static_cast<double>(ns) / calls}
+        };
+    }
+    return profile;
+}
+
+std::uint64_t Profiler::Calibrate() {
+    constexpr int runs = 3;
+    constexpr std::uint64_t steps = 1 << 20;
+    std::uint64_t best = UINT64_MAX;
+    std::uint64_t sink = 0;
+    for (int run = 0; run < runs; run++) {
+        const auto start = std::chrono::steady_clock::now();
+        std::unordered_set<std::uint64_t> seen;
+        std::vector<std::uint64_t> queue;
+        // splitmix64 stands in for state hashing, the small key range makes roughly half the probes duplicates
+        std::uint64_t x = 0;
+        for (std::uint64_t i = 0; i < steps; i++) {
+            x += 0x9E3779B97F4A7C15;
+            std::uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            z ^= z >> 31;
+            if (seen.insert(z % steps).second) {
+                queue.push_back(z);
+            }
+        }
+        sink += queue.size();
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        best = std::min<std::uint64_t>(best, elapsed.count());
+    }
+    // Keep the workload from being optimized away
+    if (sink == 0) {
+        best++;
+    }
+    return best;
+}
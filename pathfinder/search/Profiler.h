@@ -0,0 +1,114 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <nlohmann/json.hpp>
+
+/* Profiler Configuration
+ * When enabled the profiler is compiled in, it still has to be turned on at runtime to record anything.
+ * Disabling this removes all profiling code from the search.
+ */
+#ifndef CONFIG_PROFILER
+#define CONFIG_PROFILER true
+#endif
+
+// Phases of the search that can be profiled, phases may be nested so times are inclusive
+enum ProfilerPhase {
+    PROFILE_UPDATE_FROM_MODULE_INFO = 0,
+    PROFILE_BUILD_MOVABLE_MODULES,
+    PROFILE_CHECK_ALL_MOVES,
+    PROFILE_GET_MODULE_INFO,
+    PROFILE_HASHING,
+    PROFILE_VISITED_PROBE,
+    PROFILE_HEURISTIC,
+    PROFILE_HEAP,
+    PROFILE_SWITCH_LATTICE,
+    PROFILE_PHASE_COUNT
+};
+
+class Profiler {
+public:
+    struct PhaseStats {
+        std::uint64_t ns = 0;
+        std::uint64_t calls = 0;
+    };
+
+    using Stats = std::array<PhaseStats, PROFILE_PHASE_COUNT>;
+
+    // Times the enclosing scope and adds the result to the current thread's accumulator for a phase
+    class ScopedTimer {
+    private:
+        ProfilerPhase phase;
+        std::chrono::steady_clock::time_point start;
+    public:
+        explicit ScopedTimer(const ProfilerPhase phase) : phase(phase) {
+            if (enabled) {
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+
+        ~ScopedTimer() {
+            if (enabled) {
+                Record(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+            }
+        }
+    };
+private:
+    static bool enabled;
+
+    static void Record(ProfilerPhase phase, std::uint64_t ns);
+public:
+    Profiler() = delete;
+    Profiler(const Profiler&) = delete;
+
+    static void Enable(bool enable);
+
+    [[nodiscard]]
+    static bool Enabled();
+
+    // Get name of a phase as it appears in output
+    [[nodiscard]]
+    static const char* PhaseName(ProfilerPhase phase);
+
+    // Get stats summed over every thread
+    [[nodiscard]]
+    static Stats Collect();
+
+    // Clear stats of every thread
+    static void Reset();
+
+    // Print per-phase breakdown
+    static void Print(std::ostream& out);
+
+    // Get per-phase breakdown in the format used by analysis files
+    [[nodiscard]]
+    static nlohmann::json ToJson();
+
+    // Time a fixed workload resembling the search's hashing and set probing, returns the best of a few runs in
+    // microseconds. Dividing timings by this makes them comparable across machines.
+    [[nodiscard]]
+    static std::uint64_t Calibrate();
+
+    // Time a callable as a phase and return its result
+    template<typename F>
+    static decltype(auto) Time(const ProfilerPhase phase, F&& func) {
+        const ScopedTimer timer(phase);
+        return func();
+    }
+};
+
+#if CONFIG_PROFILER
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(phase) const Profiler::ScopedTimer PROFILE_CONCAT(profilerTimer, __LINE__)(phase)
+#define PROFILE_EXPR(phase, ...) Profiler::Time(phase, [&]() -> decltype(auto) { return __VA_ARGS__; })
+#else
+#define PROFILE_SCOPE(phase)
+#define PROFILE_EXPR(phase, ...) (__VA_ARGS__)
+#endif
+
+#endif //PROFILER_H
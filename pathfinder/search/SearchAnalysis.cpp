@@ -1,68 +1,217 @@
-#include <fstream>
+#include <filesystem>
+#include <iostream>
 #include "SearchAnalysis.h"
 
+TimeSeries::TimeSeries() {
+    buckets.reserve(CONFIG_ANALYSIS_BUCKETS);
+}
+
+void TimeSeries::Downsample() {
+    std::size_t merged = 0;
+    for (std::size_t i = 0; i < buckets.size(); i += 2, merged++) {
+        auto bucket = buckets[i];
+        if (i + 1 < buckets.size()) {
+            const auto& next = buckets[i + 1];
+            bucket.min = std::min(bucket.min, next.min);
+            bucket.max = std::max(bucket.max, next.max);
+            bucket.lastX = next.lastX;
+            bucket.last = next.last;
+            bucket.count += next.count;
+        }
+        buckets[merged] = bucket;
+    }
+    buckets.resize(merged);
+    samplesPerBucket *= 2;
+}
+
+void TimeSeries::Insert(const long long x, const long long y) {
+    if (buckets.size() == CONFIG_ANALYSIS_BUCKETS && buckets.back().count >= samplesPerBucket) {
+        Downsample();
+    }
+    if (!buckets.empty() && buckets.back().count < samplesPerBucket) {
+        auto& bucket = buckets.back();
+        bucket.min = std::min(bucket.min, y);
+        bucket.max = std::max(bucket.max, y);
+        bucket.lastX = x;
+        bucket.last = y;
+        bucket.count++;
+    } else {
+        buckets.push_back({y, y, x, y, 1});
+    }
+}
+
+const std::vector<TimeSeries::Bucket>& TimeSeries::Buckets() const {
+    return buckets;
+}
+
+unsigned long TimeSeries::SamplesPerBucket() const {
+    return samplesPerBucket;
+}
+
+bool SearchAnalysis::enabled = false;
 std::chrono::high_resolution_clock::time_point SearchAnalysis::clock;
 std::chrono::high_resolution_clock::time_point SearchAnalysis::timePaused;
+std::chrono::high_resolution_clock::time_point SearchAnalysis::lastSample;
+std::chrono::milliseconds SearchAnalysis::sampleInterval(CONFIG_ANALYSIS_SAMPLE_INTERVAL);
 nlohmann::json SearchAnalysis::data = nlohmann::json::object();
-nlohmann::basic_json<>* SearchAnalysis::current = nullptr;
-const nlohmann::json SearchAnalysis::emptyGraph = R"(
-{
-    "Title": "Title",
-    "XLabel": "x",
-    "YLabel": "y",
-    "InterpolationOrder": 0,
-    "Points": []
+std::map<std::string, SearchAnalysis::Graph> SearchAnalysis::graphs;
+std::map<std::string, SearchAnalysis::Graph>::iterator SearchAnalysis::current = graphs.end();
+std::ofstream SearchAnalysis::stream;
+std::string SearchAnalysis::streamFile;
+SearchAnalysis::StreamFormat SearchAnalysis::streamFormat = CSV;
+
+void SearchAnalysis::StreamPoint(const long long x, const long long y) {
+    if (!stream.is_open()) {
+        return;
+    }
+    if (streamFormat == CSV) {
+        stream << current->first << ',' << x << ',' << y << '\n';
+    } else {
+        stream << R"({"graph":")" << current->first << R"(","x":)" << x << R"(,"y":)" << y << "}\n";
+    }
+}
+
+void SearchAnalysis::Enable(const bool enable) {
+    enabled = enable;
+}
+
+bool SearchAnalysis::Enabled() {
+    return enabled;
+}
+
+void SearchAnalysis::SetSampleInterval(const std::chrono::milliseconds interval) {
+    sampleInterval = interval;
+}
+
+bool SearchAnalysis::SampleDue() {
+    if (!enabled || sampleInterval.count() <= 0) {
+        return false;
+    }
+    const auto now = std::chrono::high_resolution_clock::now();
+    if (now - lastSample < sampleInterval) {
+        return false;
+    }
+    lastSample = now;
+    return true;
+}
+
+void SearchAnalysis::StreamTo(const std::string& filename) {
+    streamFile = filename;
+    stream.open(filename);
+    if (!stream.is_open()) {
+        std::cerr << "Failed to open time series file: " << filename << std::endl;
+        return;
+    }
+    if (std::filesystem::path(filename).extension() == ".jsonl") {
+        streamFormat = JSONL;
+    } else {
+        streamFormat = CSV;
+        stream << "graph,x,y\n";
+    }
 }
-)"_json;
 
 void SearchAnalysis::StartClock() {
     clock = std::chrono::high_resolution_clock::now();
+    lastSample = clock;
 }
 
 void SearchAnalysis::PauseClock() {
+    if (!enabled) {
+        return;
+    }
     timePaused = std::chrono::high_resolution_clock::now();
 }
 
 void SearchAnalysis::ResumeClock() {
+    if (!enabled) {
+        return;
+    }
     clock += std::chrono::high_resolution_clock::now() - timePaused;
 }
 
 void SearchAnalysis::EnterGraph(const std::string& key) {
-    if (!data.contains(key)) {
-        data[key] = emptyGraph;
+    if (!enabled) {
+        return;
     }
-    current = &(data[key]);
+    current = graphs.try_emplace(key).first;
 }
 
 void SearchAnalysis::LabelGraph(const std::string& title) {
-    (*current)["Title"] = title;
+    if (!enabled) {
+        return;
+    }
+    current->second.title = title;
 }
 
 void SearchAnalysis::LabelAxes(const std::string& xLabel, const std::string& yLabel) {
-    (*current)["XLabel"] = xLabel;
-    (*current)["YLabel"] = yLabel;
+    if (!enabled) {
+        return;
+    }
+    current->second.xLabel = xLabel;
+    current->second.yLabel = yLabel;
 }
 
-void SearchAnalysis::SetInterpolationOrder(int order) {
-    (*current)["InterpolationOrder"] = order;
+void SearchAnalysis::SetInterpolationOrder(const int order) {
+    if (!enabled) {
+        return;
+    }
+    current->second.interpolationOrder = order;
 }
 
-void SearchAnalysis::InsertPoint(unsigned long x, unsigned long y) {
-    (*current)["Points"].push_back({x, y});
+void SearchAnalysis::InsertPoint(const unsigned long x, const unsigned long y) {
+    if (!enabled) {
+        return;
+    }
+    current->second.series.Insert(x, y);
+    StreamPoint(x, y);
 }
 
-void SearchAnalysis::InsertTimePoint(unsigned long y) {
-    long t = std::chrono::duration_cast<std::chrono::microseconds>(timePaused - clock).count();
-    (*current)["Points"].push_back({t, y});
+void SearchAnalysis::InsertTimePoint(const unsigned long y) {
+    if (!enabled) {
+        return;
+    }
+    const long long t = std::chrono::duration_cast<std::chrono::microseconds>(timePaused - clock).count();
+    current->second.series.Insert(t, y);
+    StreamPoint(t, y);
 }
 
+void SearchAnalysis::InsertData(const std::string& key, const nlohmann::json& value) {
+    data[key] = value;
+}
 
 void SearchAnalysis::ExportData(const std::string& filename) {
-    std::ofstream out(filename);
-    out << data.dump(2);
+    if (stream.is_open()) {
+        stream.flush();
+    }
+    nlohmann::json out = data;
+    for (const auto& [key, graph] : graphs) {
+        nlohmann::json points = nlohmann::json::array();
+        nlohmann::json ranges = nlohmann::json::array();
+        for (const auto& bucket : graph.series.Buckets()) {
+            points.push_back({bucket.lastX, bucket.last});
+            ranges.push_back({bucket.min, bucket.max});
+        }
+        out[key] = {
+            {"Title", graph.title},
+            {"XLabel", graph.xLabel},
+            {"YLabel", graph.yLabel},
+            {"InterpolationOrder", graph.interpolationOrder},
+            {"SamplesPerPoint", graph.series.SamplesPerBucket()},
+            {"Points", points},
+            {"Ranges", ranges}
+        };
+    }
+    std::ofstream file(filename);
+    file << out.dump(2);
 }
 
 void SearchAnalysis::ClearData() {
     data.clear();
-    current = nullptr;
+    graphs.clear();
+    current = graphs.end();
+    if (stream.is_open()) {
+        // Reopening truncates the file and writes the header again
+        stream.close();
+        StreamTo(streamFile);
+    }
 }
@@ -1,16 +1,97 @@
 #ifndef SEARCHANALYSIS_H
 #define SEARCHANALYSIS_H
 #include <chrono>
+#include <fstream>
+#include <map>
+#include <vector>
 #include <nlohmann/json.hpp>
 
+/* Analysis Bucket Configuration
+ * Number of buckets each graph keeps in memory, once a graph fills up neighboring buckets are merged so memory use
+ * stays fixed no matter how long the search runs
+ */
+#ifndef CONFIG_ANALYSIS_BUCKETS
+#define CONFIG_ANALYSIS_BUCKETS 512
+#endif
+/* Analysis Sample Interval Configuration
+ * Default time between samples in milliseconds, samples are also taken whenever search depth changes
+ */
+#ifndef CONFIG_ANALYSIS_SAMPLE_INTERVAL
+#define CONFIG_ANALYSIS_SAMPLE_INTERVAL 100
+#endif
+
+// Fixed-size series of points, each bucket summarizes a run of consecutive samples
+class TimeSeries {
+public:
+    struct Bucket {
+        long long min;
+        long long max;
+        // x and y of last sample in bucket
+        long long lastX;
+        long long last;
+        unsigned long count;
+    };
+private:
+    std::vector<Bucket> buckets;
+    // Amount of samples a bucket holds before a new one is started
+    unsigned long samplesPerBucket = 1;
+
+    // Halve resolution by merging neighboring buckets
+    void Downsample();
+public:
+    TimeSeries();
+
+    void Insert(long long x, long long y);
+
+    [[nodiscard]]
+    const std::vector<Bucket>& Buckets() const;
+
+    [[nodiscard]]
+    unsigned long SamplesPerBucket() const;
+};
+
 class SearchAnalysis {
 private:
+    struct Graph {
+        std::string title = "Title";
+        std::string xLabel = "x";
+        std::string yLabel = "y";
+        int interpolationOrder = 0;
+        TimeSeries series;
+    };
+
+    enum StreamFormat {
+        CSV,
+        JSONL
+    };
+
+    static bool enabled;
     static std::chrono::high_resolution_clock::time_point clock;
     static std::chrono::high_resolution_clock::time_point timePaused;
+    static std::chrono::high_resolution_clock::time_point lastSample;
+    static std::chrono::milliseconds sampleInterval;
     static nlohmann::json data;
-    static nlohmann::basic_json<>* current;
-    static const nlohmann::json emptyGraph;
+    static std::map<std::string, Graph> graphs;
+    static std::map<std::string, Graph>::iterator current;
+    static std::ofstream stream;
+    static std::string streamFile;
+    static StreamFormat streamFormat;
+
+    static void StreamPoint(long long x, long long y);
 public:
+    SearchAnalysis() = delete;
+    SearchAnalysis(const SearchAnalysis&) = delete;
+
+    // Recording is off unless enabled, while off every recording function does nothing
+    static void Enable(bool enable);
+    [[nodiscard]]
+    static bool Enabled();
+    static void SetSampleInterval(std::chrono::milliseconds interval);
+    // Check if enough time has passed since the last interval sample, resets the timer if so
+    [[nodiscard]]
+    static bool SampleDue();
+    // Stream every point to a .csv or .jsonl file as it is recorded
+    static void StreamTo(const std::string& filename);
     static void StartClock();
     static void PauseClock();
     static void ResumeClock();
@@ -20,7 +101,9 @@ public:
     static void SetInterpolationOrder(int order);
     static void InsertPoint(unsigned long x,unsigned long y);
     static void InsertTimePoint(unsigned long y);
+    static void InsertData(const std::string& key, const nlohmann::json& value);
     static void ExportData(const std::string& filename);
+    // Drop everything recorded so far, including points already written to the stream file
     static void ClearData();
 };
 
@@ -0,0 +1,55 @@
+#include "../lattice/Lattice.h"
+#include "Zobrist.h"
+
+std::vector<std::vector<std::uint64_t>> Zobrist::keys;
+
+std::size_t Zobrist::generation = 0;
+
+namespace {
+    // Keys are generated from their table position rather than drawn in sequence, so the key for a given cell and
+    // property set is the same no matter what order keys end up being requested in
+    std::uint64_t SplitMix(std::uint64_t x) {
+        x = x * 0x9E3779B97F4A7C15 + ZOBRIST_SEED;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EB;
+        return x ^ (x >> 31);
+    }
+}
+
+void Zobrist::CheckLattice() {
+    if (generation == Lattice::Generation()) {
+        return;
+    }
+    generation = Lattice::Generation();
+    keys.clear();
+}
+
+int Zobrist::CellIndex(const std::valarray<int>& coords) {
+    return Lattice::coordTensor.IndexFromCoords(coords);
+}
+
+std::uint64_t Zobrist::ModuleKey(const ModuleData& modData) {
+    CheckLattice();
+    const auto id = modData.Properties().Id();
+    if (id >= static_cast<int>(keys.size())) {
+        keys.resize(id + 1);
+    }
+    auto& row = keys[id];
+    if (row.empty()) {
+        const int cellCount = static_cast<int>(Lattice::coordTensor.GetArrayInternal().size());
+        row.resize(cellCount);
+        const std::uint64_t rowOffset = static_cast<std::uint64_t>(id) * cellCount;
+        for (int i = 0; i < cellCount; i++) {
+            row[i] = SplitMix(rowOffset + i);
+        }
+    }
+    return row[CellIndex(modData.Coords())];
+}
+
+std::uint64_t Zobrist::StateKey(const std::set<ModuleData>& modData) {
+    std::uint64_t key = 0;
+    for (const auto& data : modData) {
+        key ^= ModuleKey(data);
+    }
+    return key;
+}
@@ -0,0 +1,44 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+#include <cstdint>
+#include <set>
+#include <valarray>
+#include <vector>
+#include "../modules/ModuleManager.h"
+
+/* Zobrist Seed Configuration
+ * Seed used to generate the key table, any fixed value will do but it must not change between runs for hashes to be
+ * comparable across runs
+ */
+#ifndef ZOBRIST_SEED
+#define ZOBRIST_SEED 0x2545F4914F6CDD1D
+#endif
+
+// Zobrist hashing of module data, keys are assigned to every (lattice cell, property set) pair
+class Zobrist {
+private:
+    // Key table, indexed by interned property set ID and then by lattice cell index
+    static std::vector<std::vector<std::uint64_t>> keys;
+    // Lattice generation the key table was built for
+    static std::size_t generation;
+
+    // Clear the key table if the lattice has been resized since it was built
+    static void CheckLattice();
+
+    // Get lattice cell index of coordinates
+    static int CellIndex(const std::valarray<int>& coords);
+
+public:
+    Zobrist() = delete;
+    Zobrist(const Zobrist&) = delete;
+
+    // Get key for a single module
+    [[nodiscard]]
+    static std::uint64_t ModuleKey(const ModuleData& modData);
+
+    // Get hash of a full state by XORing the keys of every module
+    [[nodiscard]]
+    static std::uint64_t StateKey(const std::set<ModuleData>& modData);
+};
+
+#endif //ZOBRIST_H